@@ -26,7 +26,15 @@ public class DFInventory : ModuleRules
 		PrivateDependencyModuleNames.AddRange(new []
 		{
 			"FunctionalTesting",
-			"UnrealEd"
+			"UnrealEd",
+			"Json",
+			"SQLiteCore",
+			// The Iris serializer config of FInventorySlotHeader is a USTRUCT, which UHT generates whether or not
+			// Iris is enabled, so its base struct has to link in every build.
+			"IrisCore"
 		});
+
+		// Fragment registration and serializer registration; sets UE_WITH_IRIS.
+		SetupIrisSupport(Target);
 	}
 }
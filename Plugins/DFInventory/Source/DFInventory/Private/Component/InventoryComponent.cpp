@@ -1,19 +1,55 @@
 #include "Component/InventoryComponent.h"
 #include "Subsystem/DFInventorySubsystem.h"
+#include "Subsystem/InventorySyncSubsystem.h"
 #include "Rules/InventorySaveRules.h"
 #include "Data/ItemData.h"
 #include "Kismet/GameplayStatics.h"
+#include "Engine/GameInstance.h"
 #include "Settings/InventorySaveGame.h"
 #include "Settings/DFInventorySettings.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "Net/Core/Misc/NetConditionGroupManager.h"
+#include "Net/Subsystems/NetworkSubsystem.h"
+#if UE_WITH_IRIS
+#include "Iris/ReplicationSystem/ReplicationFragmentUtil.h"
+#endif
 #include "Net/UnrealNetwork.h"
+#include "TimerManager.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "Struct/InventoryNetStats.h"
+
+UInventoryComponent::UInventoryComponent()
+{
+	ReplicatedSlots.Owner = this;
+	bReplicateUsingRegisteredSubObjectList = true;
+}
+
+void UInventoryComponent::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// Initializing from an archetype or template copies its owner; the slots belong to this instance.
+	ReplicatedSlots.Owner = this;
+}
 
 void UInventoryComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
+	if (bManageNetDormancy && GetOwner() && GetOwner()->HasAuthority())
+	{ GetOwner()->SetNetDormancy(DORM_DormantAll); }
+
 	// 1. Persistence Strategy: Delegate to SaveRules
-	if (SaveRules)
+	if (UDFInventorySubsystem* Subsystem = GetWorld() && GetWorld()->GetGameInstance() ? GetWorld()->GetGameInstance()->GetSubsystem<UDFInventorySubsystem>() : nullptr)
+	{
+		// Only rules saving to the disk or the memory store take part in the subsystem's save passes.
+		if (SaveRules && ShouldAutoSave() && (SaveRules->PersistsTo(ESaveType::Disk) || SaveRules->PersistsTo(ESaveType::Memory)))
+		{ Subsystem->RegisterInventory(this); }
+	}
+
+	if (SaveRules && ShouldAutoSave())
 	{
 		if (SaveRules->HandleBeginPlay(this))
 		{
@@ -30,7 +66,7 @@ void UInventoryComponent::BeginPlay()
 		{
 			InventoryItems.SetNum(MaxItemSlots);
 		}
-		OnInventoryRefresh.Broadcast();
+		NotifyInventoryRefreshed();
 	}
 	else
 	{
@@ -42,36 +78,523 @@ void UInventoryComponent::BeginPlay()
 void UInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-	DOREPLIFETIME(UInventoryComponent, InventoryItems);
-	DOREPLIFETIME(UInventoryComponent, SaveRules);
+	
+	// Everything is push-based, so idle inventories are skipped without any property comparison.
+	FDoRepLifetimeParams SlotParams;
+	SlotParams.bIsPushBased = true;
+	SlotParams.Condition = COND_Custom;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UInventoryComponent, InventoryItems, SlotParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UInventoryComponent, ReplicatedSlots, SlotParams);
+	DOREPLIFETIME_WITH_PARAMS_FAST(UInventoryComponent, PageSummaries, SlotParams);
+	
+	// SaveRules stay on the server; clients never save.
+	FDoRepLifetimeParams PushParams;
+	PushParams.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UInventoryComponent, MaxItemSlots, PushParams);
+}
+
+#if UE_WITH_IRIS
+void UInventoryComponent::RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags)
+{
+	// Fragments are built from the push-based lifetime properties, so Iris only polls inventories marked dirty.
+	UE::Net::FReplicationFragmentUtil::CreateAndRegisterFragmentsForObject(this, Context, RegistrationFlags);
+}
+#endif
+
+void UInventoryComponent::BeginReplication()
+{
+	Super::BeginReplication();
+	ApplyReplicationScope();
+}
+
+void UInventoryComponent::SetReplicationScope(EInventoryReplicationScope NewScope)
+{
+	if (ReplicationScope == NewScope) return;
+	
+	ReplicationScope = NewScope;
+	if (IsReadyForReplication())
+	{ ApplyReplicationScope(); }
+}
+
+EInventoryReplicationScope UInventoryComponent::ResolveReplicationScope() const
+{
+	const AActor* Owner = GetOwner();
+	if (ReplicationScope != EInventoryReplicationScope::Auto || !Owner) return ReplicationScope;
+	
+	const bool bPlayerOwned = Owner->IsA<APawn>() || Owner->IsA<AController>() || Owner->IsA<APlayerState>();
+	return bPlayerOwned ? EInventoryReplicationScope::OwnerOnly : EInventoryReplicationScope::Everyone;
+}
+
+void UInventoryComponent::ApplyReplicationScope()
+{
+	AActor* Owner = GetOwner();
+	if (!Owner || !Owner->HasAuthority() || !GetIsReplicated()) return;
+	
+	EInventoryReplicationScope Scope = ResolveReplicationScope();
+	
+	if (Scope != EInventoryReplicationScope::Everyone && !Owner->IsUsingRegisteredSubObjectList())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Inventory] %s: replication scope needs bReplicateUsingRegisteredSubObjectList on %s, replicating to everyone."),
+			*GetName(), *Owner->GetName());
+		Scope = EInventoryReplicationScope::Everyone;
+	}
+	
+	if (UNetworkSubsystem* NetSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UNetworkSubsystem>() : nullptr)
+	{
+		FNetConditionGroupManager& Groups = NetSubsystem->GetNetConditionGroupManager();
+		if (Scope == EInventoryReplicationScope::Viewers)
+		{ Groups.RegisterSubObjectInGroup(this, GetViewerGroup()); }
+		else
+		{ Groups.UnregisterSubObjectFromGroup(this, GetViewerGroup()); }
+	}
+	
+	// Inventories everyone sees reach joining players through the sync budget.
+	UInventorySyncSubsystem* SyncSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UInventorySyncSubsystem>() : nullptr;
+	const bool bBudgeted = SyncSubsystem && Scope == EInventoryReplicationScope::Everyone && UInventorySyncSubsystem::IsBudgetingEnabled(GetWorld());
+	if (SyncSubsystem)
+	{
+		if (bBudgeted) SyncSubsystem->RegisterInventory(this);
+		else SyncSubsystem->UnregisterInventory(this);
+	}
+	
+	ELifetimeCondition Condition = COND_None;
+	switch (Scope)
+	{
+	case EInventoryReplicationScope::OwnerOnly:	Condition = COND_OwnerOnly; break;
+	case EInventoryReplicationScope::Viewers:	Condition = COND_NetGroup; break;
+	default: Condition = bBudgeted ? COND_NetGroup : COND_None; break;
+	}
+	Owner->SetReplicatedComponentNetCondition(this, Condition);
+}
+
+FName UInventoryComponent::GetViewerGroup() const
+{ return FName(TEXT("InventoryViewers"), GetUniqueID()); }
+
+void UInventoryComponent::AddViewer(APlayerController* Viewer)
+{
+	if (!Viewer || !HasInventoryAuthority() || IsViewer(Viewer)) return;
+	
+	Viewers.Add(Viewer);
+	Viewer->IncludeInNetConditionGroup(GetViewerGroup());
+	WakeNetDormancy();
+}
+
+void UInventoryComponent::RemoveViewer(APlayerController* Viewer)
+{
+	if (!Viewer) return;
+	
+	if (Viewers.RemoveAll([Viewer](const TWeakObjectPtr<APlayerController>& Existing){ return Existing.Get() == Viewer; }) > 0)
+	{ Viewer->RemoveFromNetConditionGroup(GetViewerGroup()); }
+	
+	if (ViewerPageRanges.Remove(Viewer) > 0)
+	{ UpdateStreamedPages(); }
+}
+
+bool UInventoryComponent::IsViewer(const APlayerController* Viewer) const
+{
+	return Viewer && Viewers.ContainsByPredicate([Viewer](const TWeakObjectPtr<APlayerController>& Existing)
+		{ return Existing.Get() == Viewer; });
+}
+
+void UInventoryComponent::PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker)
+{
+	Super::PreReplication(ChangedPropertyTracker);
+	
+	const bool bSlotDeltas = ReplicationMode != EInventoryReplicationMode::FullArray;
+	DOREPLIFETIME_ACTIVE_OVERRIDE_FAST(UInventoryComponent, InventoryItems, !bSlotDeltas);
+	DOREPLIFETIME_ACTIVE_OVERRIDE_FAST(UInventoryComponent, ReplicatedSlots, bSlotDeltas);
+	DOREPLIFETIME_ACTIVE_OVERRIDE_FAST(UInventoryComponent, PageSummaries, UsesPagedReplication());
+}
+
+void UInventoryComponent::SetReplicationMode(EInventoryReplicationMode NewMode)
+{
+	if (ReplicationMode == NewMode) return;
+	
+	ReplicationMode = NewMode;
+	RebuildReplicatedSlots();
+	RebuildPageSummaries();
+	UpdateAllItemSubobjects();
+	MarkSlotsReplicationDirty();
+}
+
+void UInventoryComponent::OnRep_InventoryItems()
+{
+	FInventoryClientRepScope RepScope;
+	OnInventoryRefresh.Broadcast();
+}
+
+void UInventoryComponent::OnRep_PageSummaries()
+{
+	FInventoryClientRepScope RepScope;
+	OnPageSummariesChanged.Broadcast();
+}
+
+void UInventoryComponent::OnRep_MaxItemSlots()
+{
+	FInventoryClientRepScope RepScope;
+	if (InventoryItems.Num() == MaxItemSlots) return;
+	
+	InventoryItems.SetNum(MaxItemSlots);
+	OnInventoryRefresh.Broadcast();
+}
+
+bool UInventoryComponent::HasInventoryAuthority() const
+{
+	// Inventories without an owning actor (e.g. created in tests) are treated as authoritative.
+	const AActor* Owner = GetOwner();
+	return !Owner || Owner->HasAuthority();
+}
+
+void UInventoryComponent::MarkSlotsReplicationDirty()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(UInventoryComponent, InventoryItems, this);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UInventoryComponent, ReplicatedSlots, this);
+	WakeNetDormancy();
+}
+
+void UInventoryComponent::SetManageNetDormancy(bool bManage)
+{
+	if (bManageNetDormancy == bManage) return;
+	bManageNetDormancy = bManage;
+	
+	AActor* Owner = GetOwner();
+	if (!Owner || !Owner->HasAuthority()) return;
+	
+	if (UWorld* World = GetWorld())
+	{ World->GetTimerManager().ClearTimer(NetDormancyTimer); }
+	Owner->SetNetDormancy(bManage ? DORM_DormantAll : DORM_Awake);
+}
+
+void UInventoryComponent::WakeNetDormancy()
+{
+	AActor* Owner = GetOwner();
+	UWorld* World = GetWorld();
+	if (!bManageNetDormancy || !Owner || !World || !Owner->HasAuthority()) return;
+	
+	// Staying awake through a burst of changes is cheaper than flushing a dormant channel for each one.
+	if (Owner->NetDormancy != DORM_Awake)
+	{ Owner->SetNetDormancy(DORM_Awake); }
+	World->GetTimerManager().SetTimer(NetDormancyTimer, this, &UInventoryComponent::ReturnToNetDormancy, NetDormancyQuietSeconds, false);
+}
+
+void UInventoryComponent::ReturnToNetDormancy()
+{
+	// The last changes still go out before the channel goes dormant.
+	if (bManageNetDormancy && GetOwner())
+	{ GetOwner()->SetNetDormancy(DORM_DormantAll); }
+}
+
+void UInventoryComponent::UpdateItemSubobject(UItemData* Previous, UItemData* Current)
+{
+	// The previous item may just have moved to another slot (swaps), so only drop it once it is gone.
+	if (Previous && Previous != Current && RegisteredItems.Contains(Previous))
+	{
+		const int32 PreviousIndex = FindItemIndex(Previous);
+		if (PreviousIndex == INDEX_NONE || !IsSlotStreamed(PreviousIndex))
+		{
+			RegisteredItems.Remove(Previous);
+			RemoveReplicatedSubObject(Previous);
+		}
+	}
+	
+	if (Current && ReplicatesItemSubobjects() && !RegisteredItems.Contains(Current) && IsSlotStreamed(FindItemIndex(Current)))
+	{
+		RegisteredItems.Add(Current);
+		AddReplicatedSubObject(Current);
+	}
+}
+
+void UInventoryComponent::UpdateAllItemSubobjects()
+{
+	TSet<TObjectPtr<UItemData>> Held;
+	if (ReplicatesItemSubobjects())
+	{
+		for (int32 i = 0; i < InventoryItems.Num(); ++i)
+		{ if (InventoryItems[i] && IsSlotStreamed(i)) Held.Add(InventoryItems[i]); }
+	}
+	
+	for (const TObjectPtr<UItemData>& Item : RegisteredItems)
+	{ if (!Held.Contains(Item)) RemoveReplicatedSubObject(Item); }
+	
+	for (const TObjectPtr<UItemData>& Item : Held)
+	{ if (!RegisteredItems.Contains(Item)) AddReplicatedSubObject(Item); }
+	
+	RegisteredItems = MoveTemp(Held);
+}
+
+void UInventoryComponent::NotifySlotChanged(int32 Index)
+{
+	if (!InventoryItems.IsValidIndex(Index)) return;
+	if (UItemData* Item = InventoryItems[Index]) Item->SetOwningInventory(this);
+	
+	if (HasInventoryAuthority())
+	{
+		const int32 EntryIndex = ReplicatedSlots.FindEntryIndex(Index);
+		UItemData* Previous = EntryIndex != INDEX_NONE ? ReplicatedSlots.Slots[EntryIndex].Item.Get() : nullptr;
+		UItemData* Streamed = IsSlotStreamed(Index) ? InventoryItems[Index].Get() : nullptr;
+		
+		// Dirty (and awake) even when the entry is unchanged: stacking edits the item in place, which only its
+		// subobject replicates, and a dormant owner would never send it.
+		ReplicatedSlots.SetSlot(Index, Streamed);
+		MarkSlotsReplicationDirty();
+		UpdateItemSubobject(Previous, Streamed);
+		UpdatePageSummary(Index);
+	}
+	
+	MarkSaveDirty();
+	if (SaveRules && HasBegunPlay() && ShouldAutoSave()) SaveRules->HandleSlotChanged(this, Index);
+	OnItemUpdated.Broadcast(Index, InventoryItems[Index]);
+}
+
+void UInventoryComponent::NotifyInventoryRefreshed()
+{
+	for (UItemData* Item : InventoryItems)
+	{ if (Item) Item->SetOwningInventory(this); }
+	
+	if (HasInventoryAuthority())
+	{
+		RebuildReplicatedSlots();
+		RebuildPageSummaries();
+		UpdateAllItemSubobjects();
+		MarkSlotsReplicationDirty();
+		MARK_PROPERTY_DIRTY_FROM_NAME(UInventoryComponent, MaxItemSlots, this);
+	}
+	
+	MarkSaveDirty();
+	if (SaveRules && HasBegunPlay() && ShouldAutoSave()) SaveRules->HandleInventoryRefreshed(this);
+	OnInventoryRefresh.Broadcast();
+}
+
+bool UInventoryComponent::IsSlotStreamed(int32 Index) const
+{
+	if (!UsesPagedReplication()) return true;
+	return Index >= 0 && StreamedPages.Contains(Index / FMath::Max(ReplicationPageSize, 1));
+}
+
+void UInventoryComponent::RebuildReplicatedSlots()
+{ ReplicatedSlots.Rebuild(InventoryItems, [this](int32 Index){ return IsSlotStreamed(Index); }); }
+
+int32 UInventoryComponent::EstimateInitialSyncBytes() const
+{
+	// Paged inventories start out as summaries only.
+	int32 Items = 0;
+	for (int32 i = 0; i < InventoryItems.Num(); ++i)
+	{ if (InventoryItems[i] && IsSlotStreamed(i)) ++Items; }
+	
+	constexpr int32 BaseBytes = 16;
+	constexpr int32 BytesPerPageSummary = 4;
+	return BaseBytes + PageSummaries.Num() * BytesPerPageSummary + Items * GetDefault<UDFInventorySettings>()->InitialSyncBytesPerItem;
+}
+
+void UInventoryComponent::SetVisibleSlotRange(int32 FirstSlot, int32 NumSlots)
+{
+	// The server and standalone games always hold every slot.
+	if (HasInventoryAuthority()) return;
+	
+	const FIntPoint Range(FMath::Max(FirstSlot, 0), FMath::Max(NumSlots, 0));
+	if (Range == SentVisibleRange) return;
+	
+	if (UInventoryComponent* Router = FindPredictionRouter(nullptr))
+	{
+		SentVisibleRange = Range;
+		Router->Server_SetVisibleSlotRange(this, Range.X, Range.Y);
+	}
+}
+
+void UInventoryComponent::Server_SetVisibleSlotRange_Implementation(UInventoryComponent* Inventory, int32 FirstSlot, int32 NumSlots)
+{
+	const APlayerController* Player = GetRequestingPlayer();
+	if (Inventory && Inventory->CanBeModifiedBy(Player))
+	{ Inventory->SetPlayerVisibleRange(Player, FirstSlot, NumSlots); }
+}
+
+void UInventoryComponent::SetPlayerVisibleRange(const APlayerController* Player, int32 FirstSlot, int32 NumSlots)
+{
+	if (!Player) return;
+	
+	if (NumSlots <= 0 || FirstSlot < 0 || FirstSlot >= InventoryItems.Num())
+	{ ViewerPageRanges.Remove(Player); }
+	else
+	{
+		const int32 PageSize = FMath::Max(ReplicationPageSize, 1);
+		const int32 FirstPage = FirstSlot / PageSize;
+		const int32 LastPage = FMath::Min((FirstSlot + NumSlots - 1) / PageSize, FirstPage + MaxVisiblePagesPerViewer - 1);
+		ViewerPageRanges.Add(Player, FIntPoint(FirstPage, LastPage));
+	}
+	UpdateStreamedPages();
+}
+
+void UInventoryComponent::UpdateStreamedPages()
+{
+	TSet<int32> NewPages;
+	for (auto It = ViewerPageRanges.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().IsValid())
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		for (int32 Page = It.Value().X; Page <= It.Value().Y; ++Page)
+		{ NewPages.Add(Page); }
+	}
+	
+	TSet<int32> ChangedPages = NewPages.Difference(StreamedPages).Union(StreamedPages.Difference(NewPages));
+	StreamedPages = MoveTemp(NewPages);
+	if (ChangedPages.IsEmpty() || !UsesPagedReplication()) return;
+	
+	// Only the slots of pages that came into or went out of view are touched.
+	const int32 PageSize = FMath::Max(ReplicationPageSize, 1);
+	bool bDirty = false;
+	for (int32 Page : ChangedPages)
+	{
+		const int32 LastSlot = FMath::Min((Page + 1) * PageSize, InventoryItems.Num());
+		for (int32 Index = Page * PageSize; Index < LastSlot; ++Index)
+		{
+			UItemData* Streamed = StreamedPages.Contains(Page) ? InventoryItems[Index].Get() : nullptr;
+			bDirty |= ReplicatedSlots.SetSlot(Index, Streamed);
+			UpdateItemSubobject(InventoryItems[Index], Streamed);
+		}
+	}
+	if (bDirty) MarkSlotsReplicationDirty();
+}
+
+FInventoryPageSummary UInventoryComponent::ComputePageSummary(int32 PageIndex) const
+{
+	FInventoryPageSummary Summary;
+	const int32 PageSize = FMath::Max(ReplicationPageSize, 1);
+	const int32 LastSlot = FMath::Min((PageIndex + 1) * PageSize, InventoryItems.Num());
+	for (int32 Index = PageIndex * PageSize; Index < LastSlot; ++Index)
+	{
+		if (const UItemData* Item = InventoryItems[Index])
+		{
+			++Summary.OccupiedSlots;
+			Summary.TotalAmount += Item->GetInfoRef().Amount;
+		}
+	}
+	return Summary;
+}
+
+void UInventoryComponent::UpdatePageSummary(int32 Index)
+{
+	if (!UsesPagedReplication()) return;
+	
+	const int32 Page = Index / FMath::Max(ReplicationPageSize, 1);
+	if (!PageSummaries.IsValidIndex(Page)) return;
+	
+	const FInventoryPageSummary Summary = ComputePageSummary(Page);
+	if (PageSummaries[Page] == Summary) return;
+	
+	PageSummaries[Page] = Summary;
+	MARK_PROPERTY_DIRTY_FROM_NAME(UInventoryComponent, PageSummaries, this);
+	WakeNetDormancy();
+}
+
+void UInventoryComponent::RebuildPageSummaries()
+{
+	TArray<FInventoryPageSummary> NewSummaries;
+	if (UsesPagedReplication())
+	{
+		const int32 PageCount = FMath::DivideAndRoundUp(InventoryItems.Num(), FMath::Max(ReplicationPageSize, 1));
+		NewSummaries.SetNum(PageCount);
+		for (int32 Page = 0; Page < PageCount; ++Page)
+		{ NewSummaries[Page] = ComputePageSummary(Page); }
+	}
+	
+	if (NewSummaries == PageSummaries) return;
+	PageSummaries = MoveTemp(NewSummaries);
+	MARK_PROPERTY_DIRTY_FROM_NAME(UInventoryComponent, PageSummaries, this);
+}
+
+void UInventoryComponent::ApplyReplicatedSlot(int32 Index, UItemData* Item)
+{
+	if (Index < 0) return;
+	
+	if (!InventoryItems.IsValidIndex(Index))
+	{ InventoryItems.SetNum(FMath::Max(MaxItemSlots, Index + 1)); }
+	
+	// Keep showing the predicted state until the server answered; the latest replicated value is applied then.
+	if (PredictedSlotLocks.Contains(Index))
+	{
+		DeferredReplicatedSlots.Add(Index, Item);
+		return;
+	}
+	
+	InventoryItems[Index] = Item;
+	if (Item) Item->SetOwningInventory(this);
+	OnItemUpdated.Broadcast(Index, Item);
+}
+
+void UInventoryComponent::FlushReplicatedSlotStates()
+{
+	if (PendingSlotStates.IsEmpty()) return;
+	
+	for (int32 Index : PendingSlotStates)
+	{
+		const int32 EntryIndex = ReplicatedSlots.FindEntryIndex(Index);
+		if (EntryIndex == INDEX_NONE) continue;
+		
+		const FInventorySlotEntry& Entry = ReplicatedSlots.Slots[EntryIndex];
+		const FItemStruct Info = Entry.ResolveInfo();
+		UClass* ViewClass = Entry.Definition ? Entry.Definition->GetClass() : UItemData::StaticClass();
+		
+		// Reuse the existing local view when it is ours and of the right class, so widgets stay bound.
+		// A locked slot's view holds the prediction and is restored on rollback; the server state gets its own view.
+		UItemData* View = InventoryItems.IsValidIndex(Index) ? InventoryItems[Index].Get() : nullptr;
+		if (!View || View->GetOuter() != this || View->GetClass() != ViewClass || PredictedSlotLocks.Contains(Index))
+		{ View = NewObject<UItemData>(this, ViewClass); }
+		
+		View->SetInfo(Info);
+		ApplyReplicatedSlot(Index, View);
+	}
+	PendingSlotStates.Reset();
 }
 
 void UInventoryComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
 	Super::EndPlay(EndPlayReason);
 
-	if (SaveRules)
+	for (const TWeakObjectPtr<APlayerController>& Viewer : Viewers)
+	{ if (Viewer.IsValid()) Viewer->RemoveFromNetConditionGroup(GetViewerGroup()); }
+	Viewers.Reset();
+	ViewerPageRanges.Reset();
+	StreamedPages.Reset();
+	
+	if (UWorld* World = GetWorld())
+	{ World->GetTimerManager().ClearTimer(NetDormancyTimer); }
+	
+	if (UInventorySyncSubsystem* SyncSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UInventorySyncSubsystem>() : nullptr)
+	{ SyncSubsystem->UnregisterInventory(this); }
+	
+	if (UNetworkSubsystem* NetSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UNetworkSubsystem>() : nullptr)
+	{ NetSubsystem->GetNetConditionGroupManager().UnregisterSubObjectFromAllGroups(this); }
+
+	if (SaveRules && ShouldAutoSave())
 	{
 		SaveRules->HandleEndPlay_Explicit(this, EndPlayReason);
 	}
+	
+	if (UDFInventorySubsystem* Subsystem = GetWorld() && GetWorld()->GetGameInstance() ? GetWorld()->GetGameInstance()->GetSubsystem<UDFInventorySubsystem>() : nullptr)
+	{ Subsystem->UnregisterInventory(this); }
 }
 
 void UInventoryComponent::CreateNewInventory()
 {
 	InventoryItems.Empty();
 	InventoryItems.SetNum(MaxItemSlots);
-	OnInventoryRefresh.Broadcast();
+	NotifyInventoryRefreshed();
 }
 
 void UInventoryComponent::SetMaxItemSlots(int32 NewMaxSlots)
 {
 	if (NewMaxSlots < 1) return;
 	MaxItemSlots = NewMaxSlots;
+	MARK_PROPERTY_DIRTY_FROM_NAME(UInventoryComponent, MaxItemSlots, this);
+	WakeNetDormancy();
 	
 	if (InventoryItems.Num() != MaxItemSlots)
 	{
 		InventoryItems.SetNum(MaxItemSlots);
-		OnInventoryRefresh.Broadcast();
+		NotifyInventoryRefreshed();
 	}
 }
 
@@ -108,6 +631,18 @@ int32 UInventoryComponent::FindItemIndex(UItemData* Item)
 	{ return SlotItem.Get() == Item; });
 }
 
+TArray<int32> UInventoryComponent::FindItemsWithFragment(const UScriptStruct* FragmentType) const
+{
+	TArray<int32> Indexes;
+	if (!FragmentType) return Indexes;
+	
+	for (int32 i = 0; i < InventoryItems.Num(); ++i)
+	{
+		if (InventoryItems[i] && InventoryItems[i]->HasFragment(FragmentType)) Indexes.Add(i);
+	}
+	return Indexes;
+}
+
 bool UInventoryComponent::IsInventoryFull()
 {
 	bool bIsAtMaxCount = InventoryItems.Num() >= MaxItemSlots;
@@ -126,7 +661,7 @@ bool UInventoryComponent::AddItemToInventory(UItemData* NewItem)
 		if (FindStackableItem(NewItem, FoundItem))
 		{
 			StackItem(FoundItem, NewItem, ItemIndex);
-			OnItemUpdated.Broadcast(ItemIndex, FoundItem);
+			NotifySlotChanged(ItemIndex);
 		}
 		else if (IsInventoryFull())
 		{
@@ -137,7 +672,7 @@ bool UInventoryComponent::AddItemToInventory(UItemData* NewItem)
 		else
 		{
 			AddItem(NewItem, ItemIndex);
-			OnItemUpdated.Broadcast(ItemIndex, NewItem);
+			NotifySlotChanged(ItemIndex);
 			return false;
 		}
 	}
@@ -179,7 +714,7 @@ void UInventoryComponent::RemoveItemFromInventory(int32 ItemIndex)
 	if (InventoryItems.IsValidIndex(ItemIndex) && InventoryItems[ItemIndex])
 	{
 		InventoryItems[ItemIndex] = nullptr;
-		OnItemUpdated.Broadcast(ItemIndex, nullptr);
+		NotifySlotChanged(ItemIndex);
 	}
 }
 
@@ -199,14 +734,15 @@ bool UInventoryComponent::AddItemAtIndex(UItemData* NewItem, int32 Index)
 	
 	if (FoundItem)
 	{
-		if (CanItemsStack(NewItem, FoundItem))
-		{ return StackItem(FoundItem, NewItem, UnusedIndex); }
+		if (!CanItemsStack(NewItem, FoundItem)) return false;
 		
-		return false;
+		const bool bStacked = StackItem(FoundItem, NewItem, UnusedIndex);
+		if (bStacked) NotifySlotChanged(Index);
+		return bStacked;
 	}
 	
 	InventoryItems[Index] = NewItem;
-	OnItemUpdated.Broadcast(Index, NewItem);
+	NotifySlotChanged(Index);
 	return true;
 }
 
@@ -233,8 +769,8 @@ bool UInventoryComponent::SwapItemSlots(int32 SourceIndex, int32 TargetIndex)
 		InventoryItems[SourceIndex] = TargetItem;
 	}
 	
-	OnItemUpdated.Broadcast(SourceIndex, InventoryItems[SourceIndex]);
-	OnItemUpdated.Broadcast(TargetIndex, InventoryItems[TargetIndex]);
+	NotifySlotChanged(SourceIndex);
+	NotifySlotChanged(TargetIndex);
 	return true;
 }
 
@@ -275,8 +811,8 @@ bool UInventoryComponent::SplitStack(int32 SourceIndex, int32 TargetIndex, int32
 	SourceItem->AddItemAmount(-ActuallyMoved);
 	
 	if (SourceItem->GetItemAmount() <= 0) InventoryItems[SourceIndex] = nullptr;
-	OnItemUpdated.Broadcast(SourceIndex, InventoryItems[SourceIndex]);
-	OnItemUpdated.Broadcast(TargetIndex, TargetItem);
+	NotifySlotChanged(SourceIndex);
+	NotifySlotChanged(TargetIndex);
 
 	return true;
 }
@@ -307,7 +843,7 @@ bool UInventoryComponent::GenericTransferItem(UInventoryComponent* TargetCompone
 	}
 	
 	SourceItem->SetItemAmount(CopyItem->GetItemAmount());
-	OnItemUpdated.Broadcast(SourceIndex, SourceItem);
+	NotifySlotChanged(SourceIndex);
 	return false;
 }
 
@@ -340,5 +876,476 @@ TArray<UItemData*> UInventoryComponent::TransferItemsByObject(UInventoryComponen
 
 FString UInventoryComponent::GetSaveID() const
 {
-	return SaveID;
+	if (!SaveID.IsEmpty() || !SaveRules) return SaveID;
+	return SaveRules->GetSaveID(const_cast<UInventoryComponent*>(this));
+}
+
+FItemSaveData UInventoryComponent::CreateSaveData() const
+{
+	FItemSaveData Data;
+	Data.MaxSlots = MaxItemSlots;
+	for (int32 i = 0; i < InventoryItems.Num(); ++i)
+	{
+		if (!InventoryItems[i]) continue;
+		Data.Items.Add(InventoryItems[i]->GetInfoRef());
+		Data.SlotIndexes.Add(i);
+	}
+	return Data;
+}
+
+void UInventoryComponent::ApplySaveData(const FItemSaveData& Data)
+{
+	MaxItemSlots = FMath::Max(Data.MaxSlots, 1);
+	InventoryItems.Reset();
+	InventoryItems.SetNum(MaxItemSlots);
+	
+	const bool bSparse = Data.SlotIndexes.Num() == Data.Items.Num();
+	for (int32 i = 0; i < Data.Items.Num(); ++i)
+	{
+		const int32 Slot = bSparse ? Data.SlotIndexes[i] : i;
+		if (!InventoryItems.IsValidIndex(Slot)) continue;
+		
+		const FItemStruct& Info = Data.Items[i];
+		UItemData* Item = NewObject<UItemData>(this, Info.ParentItem ? Info.ParentItem->GetClass() : UItemData::StaticClass());
+		Item->SetInfo(Info);
+		InventoryItems[Slot] = Item;
+	}
+	
+	NotifyInventoryRefreshed();
+	OnInventoryLoaded.Broadcast();
+}
+
+void UInventoryComponent::SetSaveID(const FString& NewSaveID)
+{
+	if (SaveID == NewSaveID) return;
+	
+	SaveID = NewSaveID;
+	SavedRevisions[0] = SavedRevisions[1] = 0;
+	StorageSavedRevision = 0;
+	PendingDiskRevision = 0;
+	bDeferredLoadPending = false;
+	DiskDirtySince = FPlatformTime::Seconds();
+}
+
+bool UInventoryComponent::IsSaveDirty(ESaveType SaveType) const
+{
+	if (SaveType == ESaveType::Disk && PendingDiskRevision == SaveRevision) return false;
+	return SavedRevisions[static_cast<uint8>(SaveType)] != SaveRevision;
+}
+
+bool UInventoryComponent::IsSavedByPasses(ESaveType SaveType) const
+{
+	if (!SaveRules) return true;
+	const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
+	return SaveRules->PersistsTo(SaveType) && (!Settings || Settings->bEnableAutoSaveOnMapTransition);
+}
+
+bool UInventoryComponent::UsesDiskSaves() const
+{ return SaveRules && IsSavedByPasses(ESaveType::Disk); }
+
+bool UInventoryComponent::SaveInventory(ESaveType SaveType, bool bForce)
+{
+	const FString ID = GetSaveID();
+	UGameInstance* GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+	UDFInventorySubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UDFInventorySubsystem>() : nullptr;
+	if (ID.IsEmpty() || !Subsystem) return false;
+	
+	if (bDeferredLoadPending)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Inventory] %s not saved, its disk save is still loading"), *ID);
+		return false;
+	}
+	
+	// Unchanged slots are already stored (or on their way to the disk), so there is nothing to snapshot or write.
+	if (!bForce && !IsSaveDirty(SaveType))
+	{
+		if (SaveType == ESaveType::Memory || PendingDiskRevision == 0) OnInventorySaved.Broadcast();
+		return true;
+	}
+	
+	if (SaveType == ESaveType::Memory)
+	{
+		Subsystem->StoreInventoryData(FName(*ID), CreateSaveData());
+		SavedRevisions[static_cast<uint8>(ESaveType::Memory)] = SaveRevision;
+		OnInventorySaved.Broadcast();
+		return true;
+	}
+	
+	// Only the snapshot happens here; serializing and writing the slot file run on a background task.
+	PendingDiskRevision = SaveRevision;
+	DiskDirtySince = 0.0;
+	Subsystem->SaveInventoryDataAsync(ID, CreateSaveData(), SaveRules ? SaveRules->SaveGameClass : nullptr, this);
+	return true;
+}
+
+void UInventoryComponent::HandleItemInfoChanged(UItemData* Item)
+{
+	// Items taken out since keep pointing here; their changes are not ours.
+	const int32 Index = InventoryItems.Find(Item);
+	if (Index == INDEX_NONE) return;
+	
+	MarkSaveDirty();
+	
+	// Struct entries recapture the new state; either way a dormant owner has to wake up to send it.
+	if (HasInventoryAuthority())
+	{
+		if (IsSlotStreamed(Index)) ReplicatedSlots.SetSlot(Index, Item);
+		UpdatePageSummary(Index);
+		MarkSlotsReplicationDirty();
+	}
+	
+	if (SaveRules && HasBegunPlay() && ShouldAutoSave()) SaveRules->HandleSlotChanged(this, Index);
+}
+
+void UInventoryComponent::HandleDiskSaveFinished(uint32 Revision, bool bSuccess)
+{
+	if (PendingDiskRevision == Revision) PendingDiskRevision = 0;
+	if (!bSuccess)
+	{
+		// Still unsaved, and now older than anything changed since.
+		DiskDirtySince = FPlatformTime::Seconds();
+		return;
+	}
+	
+	uint32& Saved = SavedRevisions[static_cast<uint8>(ESaveType::Disk)];
+	Saved = FMath::Max(Saved, Revision);
+	OnInventorySaved.Broadcast();
+}
+
+bool UInventoryComponent::LoadInventory(ESaveType SaveType)
+{
+	const FString ID = GetSaveID();
+	UGameInstance* GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+	UDFInventorySubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UDFInventorySubsystem>() : nullptr;
+	if (ID.IsEmpty()) return false;
+	
+	// Memory loads take the data out of the store, which is how it stays bounded by inventories not currently playing.
+	FItemSaveData Data;
+	const bool bFound = SaveType == ESaveType::Memory
+		? Subsystem && Subsystem->TakeInventoryData(FName(*ID), Data)
+		: UDFInventorySubsystem::LoadInventoryDataFromDisk(Subsystem, ID, Data, SaveRules ? SaveRules->SaveGameClass : nullptr);
+	if (!bFound) return false;
+	
+	ApplySaveData(Data);
+	
+	// What was just loaded from disk matches it, and replaces a deferred load still on its way.
+	// Memory stays dirty: the store no longer holds the data, so the next memory save must put it back.
+	if (SaveType == ESaveType::Disk)
+	{
+		bDeferredLoadPending = false;
+		SavedRevisions[static_cast<uint8>(ESaveType::Disk)] = SaveRevision;
+		DiskDirtySince = 0.0;
+	}
+	return true;
+}
+
+bool UInventoryComponent::LoadInventoryDeferred()
+{
+	const FString ID = GetSaveID();
+	UGameInstance* GameInstance = GetWorld() ? GetWorld()->GetGameInstance() : nullptr;
+	UDFInventorySubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UDFInventorySubsystem>() : nullptr;
+	if (ID.IsEmpty()) return false;
+	if (!Subsystem) return LoadInventory(ESaveType::Disk);
+	
+	FItemSaveData Data;
+	const EInventoryDiskLoad Result = Subsystem->LoadInventoryDataDeferred(ID, Data, this, SaveRules ? SaveRules->SaveGameClass : nullptr);
+	bDeferredLoadPending = Result == EInventoryDiskLoad::Pending;
+	if (Result != EInventoryDiskLoad::Loaded) return false;
+	
+	ApplySaveData(Data);
+	SavedRevisions[static_cast<uint8>(ESaveType::Disk)] = SaveRevision;
+	DiskDirtySince = 0.0;
+	return true;
+}
+
+void UInventoryComponent::HandleDeferredLoad(const FItemSaveData* Data)
+{
+	if (!bDeferredLoadPending) return;
+	bDeferredLoadPending = false;
+	if (!Data) return;
+	
+	ApplySaveData(*Data);
+	SavedRevisions[static_cast<uint8>(ESaveType::Disk)] = SaveRevision;
+	DiskDirtySince = 0.0;
+}
+
+bool UInventoryComponent::RequestSwapItemSlots(int32 SourceIndex, int32 TargetIndex)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::Move;
+	Command.SourceIndex = SourceIndex;
+	Command.TargetIndex = TargetIndex;
+	return RequestCommands({ Command }) == 1;
+}
+
+bool UInventoryComponent::RequestSplitStack(int32 SourceIndex, int32 TargetIndex, int32 Amount)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::Split;
+	Command.SourceIndex = SourceIndex;
+	Command.TargetIndex = TargetIndex;
+	Command.Amount = Amount;
+	return RequestCommands({ Command }) == 1;
+}
+
+bool UInventoryComponent::RequestTransferItemToSlot(UInventoryComponent* TargetComponent, int32 SourceIndex, int32 TargetIndex)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::Transfer;
+	Command.SourceIndex = SourceIndex;
+	Command.TargetIndex = TargetIndex;
+	Command.TargetInventory = TargetComponent;
+	return RequestCommands({ Command }) == 1;
+}
+
+bool UInventoryComponent::RequestDropItem(int32 SlotIndex)
+{
+	FInventoryCommand Command;
+	Command.Type = EInventoryCommandType::Drop;
+	Command.SourceIndex = SlotIndex;
+	return RequestCommands({ Command }) == 1;
+}
+
+int32 UInventoryComponent::RequestCommands(const TArray<FInventoryCommand>& Commands)
+{
+	int32 Succeeded = 0;
+	if (HasInventoryAuthority())
+	{
+		for (const FInventoryCommand& Command : Commands)
+		{ if (ExecuteCommand(Command)) ++Succeeded; }
+		return Succeeded;
+	}
+	
+	// Any involved inventory the local player owns can carry the RPC.
+	UInventoryComponent* Router = FindPredictionRouter(nullptr);
+	for (const FInventoryCommand& Command : Commands)
+	{
+		if (Router) break;
+		Router = FindPredictionRouter(Command.TargetInventory);
+	}
+	if (!Router) return 0;
+	
+	for (int32 First = 0; First < Commands.Num(); First += FInventoryCommandBatch::MaxCommands)
+	{
+		FInventoryCommandBatch Batch;
+		Batch.Source = this;
+		Batch.PredictionKey = Router->BeginPrediction();
+		Batch.Commands.Append(&Commands[First], FMath::Min(FInventoryCommandBatch::MaxCommands, Commands.Num() - First));
+		
+		uint64 Mask = 0;
+		for (int32 i = 0; i < Batch.Commands.Num(); ++i)
+		{
+			Router->AddPredictedCommandSlots(Batch.PredictionKey, this, Batch.Commands[i]);
+			if (!ExecuteCommand(Batch.Commands[i])) continue;
+			
+			Mask |= uint64(1) << i;
+			++Succeeded;
+		}
+		
+		// Nothing changed locally, and the server would come to the same result.
+		if (Mask == 0)
+		{
+			Router->ResolvePrediction(Batch.PredictionKey, true, false);
+			continue;
+		}
+		Router->PendingPredictions[Batch.PredictionKey].PredictedMask = Mask;
+		Router->Server_ExecuteCommands(Batch);
+	}
+	return Succeeded;
+}
+
+bool UInventoryComponent::ExecuteCommand(const FInventoryCommand& Command)
+{
+	switch (Command.Type)
+	{
+	case EInventoryCommandType::Move:
+		return SwapItemSlots(Command.SourceIndex, Command.TargetIndex);
+		
+	case EInventoryCommandType::Split:
+		return SplitStack(Command.SourceIndex, Command.TargetIndex, Command.Amount);
+		
+	case EInventoryCommandType::Transfer:
+		return Command.TargetInventory && Command.TargetInventory != this
+			&& TransferItemToSlot(Command.TargetInventory, Command.SourceIndex, Command.TargetIndex);
+		
+	case EInventoryCommandType::Drop:
+		if (!InventoryItems.IsValidIndex(Command.SourceIndex) || !InventoryItems[Command.SourceIndex]) return false;
+		RemoveItemFromInventory(Command.SourceIndex);
+		return true;
+		
+	default:
+		return false;
+	}
+}
+
+void UInventoryComponent::AddPredictedCommandSlots(int32 PredictionKey, UInventoryComponent* Source, const FInventoryCommand& Command)
+{
+	AddPredictedSlot(PredictionKey, Source, Command.SourceIndex);
+	
+	switch (Command.Type)
+	{
+	case EInventoryCommandType::Move:
+	case EInventoryCommandType::Split:
+		AddPredictedSlot(PredictionKey, Source, Command.TargetIndex);
+		break;
+		
+	case EInventoryCommandType::Transfer:
+		if (!Command.TargetInventory) break;
+		if (Command.TargetIndex >= 0)
+		{ AddPredictedSlot(PredictionKey, Command.TargetInventory, Command.TargetIndex); }
+		else
+		{
+			// Without a target slot the item may stack anywhere in the target.
+			for (int32 i = 0; i < Command.TargetInventory->InventoryItems.Num(); ++i)
+			{ AddPredictedSlot(PredictionKey, Command.TargetInventory, i); }
+		}
+		break;
+		
+	default:
+		break;
+	}
+}
+
+bool UInventoryComponent::CanBeModifiedBy_Implementation(const APlayerController* Player) const
+{
+	if (!Player) return false;
+	
+	const AActor* Owner = GetOwner();
+	return (Owner && Owner->GetNetOwner() == Player)
+		|| IsViewer(Player)
+		|| bAllowModificationByAnyPlayer;
+}
+
+void UInventoryComponent::Server_ExecuteCommands_Implementation(const FInventoryCommandBatch& Batch)
+{
+	UInventoryComponent* Source = Batch.Source;
+	const APlayerController* Player = GetRequestingPlayer();
+	
+	uint64 SucceededMask = 0;
+	if (Source && Source->CanBeModifiedBy(Player))
+	{
+		for (int32 i = 0; i < Batch.Commands.Num() && i < FInventoryCommandBatch::MaxCommands; ++i)
+		{
+			const FInventoryCommand& Command = Batch.Commands[i];
+			if (Command.Type == EInventoryCommandType::Transfer
+				&& (!Command.TargetInventory || !Command.TargetInventory->CanBeModifiedBy(Player)))
+			{ continue; }
+			
+			if (Source->ExecuteCommand(Command)) SucceededMask |= uint64(1) << i;
+		}
+	}
+	Client_AckCommands(Batch.PredictionKey, SucceededMask);
+}
+
+void UInventoryComponent::Client_AckCommands_Implementation(int32 PredictionKey, uint64 SucceededMask)
+{
+	// Any command the server judged differently means the predicted slots may never get a correcting update.
+	const FInventoryPrediction* Prediction = PendingPredictions.Find(PredictionKey);
+	ResolvePrediction(PredictionKey, Prediction && Prediction->PredictedMask == SucceededMask);
+}
+
+UInventoryComponent* UInventoryComponent::FindPredictionRouter(UInventoryComponent* Other)
+{
+	// Only actors owned by the local player have a connection to send server RPCs through.
+	if (GetOwner() && GetOwner()->GetNetConnection()) return this;
+	if (Other && Other->GetOwner() && Other->GetOwner()->GetNetConnection()) return Other;
+	
+	// Requests on world containers alone go through any inventory the local player owns.
+	const APlayerController* LocalPlayer = GetWorld() ? GetWorld()->GetFirstPlayerController() : nullptr;
+	if (!LocalPlayer || !LocalPlayer->GetNetConnection()) return nullptr;
+	
+	const AActor* Candidates[] = { LocalPlayer, LocalPlayer->GetPawn(), LocalPlayer->PlayerState };
+	for (const AActor* Candidate : Candidates)
+	{
+		if (UInventoryComponent* Inventory = Candidate ? Candidate->FindComponentByClass<UInventoryComponent>() : nullptr)
+		{ return Inventory; }
+	}
+	return nullptr;
+}
+
+const APlayerController* UInventoryComponent::GetRequestingPlayer() const
+{ return GetOwner() ? Cast<APlayerController>(GetOwner()->GetNetOwner()) : nullptr; }
+
+int32 UInventoryComponent::BeginPrediction()
+{
+	const int32 Key = NextPredictionKey++;
+	PendingPredictions.Add(Key).StartTime = FPlatformTime::Seconds();
+	return Key;
+}
+
+void UInventoryComponent::AddPredictedSlot(int32 PredictionKey, UInventoryComponent* Inventory, int32 Index)
+{
+	FInventoryPrediction* Prediction = PendingPredictions.Find(PredictionKey);
+	if (!Prediction || !Inventory || !Inventory->InventoryItems.IsValidIndex(Index)) return;
+	
+	FInventoryPredictedSlot& Snapshot = Prediction->Slots.AddDefaulted_GetRef();
+	Snapshot.Inventory = Inventory;
+	Snapshot.SlotIndex = Index;
+	Snapshot.Item = Inventory->InventoryItems[Index];
+	if (Snapshot.Item) Snapshot.Info = Snapshot.Item->GetItemInfo();
+	
+	++Inventory->PredictedSlotLocks.FindOrAdd(Index);
+}
+
+void UInventoryComponent::ResolvePrediction(int32 PredictionKey, bool bAccepted, bool bFromServer)
+{
+	FInventoryPrediction Prediction;
+	if (!PendingPredictions.RemoveAndCopyValue(PredictionKey, Prediction)) return;
+	
+	if (bFromServer)
+	{ LastPredictionRoundTripMs = static_cast<float>((FPlatformTime::Seconds() - Prediction.StartTime) * 1000.0); }
+	
+	// Restore in reverse so a slot snapshotted twice ends up in its oldest state.
+	for (int32 i = Prediction.Slots.Num() - 1; i >= 0; --i)
+	{
+		const FInventoryPredictedSlot& Snapshot = Prediction.Slots[i];
+		if (UInventoryComponent* Inventory = Snapshot.Inventory.Get())
+		{ Inventory->ReleasePredictedSlot(Snapshot, !bAccepted); }
+	}
+	
+	if (!bAccepted && bFromServer)
+	{ OnPredictionRejected.Broadcast(); }
+}
+
+void UInventoryComponent::ReleasePredictedSlot(const FInventoryPredictedSlot& Snapshot, bool bRestore)
+{
+	const int32 Index = Snapshot.SlotIndex;
+	int32* LockCount = PredictedSlotLocks.Find(Index);
+	if (!LockCount || !InventoryItems.IsValidIndex(Index)) return;
+	
+	if (bRestore)
+	{
+		// Info the server sent meanwhile is newer than the snapshot and would not be sent again.
+		InventoryItems[Index] = Snapshot.Item;
+		if (Snapshot.Item)
+		{
+			const FItemStruct* ServerInfo = DeferredReplicatedInfos.Find(Snapshot.Item);
+			Snapshot.Item->SetInfo(ServerInfo ? *ServerInfo : Snapshot.Info);
+		}
+		OnItemUpdated.Broadcast(Index, Snapshot.Item);
+	}
+	
+	if (--*LockCount > 0) return;
+	PredictedSlotLocks.Remove(Index);
+	
+	// Whatever the server sent meanwhile is the truth, accepted or not.
+	FItemStruct ServerInfo;
+	UItemData* Held = InventoryItems[Index];
+	if (Held && DeferredReplicatedInfos.RemoveAndCopyValue(Held, ServerInfo))
+	{
+		Held->SetInfo(ServerInfo);
+		OnItemUpdated.Broadcast(Index, Held);
+	}
+	if (Snapshot.Item && Snapshot.Item != Held) DeferredReplicatedInfos.Remove(Snapshot.Item);
+	
+	TObjectPtr<UItemData> Deferred;
+	if (DeferredReplicatedSlots.RemoveAndCopyValue(Index, Deferred))
+	{ ApplyReplicatedSlot(Index, Deferred); }
+}
+
+void UInventoryComponent::HandleReplicatedItemInfo(UItemData* Item)
+{
+	const int32 Index = InventoryItems.Find(Item);
+	if (Index != INDEX_NONE && PredictedSlotLocks.Contains(Index))
+	{ DeferredReplicatedInfos.Add(Item, Item->GetInfoRef()); }
 }
@@ -1,8 +1,8 @@
 #include "Component/MultiInventory.h"
 #include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
 #include "GameFramework/PlayerState.h"
 #include "Net/UnrealNetwork.h"
-#include "Engine/ActorChannel.h"
 #include "Data/ItemData.h"
 
 UMPInventoryComponent::UMPInventoryComponent()
@@ -16,32 +16,20 @@ FString UMPInventoryComponent::GetSaveID() const
 	if (!SaveID.IsEmpty()) return SaveID;
 	
 	APawn* OwnerPawn = Cast<APawn>(GetOwner());
-	if (OwnerPawn)
+	APlayerState* PS = OwnerPawn ? OwnerPawn->GetPlayerState() : nullptr;
+	if (PS)
 	{
-		APlayerState* PS = OwnerPawn->GetPlayerState();
-		if (PS && PS->GetUniqueId().IsValid())
+		if (PS->GetUniqueId().IsValid())
 		{
 			return "PlayerInv_" + PS->GetUniqueId().ToString();
 		}
-	}
-	return TEXT("");
-}
-
-void UMPInventoryComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
-{
-	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
-
-	DOREPLIFETIME(UInventoryComponent, InventoryItems);
-}
 
-bool UMPInventoryComponent::ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags)
-{
-	bool bWroteSomething = Super::ReplicateSubobjects(Channel, Bunch, RepFlags);
-
-	for (TObjectPtr<UItemData> Item : InventoryItems)
-	{
-		if (!Item) continue;
-		bWroteSomething |= Channel->ReplicateSubobject(Item, *Bunch, *RepFlags);
+		// Without a net ID, remote players are told apart by their player state rather than by pawn name.
+		const APlayerController* PC = Cast<APlayerController>(OwnerPawn->GetController());
+		if (!PC || !PC->IsLocalController())
+		{
+			return FString::Printf(TEXT("PlayerInv_Id_%d"), PS->GetPlayerId());
+		}
 	}
-	return bWroteSomething;
+	return Super::GetSaveID();
 }
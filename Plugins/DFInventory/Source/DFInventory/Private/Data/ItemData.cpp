@@ -1,6 +1,12 @@
 #include "Data/ItemData.h"
 #include "Net/UnrealNetwork.h"
+#include "Net/Core/PushModel/PushModel.h"
+#if UE_WITH_IRIS
+#include "Iris/ReplicationSystem/ReplicationFragmentUtil.h"
+#endif
 #include "Settings/DFInventorySettings.h"
+#include "Struct/InventoryNetStats.h"
+#include "Component/InventoryComponent.h"
 
 UItemData::UItemData()
 {
@@ -29,19 +35,44 @@ void UItemData::PostLoad()
 void UItemData::SetInfo(FItemStruct NewInfo)
 {
 	Info = NewInfo;
-	OnDataChanged.Broadcast();
+	NotifyInfoChanged();
 }
 
 void UItemData::SetExtraInfo(const FInstancedStruct& NewExtraInfo)
 {
 	Info.ExtraInfo = NewExtraInfo;
-	OnDataChanged.Broadcast();
+	NotifyInfoChanged();
+}
+
+bool UItemData::GetFragment(const UScriptStruct* FragmentType, FInstancedStruct& OutFragment) const
+{
+	const FInstancedStruct* Found = Info.FindFragment(FragmentType);
+	if (!Found) return false;
+
+	OutFragment = *Found;
+	return true;
+}
+
+void UItemData::SetFragment(const FInstancedStruct& NewFragment)
+{
+	if (!NewFragment.IsValid()) return;
+
+	Info.SetFragment(NewFragment);
+	NotifyInfoChanged();
+}
+
+bool UItemData::RemoveFragment(const UScriptStruct* FragmentType)
+{
+	if (!Info.RemoveFragment(FragmentType)) return false;
+
+	NotifyInfoChanged();
+	return true;
 }
 
 int UItemData::SetItemAmount(int NewValue)
 {
 	Info.Amount = FMath::Clamp(NewValue, 0, Info.MaxAmount);
-	OnDataChanged.Broadcast();
+	NotifyInfoChanged();
 	return Info.Amount;
 }
 
@@ -58,7 +89,7 @@ void UItemData::SetIcon(UTexture2D* NewIcon)
 	if (Info.Icon != NewIcon)
 	{
 		Info.Icon = NewIcon;
-		OnDataChanged.Broadcast();
+		NotifyInfoChanged();
 	}
 }
 
@@ -67,7 +98,7 @@ void UItemData::SetItemName(const FString& NewName)
 	if (!Info.ItemName.Equals(NewName))
 	{
 		Info.ItemName = NewName;
-		OnDataChanged.Broadcast();
+		NotifyInfoChanged();
 	}
 }
 
@@ -76,7 +107,7 @@ void UItemData::SetDescription(const FText& NewDescription)
 	if (!Info.Description.EqualTo(NewDescription))
 	{
 		Info.Description = NewDescription;
-		OnDataChanged.Broadcast();
+		NotifyInfoChanged();
 	}
 }
 
@@ -90,7 +121,7 @@ void UItemData::SetMaxAmount(int32 NewMaxAmount)
 		{
 			Info.Amount = Info.MaxAmount;
 		}
-		OnDataChanged.Broadcast();
+		NotifyInfoChanged();
 	}
 }
 
@@ -98,7 +129,32 @@ void UItemData::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetim
 {
 	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
 
-	DOREPLIFETIME(UItemData, Info);
+	FDoRepLifetimeParams Params;
+	Params.bIsPushBased = true;
+	DOREPLIFETIME_WITH_PARAMS_FAST(UItemData, Info, Params);
+}
+
+#if UE_WITH_IRIS
+void UItemData::RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags)
+{ UE::Net::FReplicationFragmentUtil::CreateAndRegisterFragmentsForObject(this, Context, RegistrationFlags); }
+#endif
+
+void UItemData::NotifyInfoChanged()
+{
+	MARK_PROPERTY_DIRTY_FROM_NAME(UItemData, Info, this);
+	
+	// Items keep the outer they were created with (pickup, controller...), so the inventory holding them is tracked apart.
+	UInventoryComponent* Inventory = OwningInventory.Get();
+	if (!Inventory) Inventory = GetTypedOuter<UInventoryComponent>();
+	if (Inventory) Inventory->HandleItemInfoChanged(this);
+	OnDataChanged.Broadcast();
+}
+
+void UItemData::OnRep_Info()
+{
+	FInventoryClientRepScope RepScope;
+	if (UInventoryComponent* Inventory = OwningInventory.Get()) Inventory->HandleReplicatedItemInfo(this);
+	OnDataChanged.Broadcast();
 }
 
 #if WITH_EDITOR
@@ -113,6 +169,22 @@ void UItemData::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEve
 		{ Info.ParentItem = this; }
 	}
 	
+	// Fragments are keyed by type; drop duplicates so lookups stay unambiguous.
+	TSet<const UScriptStruct*> SeenTypes;
+	const int32 Removed = Info.Fragments.RemoveAll([&SeenTypes](const FInstancedStruct& Fragment)
+	{
+		const UScriptStruct* Type = Fragment.GetScriptStruct();
+		bool bAlreadySeen = false;
+		if (Type) SeenTypes.Add(Type, &bAlreadySeen);
+		return bAlreadySeen;
+	});
+	
+	if (Removed > 0)
+	{
+		FMessageLog("Blueprint")
+			.Warning(NSLOCTEXT("DFInventory", "DuplicateFragment", "An item can only hold one fragment of each type; duplicates were removed."));
+	}
+
 	const UDFInventorySettings* Settings = GetMutableDefault<UDFInventorySettings>();
 	if (Settings && Settings->InstancedExtraInfo.IsValid())
 	{
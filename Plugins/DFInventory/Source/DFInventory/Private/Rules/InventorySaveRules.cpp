@@ -11,11 +11,6 @@ bool UInventorySaveRules::HandleBeginPlay(UInventoryComponent* Inventory)
 	return false; // Default does nothing
 }
 
-void UInventorySaveRules::HandleEndPlay(UInventoryComponent* Inventory, const ELinkTo* EndPlayReason_Obsolete)
-{
-	// Legacy signature
-}
-
 void UInventorySaveRules::HandleEndPlay_Explicit(UInventoryComponent* Inventory, EEndPlayReason::Type Reason)
 {
 	// Override in child
@@ -71,39 +66,30 @@ FString UInventorySaveRules::GetSaveID_Implementation(UInventoryComponent* Inven
 	return ResolvedID;
 }
 
-	return ResolvedID;
-}
 // =================================================================================================
 // HELPERS (Moved from Component)
 // =================================================================================================
 #include "Settings/InventorySaveGame.h"
 #include "Subsystem/DFInventorySubsystem.h"
 #include "Settings/DFInventorySettings.h" 
+#include "Subsystem/InventoryJournal.h"
+#include "Data/ItemData.h"
+#include "Engine/GameInstance.h"
 
 FItemSaveData UInventorySaveRules::CreateSaveData(UInventoryComponent* Inventory)
-{
-	FItemSaveData Data;
-	if (!Inventory) return Data;
-
-	Data.MaxSlots = Inventory->MaxItemSlots;
-	Data.Items = Inventory->InventoryItems; // Friend Access
-	return Data;
-}
+{ return Inventory ? Inventory->CreateSaveData() : FItemSaveData(); }
 
 void UInventorySaveRules::ApplySaveData(UInventoryComponent* Inventory, const FItemSaveData& Data)
 {
-	if (!Inventory) return;
-	
-	Inventory->InventoryItems = Data.Items; // Friend Access
-	Inventory->MaxItemSlots = Data.MaxSlots;
+	if (Inventory) Inventory->ApplySaveData(Data);
+}
 
-	// Ensure size match
-	if (Inventory->InventoryItems.Num() != Inventory->MaxItemSlots)
-	{
-		Inventory->InventoryItems.SetNum(Inventory->MaxItemSlots);
-	}
-	
-	Inventory->OnInventoryRefresh.Broadcast();
+bool UInventorySaveRules::IsStorageDirty(const UInventoryComponent* Inventory) const
+{ return Inventory && Inventory->StorageSavedRevision != Inventory->SaveRevision; }
+
+void UInventorySaveRules::MarkSavedToStorage(UInventoryComponent* Inventory)
+{
+	if (Inventory) Inventory->StorageSavedRevision = Inventory->SaveRevision;
 }
 
 bool UInventorySaveRules::SaveToDisk(UInventoryComponent* Inventory)
@@ -114,19 +100,8 @@ bool UInventorySaveRules::SaveToDisk(UInventoryComponent* Inventory)
 	const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
 	if (Settings && !Settings->bEnableAutoSaveOnMapTransition) return false;
 
-	FString ID = GetSaveID(Inventory);
-	if (ID.IsEmpty()) return false;
-
-	// Use Configured Class or Default
-	TSubclassOf<USaveGame> ClassToUse = SaveGameClass ? SaveGameClass : UInventorySaveGame::StaticClass();
-	USaveGame* SaveObj = UGameplayStatics::CreateSaveGameObject(ClassToUse);
-	
-	if (UInventorySaveGame* TypedSave = Cast<UInventorySaveGame>(SaveObj))
-	{
-		TypedSave->SaveData = CreateSaveData(Inventory);
-		return UGameplayStatics::SaveGameToSlot(TypedSave, ID, 0); // UserIndex 0 for now
-	}
-	return false;
+	// Snapshot now, write in the background: EndPlay on quit or travel no longer waits for the disk.
+	return Inventory->SaveInventory(ESaveType::Disk);
 }
 
 bool UInventorySaveRules::LoadFromDisk(UInventoryComponent* Inventory)
@@ -137,18 +112,8 @@ bool UInventorySaveRules::LoadFromDisk(UInventoryComponent* Inventory)
 	const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
 	if (Settings && !Settings->bEnableAutoSaveOnMapTransition) return false;
 
-	FString ID = GetSaveID(Inventory);
-	
-	if (UGameplayStatics::DoesSaveGameExist(ID, 0))
-	{
-		USaveGame* LoadedObj = UGameplayStatics::LoadGameFromSlot(ID, 0);
-		if (UInventorySaveGame* TypedSave = Cast<UInventorySaveGame>(LoadedObj))
-		{
-			ApplySaveData(Inventory, TypedSave->SaveData);
-			return true;
-		}
-	}
-	return false;
+	// BeginPlay doesn't wait on the disk; data not prefetched yet is applied when it arrives.
+	return Inventory->LoadInventoryDeferred();
 }
 
 bool UInventorySaveRules::SaveToMemory(UInventoryComponent* Inventory)
@@ -159,15 +124,7 @@ bool UInventorySaveRules::SaveToMemory(UInventoryComponent* Inventory)
 	const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
 	if (Settings && !Settings->bEnableAutoSaveOnMapTransition) return false;
 
-	UWorld* World = Inventory->GetWorld();
-	if (!World) return false;
-	
-	if (UDFInventorySubsystem* Subsystem = World->GetGameInstance()->GetSubsystem<UDFInventorySubsystem>())
-	{
-		Subsystem->StoreInventoryData(FName(*GetSaveID(Inventory)), CreateSaveData(Inventory));
-		return true;
-	}
-	return false;
+	return Inventory->SaveInventory(ESaveType::Memory);
 }
 
 bool UInventorySaveRules::LoadFromMemory(UInventoryComponent* Inventory)
@@ -178,19 +135,7 @@ bool UInventorySaveRules::LoadFromMemory(UInventoryComponent* Inventory)
 	const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
 	if (Settings && !Settings->bEnableAutoSaveOnMapTransition) return false;
 
-	UWorld* World = Inventory->GetWorld();
-	if (!World) return false;
-
-	if (UDFInventorySubsystem* Subsystem = World->GetGameInstance()->GetSubsystem<UDFInventorySubsystem>())
-	{
-		FItemSaveData Data;
-		if (Subsystem->RetrieveInventoryData(FName(*GetSaveID(Inventory)), Data))
-		{
-			ApplySaveData(Inventory, Data);
-			return true;
-		}
-	}
-	return false;
+	return Inventory->LoadInventory(ESaveType::Memory);
 }
 
 // =================================================================================================
@@ -241,6 +186,9 @@ void UInventorySaveRules_Hybrid::HandleEndPlay_Explicit(UInventoryComponent* Inv
 // DISK ONLY
 // =================================================================================================
 
+bool UInventorySaveRules_Disk::PersistsTo(ESaveType SaveType) const
+{ return SaveType == ESaveType::Disk; }
+
 bool UInventorySaveRules_Disk::HandleBeginPlay(UInventoryComponent* Inventory)
 {
 	if (LoadFromDisk(Inventory))
@@ -261,6 +209,9 @@ void UInventorySaveRules_Disk::HandleEndPlay_Explicit(UInventoryComponent* Inven
 // MEMORY ONLY
 // =================================================================================================
 
+bool UInventorySaveRules_Memory::PersistsTo(ESaveType SaveType) const
+{ return SaveType == ESaveType::Memory; }
+
 bool UInventorySaveRules_Memory::HandleBeginPlay(UInventoryComponent* Inventory)
 {
 	if (LoadFromMemory(Inventory))
@@ -276,3 +227,77 @@ void UInventorySaveRules_Memory::HandleEndPlay_Explicit(UInventoryComponent* Inv
 	UE_LOG(LogTemp, Warning, TEXT("[Rules] MemoryOnly: Saving to Subsystem..."));
 	SaveToMemory(Inventory);
 }
+
+// =================================================================================================
+// JOURNAL
+// =================================================================================================
+
+FInventoryJournal* UInventorySaveRules_Journal::GetJournal(UInventoryComponent* Inventory)
+{
+	UGameInstance* GameInstance = Inventory && Inventory->GetWorld() ? Inventory->GetWorld()->GetGameInstance() : nullptr;
+	UDFInventorySubsystem* Subsystem = GameInstance ? GameInstance->GetSubsystem<UDFInventorySubsystem>() : nullptr;
+	return Subsystem ? Subsystem->GetJournal() : nullptr;
+}
+
+bool UInventorySaveRules_Journal::HandleBeginPlay(UInventoryComponent* Inventory)
+{
+	FInventoryJournal* Journal = GetJournal(Inventory);
+	const FString ID = Inventory ? Inventory->GetSaveID() : FString();
+	FItemSaveData Data;
+	if (!Journal || ID.IsEmpty() || !Journal->ReadInventory(ID, Data)) return false;
+
+	TGuardValue<bool> Guard(bApplying, true);
+	ApplySaveData(Inventory, Data);
+	UE_LOG(LogTemp, Log, TEXT("[Rules] Journal: Loaded."));
+	return true;
+}
+
+void UInventorySaveRules_Journal::HandleSlotChanged(UInventoryComponent* Inventory, int32 Index)
+{
+	FInventoryJournal* Journal = bApplying ? nullptr : GetJournal(Inventory);
+	const FString ID = Journal ? Inventory->GetSaveID() : FString();
+	if (ID.IsEmpty() || !Inventory->InventoryItems.IsValidIndex(Index)) return;
+
+	const UItemData* Item = Inventory->InventoryItems[Index];
+	Journal->WriteSlot(ID, Index, Item ? &Item->GetInfoRef() : nullptr);
+}
+
+void UInventorySaveRules_Journal::HandleInventoryRefreshed(UInventoryComponent* Inventory)
+{
+	FInventoryJournal* Journal = bApplying ? nullptr : GetJournal(Inventory);
+	const FString ID = Journal ? Inventory->GetSaveID() : FString();
+	if (!ID.IsEmpty()) Journal->WriteInventory(ID, Inventory->CreateSaveData());
+}
+
+// =================================================================================================
+// DATABASE
+// =================================================================================================
+
+UDFInventorySubsystem* UInventorySaveRules_Database::GetSubsystem(UInventoryComponent* Inventory)
+{
+	UGameInstance* GameInstance = Inventory && Inventory->GetWorld() ? Inventory->GetWorld()->GetGameInstance() : nullptr;
+	return GameInstance ? GameInstance->GetSubsystem<UDFInventorySubsystem>() : nullptr;
+}
+
+bool UInventorySaveRules_Database::HandleBeginPlay(UInventoryComponent* Inventory)
+{
+	UDFInventorySubsystem* Subsystem = GetSubsystem(Inventory);
+	FItemSaveData Data;
+	if (!Subsystem || !Subsystem->ReadFromStorage(Inventory->GetSaveID(), Data)) return false;
+
+	ApplySaveData(Inventory, Data);
+	MarkSavedToStorage(Inventory);
+	UE_LOG(LogTemp, Log, TEXT("[Rules] Database: Loaded."));
+	return true;
+}
+
+void UInventorySaveRules_Database::HandleEndPlay_Explicit(UInventoryComponent* Inventory, EEndPlayReason::Type Reason)
+{
+	// Same gate as the other rules. The storage has its own saved revision: disk saves of the inventory don't reach it.
+	const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
+	if (!Inventory || (Settings && !Settings->bEnableAutoSaveOnMapTransition) || !IsStorageDirty(Inventory)) return;
+
+	UDFInventorySubsystem* Subsystem = GetSubsystem(Inventory);
+	if (Subsystem && Subsystem->WriteToStorage(Inventory->GetSaveID(), CreateSaveData(Inventory)))
+	{ MarkSavedToStorage(Inventory); }
+}
@@ -0,0 +1,86 @@
+#include "Struct/InventoryCommands.h"
+#include "Component/InventoryComponent.h"
+#include "UObject/CoreNet.h"
+
+namespace InventoryCommandSerialization
+{
+	// Slot indexes may be -1, so they are sent shifted by one.
+	void SerializeIndex(FArchive& Ar, int32& Index)
+	{
+		uint32 Packed = Ar.IsSaving() ? static_cast<uint32>(Index + 1) : 0;
+		Ar.SerializeIntPacked(Packed);
+		if (Ar.IsLoading()) Index = static_cast<int32>(Packed) - 1;
+	}
+	
+	void SerializeCount(FArchive& Ar, int32& Count)
+	{
+		uint32 Packed = Ar.IsSaving() ? static_cast<uint32>(FMath::Max(Count, 0)) : 0;
+		Ar.SerializeIntPacked(Packed);
+		if (Ar.IsLoading()) Count = static_cast<int32>(FMath::Min<uint32>(Packed, MAX_int32));
+	}
+}
+
+bool FInventoryCommandBatch::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	using namespace InventoryCommandSerialization;
+	
+	bOutSuccess = true;
+	if (!Map)
+	{
+		bOutSuccess = false;
+		return false;
+	}
+	
+	UObject* SourceObject = Source;
+	Map->SerializeObject(Ar, UInventoryComponent::StaticClass(), SourceObject);
+	if (Ar.IsLoading()) Source = Cast<UInventoryComponent>(SourceObject);
+	
+	SerializeCount(Ar, PredictionKey);
+	
+	int32 Num = Commands.Num();
+	SerializeCount(Ar, Num);
+	if (Ar.IsLoading())
+	{
+		if (Num > MaxCommands)
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return false;
+		}
+		Commands.SetNum(Num);
+	}
+	
+	// Targets are written in full on first use and referenced by index afterwards.
+	TArray<UObject*, TInlineAllocator<4>> Targets;
+	for (FInventoryCommand& Command : Commands)
+	{
+		uint8 Type = static_cast<uint8>(Command.Type);
+		Ar.SerializeBits(&Type, 2);
+		if (Ar.IsLoading()) Command.Type = static_cast<EInventoryCommandType>(Type);
+		
+		SerializeIndex(Ar, Command.SourceIndex);
+		if (Command.Type != EInventoryCommandType::Drop) SerializeIndex(Ar, Command.TargetIndex);
+		if (Command.Type == EInventoryCommandType::Split) SerializeCount(Ar, Command.Amount);
+		if (Command.Type != EInventoryCommandType::Transfer) continue;
+		
+		int32 TargetRef = Ar.IsSaving() ? Targets.Find(Command.TargetInventory.Get()) : 0;
+		if (TargetRef == INDEX_NONE) TargetRef = Targets.Num();
+		SerializeCount(Ar, TargetRef);
+		
+		if (TargetRef == Targets.Num())
+		{
+			UObject* Target = Command.TargetInventory;
+			Map->SerializeObject(Ar, UInventoryComponent::StaticClass(), Target);
+			Targets.Add(Target);
+		}
+		else if (!Targets.IsValidIndex(TargetRef))
+		{
+			Ar.SetError();
+			bOutSuccess = false;
+			return false;
+		}
+		if (Ar.IsLoading()) Command.TargetInventory = Cast<UInventoryComponent>(Targets[TargetRef]);
+	}
+	
+	return !Ar.IsError();
+}
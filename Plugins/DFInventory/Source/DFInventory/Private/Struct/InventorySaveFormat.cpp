@@ -0,0 +1,480 @@
+#include "Struct/InventorySaveFormat.h"
+#include "Settings/InventorySaveGame.h"
+#include "Data/ItemData.h"
+#include "Engine/Texture2D.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/ObjectAndNameAsStringProxyArchive.h"
+#include "UObject/SoftObjectPath.h"
+#include "Misc/Crc.h"
+#include "Misc/Compression.h"
+#include "Settings/DFInventorySettings.h"
+
+namespace InventorySaveFormat
+{
+	// Same override bits as the network format: a field is stored only when it differs from the definition.
+	enum EFieldOverride : uint8
+	{
+		Override_Icon        = 1 << 0,
+		Override_ItemName    = 1 << 1,
+		Override_Description = 1 << 2,
+		Override_MaxAmount   = 1 << 3,
+		Override_ExtraInfo   = 1 << 4,
+		Override_Fragments   = 1 << 5,
+	};
+	
+	// Magic, version, flags, payload size, payload CRC.
+	constexpr int32 HeaderSize = sizeof(uint32) + sizeof(uint16) + sizeof(uint16) + sizeof(uint32) + sizeof(uint32);
+	
+	// Guards against corrupt files allocating huge arrays.
+	constexpr uint32 MaxFragments = 64;
+	constexpr uint32 MaxSlotCount = 1 << 20;
+	
+	// ZigZag so small negative values stay small once packed.
+	void SerializePackedInt(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = Ar.IsSaving() ? (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31) : 0;
+		Ar.SerializeIntPacked(Packed);
+		if (Ar.IsLoading())
+		{ Value = static_cast<int32>(Packed >> 1) ^ -static_cast<int32>(Packed & 1); }
+	}
+	
+	// Instanced structs go through their own tagged serialization into a sized blob.
+	void SerializeBlob(FArchive& Ar, FInstancedStruct& Struct)
+	{
+		TArray<uint8> Blob;
+		if (Ar.IsSaving())
+		{
+			FMemoryWriter BlobWriter(Blob);
+			FObjectAndNameAsStringProxyArchive Proxy(BlobWriter, false);
+			Struct.Serialize(Proxy);
+		}
+		Ar << Blob;
+		if (Ar.IsLoading() && !Ar.IsError())
+		{
+			FMemoryReader BlobReader(Blob);
+			FObjectAndNameAsStringProxyArchive Proxy(BlobReader, true);
+			Struct.Serialize(Proxy);
+		}
+	}
+	
+	void SerializeObjectPath(FArchive& Ar, UObject*& Object, UClass* ExpectedClass)
+	{
+		FString Path = Ar.IsSaving() && Object ? FSoftObjectPath(Object).ToString() : FString();
+		Ar << Path;
+		if (Ar.IsLoading())
+		{
+			const FSoftObjectPath SoftPath(Path);
+			UObject* Loaded = SoftPath.IsNull() ? nullptr : SoftPath.ResolveObject();
+			if (!Loaded && !SoftPath.IsNull()) Loaded = SoftPath.TryLoad();
+			Object = Loaded && Loaded->IsA(ExpectedClass) ? Loaded : nullptr;
+		}
+	}
+	
+	// Only assets look the same in the next session; runtime definitions (often the item itself) store every field.
+	bool IsBaselineDefinition(const UItemData* Definition)
+	{ return Definition && Definition->IsAsset(); }
+	
+	// Copied rather than referenced because a self-referencing definition owns the struct being written.
+	FItemStruct GetBaseline(const UItemData* Definition, bool bUseDefinition)
+	{
+		static const FItemStruct DefaultInfo;
+		return bUseDefinition && Definition ? Definition->GetInfoRef() : DefaultInfo;
+	}
+	
+	uint8 GetOverrides(const FItemStruct& Info, const FItemStruct& Baseline)
+	{
+		uint8 Mask = 0;
+		if (Info.Icon != Baseline.Icon) Mask |= Override_Icon;
+		if (!Info.ItemName.Equals(Baseline.ItemName, ESearchCase::CaseSensitive)) Mask |= Override_ItemName;
+		if (!Info.Description.IdenticalTo(Baseline.Description) && !Info.Description.EqualTo(Baseline.Description)) Mask |= Override_Description;
+		if (Info.MaxAmount != Baseline.MaxAmount) Mask |= Override_MaxAmount;
+		if (!(Info.ExtraInfo == Baseline.ExtraInfo)) Mask |= Override_ExtraInfo;
+		if (Info.Fragments != Baseline.Fragments) Mask |= Override_Fragments;
+		return Mask;
+	}
+	
+	// Fields shared by writer and reader, after the mask is known.
+	void SerializeOverrides(FArchive& Ar, FItemStruct& Info, uint8 Mask)
+	{
+		if (Mask & Override_Icon)
+		{
+			UObject* Icon = Info.Icon;
+			SerializeObjectPath(Ar, Icon, UTexture2D::StaticClass());
+			Info.Icon = Cast<UTexture2D>(Icon);
+		}
+		if (Mask & Override_ItemName) Ar << Info.ItemName;
+		if (Mask & Override_Description) Ar << Info.Description;
+		if (Mask & Override_MaxAmount) SerializePackedInt(Ar, Info.MaxAmount);
+		if (Mask & Override_ExtraInfo) SerializeBlob(Ar, Info.ExtraInfo);
+		if (Mask & Override_Fragments)
+		{
+			uint32 Num = Info.Fragments.Num();
+			Ar.SerializeIntPacked(Num);
+			if (Ar.IsLoading())
+			{
+				if (Num > MaxFragments)
+				{
+					Ar.SetError();
+					return;
+				}
+				Info.Fragments.SetNum(Num);
+			}
+			for (FInstancedStruct& Fragment : Info.Fragments)
+			{ SerializeBlob(Ar, Fragment); }
+		}
+	}
+	
+	void WriteItem(FArchive& Ar, const FItemStruct& InInfo)
+	{
+		FItemStruct Info = InInfo;
+		UObject* Definition = Info.ParentItem;
+		SerializeObjectPath(Ar, Definition, UItemData::StaticClass());
+		uint8 bBaseline = IsBaselineDefinition(Info.ParentItem);
+		Ar << bBaseline;
+		SerializePackedInt(Ar, Info.Amount);
+		
+		uint8 Mask = GetOverrides(Info, GetBaseline(Info.ParentItem, bBaseline != 0));
+		Ar << Mask;
+		SerializeOverrides(Ar, Info, Mask);
+	}
+	
+	bool ReadItem(FArchive& Ar, FItemStruct& OutInfo)
+	{
+		UObject* Object = nullptr;
+		SerializeObjectPath(Ar, Object, UItemData::StaticClass());
+		uint8 bBaseline = 0;
+		Ar << bBaseline;
+		
+		UItemData* Definition = Cast<UItemData>(Object);
+		FItemStruct Info = GetBaseline(Definition, bBaseline != 0);
+		Info.ParentItem = Definition;
+		SerializePackedInt(Ar, Info.Amount);
+		
+		uint8 Mask = 0;
+		Ar << Mask;
+		SerializeOverrides(Ar, Info, Mask);
+		if (Ar.IsError()) return false;
+		
+		OutInfo = MoveTemp(Info);
+		return true;
+	}
+	
+	constexpr uint32 CompressedMagic = 0x43494644; // "DFIC"
+	
+	// Magic, codec, three reserved bytes, uncompressed size.
+	constexpr int32 CompressedHeaderSize = sizeof(uint32) + 4 + sizeof(uint32);
+	
+	FName GetFormatName(EInventorySaveCompression Codec)
+	{
+		switch (Codec)
+		{
+		case EInventorySaveCompression::Zlib: return NAME_Zlib;
+		case EInventorySaveCompression::Oodle: return NAME_Oodle;
+		default: return NAME_None;
+		}
+	}
+	
+	// FCompression takes the level as a speed/size bias; each codec maps it to its own levels.
+	ECompressionFlags GetCompressionFlags(EInventoryCompressionLevel Level)
+	{
+		switch (Level)
+		{
+		case EInventoryCompressionLevel::Fast: return COMPRESS_BiasSpeed;
+		case EInventoryCompressionLevel::Smallest: return COMPRESS_BiasSize;
+		default: return COMPRESS_NoFlags;
+		}
+	}
+	
+	FCompressionOptions FCompressionOptions::FromSettings()
+	{
+		const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
+		return { Settings->SaveCompression, Settings->SaveCompressionLevel };
+	}
+	
+	bool IsCompressed(TConstArrayView<uint8> Bytes)
+	{
+		uint32 FileMagic = 0;
+		if (Bytes.Num() < CompressedHeaderSize) return false;
+		FMemory::Memcpy(&FileMagic, Bytes.GetData(), sizeof(FileMagic));
+		return FileMagic == CompressedMagic;
+	}
+	
+	void Compress(TArray<uint8>& Bytes, const FCompressionOptions& Options)
+	{
+		const FName FormatName = GetFormatName(Options.Codec);
+		if (FormatName.IsNone() || Bytes.IsEmpty()) return;
+		
+		const ECompressionFlags Flags = GetCompressionFlags(Options.Level);
+		int32 CompressedSize = FCompression::CompressMemoryBound(FormatName, Bytes.Num(), Flags);
+		TArray<uint8> Compressed;
+		Compressed.SetNumUninitialized(CompressedHeaderSize + CompressedSize);
+		if (!FCompression::CompressMemory(FormatName, Compressed.GetData() + CompressedHeaderSize, CompressedSize, Bytes.GetData(), Bytes.Num(), Flags)
+			|| CompressedHeaderSize + CompressedSize >= Bytes.Num())
+		{ return; }
+		
+		const uint32 Magic = CompressedMagic;
+		const uint8 Codec[4] = { static_cast<uint8>(Options.Codec), 0, 0, 0 };
+		const uint32 UncompressedSize = Bytes.Num();
+		FMemory::Memcpy(Compressed.GetData(), &Magic, sizeof(Magic));
+		FMemory::Memcpy(Compressed.GetData() + sizeof(Magic), Codec, sizeof(Codec));
+		FMemory::Memcpy(Compressed.GetData() + sizeof(Magic) + sizeof(Codec), &UncompressedSize, sizeof(UncompressedSize));
+		Compressed.SetNum(CompressedHeaderSize + CompressedSize, EAllowShrinking::No);
+		Bytes = MoveTemp(Compressed);
+	}
+	
+	bool Decompress(TArray<uint8>& Bytes)
+	{
+		if (!IsCompressed(Bytes)) return true;
+		
+		uint32 UncompressedSize = 0;
+		FMemory::Memcpy(&UncompressedSize, Bytes.GetData() + sizeof(uint32) + 4, sizeof(UncompressedSize));
+		const FName FormatName = GetFormatName(static_cast<EInventorySaveCompression>(Bytes[sizeof(uint32)]));
+		if (FormatName.IsNone() || UncompressedSize > MAX_int32) return false;
+		
+		TArray<uint8> Uncompressed;
+		Uncompressed.SetNumUninitialized(UncompressedSize);
+		if (!FCompression::UncompressMemory(FormatName, Uncompressed.GetData(), UncompressedSize,
+			Bytes.GetData() + CompressedHeaderSize, Bytes.Num() - CompressedHeaderSize))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[Inventory] Rejected corrupt compressed save (%d bytes)"), Bytes.Num());
+			return false;
+		}
+		Bytes = MoveTemp(Uncompressed);
+		return true;
+	}
+	
+	bool IsBinary(TConstArrayView<uint8> Bytes)
+	{
+		uint32 FileMagic = 0;
+		if (Bytes.Num() < HeaderSize) return false;
+		FMemory::Memcpy(&FileMagic, Bytes.GetData(), sizeof(FileMagic));
+		return FileMagic == Magic;
+	}
+	
+	// Stacks of one kind share everything but Amount and ExtraInfo.
+	bool IsSameKind(const FItemStruct& A, const FItemStruct& B)
+	{ return A.ParentItem == B.ParentItem && (GetOverrides(A, B) & ~Override_ExtraInfo) == 0; }
+	
+	uint32 GetKindHash(const FItemStruct& Info)
+	{ return HashCombine(HashCombine(GetTypeHash(Info.ParentItem), GetTypeHash(Info.ItemName)), GetTypeHash(Info.MaxAmount)); }
+	
+	void Write(const FItemSaveData& Data, TArray<uint8>& OutBytes)
+	{
+		// Occupied slots in ascending order, so each one only needs the gap to the previous.
+		const bool bSparse = Data.SlotIndexes.Num() == Data.Items.Num();
+		TArray<int32> Order;
+		Order.Reserve(Data.Items.Num());
+		for (int32 i = 0; i < Data.Items.Num(); ++i) Order.Add(i);
+		if (bSparse) Order.Sort([&Data](int32 A, int32 B){ return Data.SlotIndexes[A] < Data.SlotIndexes[B]; });
+		
+		TArray<UItemData*> Definitions;
+		for (const FItemStruct& Info : Data.Items)
+		{ if (Info.ParentItem) Definitions.AddUnique(Info.ParentItem); }
+		
+		// First item of each kind, and the kind of every item.
+		TArray<int32> Kinds;
+		TArray<int32> ItemKinds;
+		TMultiMap<uint32, int32> KindsByHash;
+		ItemKinds.SetNumUninitialized(Data.Items.Num());
+		for (int32 i = 0; i < Data.Items.Num(); ++i)
+		{
+			const FItemStruct& Info = Data.Items[i];
+			const uint32 Hash = GetKindHash(Info);
+			int32 Kind = INDEX_NONE;
+			for (auto It = KindsByHash.CreateConstKeyIterator(Hash); It && Kind == INDEX_NONE; ++It)
+			{ if (IsSameKind(Info, Data.Items[Kinds[It.Value()]])) Kind = It.Value(); }
+			if (Kind == INDEX_NONE)
+			{
+				Kind = Kinds.Add(i);
+				KindsByHash.Add(Hash, Kind);
+			}
+			ItemKinds[i] = Kind;
+		}
+		
+		TArray<uint8> Payload;
+		FMemoryWriter Ar(Payload);
+		
+		int32 MaxSlots = Data.MaxSlots;
+		SerializePackedInt(Ar, MaxSlots);
+		
+		uint32 NumDefinitions = Definitions.Num();
+		Ar.SerializeIntPacked(NumDefinitions);
+		for (UItemData* Definition : Definitions)
+		{
+			UObject* Object = Definition;
+			SerializeObjectPath(Ar, Object, UItemData::StaticClass());
+			uint8 bBaseline = IsBaselineDefinition(Definition);
+			Ar << bBaseline;
+		}
+		
+		// A slot stores its ExtraInfo only if it differs from what its kind starts with.
+		TArray<FInstancedStruct> KindExtraInfo;
+		uint32 NumKinds = Kinds.Num();
+		Ar.SerializeIntPacked(NumKinds);
+		for (int32 First : Kinds)
+		{
+			FItemStruct Info = Data.Items[First];
+			uint32 DefinitionRef = Info.ParentItem ? Definitions.IndexOfByKey(Info.ParentItem) + 1 : 0;
+			Ar.SerializeIntPacked(DefinitionRef);
+			
+			const FItemStruct Baseline = GetBaseline(Info.ParentItem, IsBaselineDefinition(Info.ParentItem));
+			uint8 Mask = GetOverrides(Info, Baseline) & ~Override_ExtraInfo;
+			Ar << Mask;
+			SerializeOverrides(Ar, Info, Mask);
+			KindExtraInfo.Add(Baseline.ExtraInfo);
+		}
+		
+		uint32 NumItems = Order.Num();
+		Ar.SerializeIntPacked(NumItems);
+		int32 PreviousSlot = -1;
+		for (int32 Entry : Order)
+		{
+			const FItemStruct& Info = Data.Items[Entry];
+			const int32 Slot = bSparse ? Data.SlotIndexes[Entry] : Entry;
+			uint32 SlotDelta = Slot - PreviousSlot - 1;
+			Ar.SerializeIntPacked(SlotDelta);
+			PreviousSlot = Slot;
+			
+			// Kind index with the ExtraInfo flag in the low bit.
+			const bool bOwnExtraInfo = !(Info.ExtraInfo == KindExtraInfo[ItemKinds[Entry]]);
+			uint32 KindRef = (uint32(ItemKinds[Entry]) << 1) | (bOwnExtraInfo ? 1 : 0);
+			Ar.SerializeIntPacked(KindRef);
+			int32 Amount = Info.Amount;
+			SerializePackedInt(Ar, Amount);
+			if (bOwnExtraInfo)
+			{
+				FInstancedStruct ExtraInfo = Info.ExtraInfo;
+				SerializeBlob(Ar, ExtraInfo);
+			}
+		}
+		
+		FMemoryWriter Header(OutBytes);
+		uint32 FileMagic = Magic;
+		uint16 Version = static_cast<uint16>(EVersion::Latest);
+		uint16 Flags = 0;
+		uint32 PayloadSize = Payload.Num();
+		uint32 PayloadCrc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+		Header << FileMagic << Version << Flags << PayloadSize << PayloadCrc;
+		OutBytes.Append(Payload);
+	}
+	
+	// A definition that failed to resolve leaves unstored fields at their defaults.
+	FItemStruct GetDefinitionBaseline(const TArray<TPair<UItemData*, bool>>& Definitions, uint32 DefinitionRef)
+	{
+		const TPair<UItemData*, bool> Definition = DefinitionRef > 0 ? Definitions[DefinitionRef - 1] : TPair<UItemData*, bool>(nullptr, false);
+		FItemStruct Info = GetBaseline(Definition.Key, Definition.Value);
+		Info.ParentItem = Definition.Key;
+		return Info;
+	}
+	
+	bool Read(TConstArrayView<uint8> Bytes, FItemSaveData& OutData)
+	{
+		if (!IsBinary(Bytes)) return false;
+		
+		TArray<uint8> HeaderBytes(Bytes.GetData(), HeaderSize);
+		FMemoryReader Header(HeaderBytes);
+		uint32 FileMagic = 0, PayloadSize = 0, PayloadCrc = 0;
+		uint16 Version = 0, Flags = 0;
+		Header << FileMagic << Version << Flags << PayloadSize << PayloadCrc;
+		
+		const uint8* PayloadData = Bytes.GetData() + HeaderSize;
+		if (Version == 0 || Version > static_cast<uint16>(EVersion::Latest)
+			|| PayloadSize != static_cast<uint32>(Bytes.Num() - HeaderSize)
+			|| PayloadCrc != FCrc::MemCrc32(PayloadData, PayloadSize))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[Inventory] Rejected binary save (version %d, %d bytes)"), Version, Bytes.Num());
+			return false;
+		}
+		
+		TArray<uint8> Payload(PayloadData, PayloadSize);
+		FMemoryReader Ar(Payload);
+		FItemSaveData Data;
+		
+		SerializePackedInt(Ar, Data.MaxSlots);
+		if (Data.MaxSlots < 0 || static_cast<uint32>(Data.MaxSlots) > MaxSlotCount) return false;
+		
+		uint32 NumDefinitions = 0;
+		Ar.SerializeIntPacked(NumDefinitions);
+		if (NumDefinitions > static_cast<uint32>(Data.MaxSlots)) return false;
+		
+		TArray<TPair<UItemData*, bool>> Definitions;
+		Definitions.SetNum(NumDefinitions);
+		for (TPair<UItemData*, bool>& Definition : Definitions)
+		{
+			UObject* Object = nullptr;
+			SerializeObjectPath(Ar, Object, UItemData::StaticClass());
+			uint8 bBaseline = 0;
+			Ar << bBaseline;
+			Definition = { Cast<UItemData>(Object), bBaseline != 0 };
+		}
+		
+		const bool bHasKinds = Version >= static_cast<uint16>(EVersion::ItemKinds);
+		TArray<FItemStruct> Kinds;
+		if (bHasKinds)
+		{
+			uint32 NumKinds = 0;
+			Ar.SerializeIntPacked(NumKinds);
+			if (NumKinds > static_cast<uint32>(Data.MaxSlots)) return false;
+			
+			Kinds.Reserve(NumKinds);
+			for (uint32 i = 0; i < NumKinds && !Ar.IsError(); ++i)
+			{
+				uint32 DefinitionRef = 0;
+				Ar.SerializeIntPacked(DefinitionRef);
+				uint8 Mask = 0;
+				Ar << Mask;
+				if (DefinitionRef > NumDefinitions || (Mask & Override_ExtraInfo)) return false;
+				
+				FItemStruct& Kind = Kinds.Add_GetRef(GetDefinitionBaseline(Definitions, DefinitionRef));
+				SerializeOverrides(Ar, Kind, Mask);
+			}
+		}
+		
+		uint32 NumItems = 0;
+		Ar.SerializeIntPacked(NumItems);
+		if (NumItems > static_cast<uint32>(Data.MaxSlots)) return false;
+		
+		Data.Items.Reserve(NumItems);
+		Data.SlotIndexes.Reserve(NumItems);
+		int64 Slot = -1;
+		for (uint32 i = 0; i < NumItems && !Ar.IsError(); ++i)
+		{
+			uint32 SlotDelta = 0;
+			Ar.SerializeIntPacked(SlotDelta);
+			Slot += int64(SlotDelta) + 1;
+			if (Slot >= Data.MaxSlots) return false;
+			
+			FItemStruct Info;
+			if (bHasKinds)
+			{
+				uint32 KindRef = 0;
+				Ar.SerializeIntPacked(KindRef);
+				if ((KindRef >> 1) >= static_cast<uint32>(Kinds.Num())) return false;
+				
+				Info = Kinds[KindRef >> 1];
+				SerializePackedInt(Ar, Info.Amount);
+				if (KindRef & 1) SerializeBlob(Ar, Info.ExtraInfo);
+			}
+			else
+			{
+				uint32 DefinitionRef = 0;
+				Ar.SerializeIntPacked(DefinitionRef);
+				if (DefinitionRef > NumDefinitions) return false;
+				
+				Info = GetDefinitionBaseline(Definitions, DefinitionRef);
+				SerializePackedInt(Ar, Info.Amount);
+				uint8 Mask = 0;
+				Ar << Mask;
+				SerializeOverrides(Ar, Info, Mask);
+			}
+			
+			Data.Items.Add(MoveTemp(Info));
+			Data.SlotIndexes.Add(static_cast<int32>(Slot));
+		}
+		if (Ar.IsError()) return false;
+		
+		OutData = MoveTemp(Data);
+		return true;
+	}
+}
@@ -0,0 +1,118 @@
+#include "InventorySlotNetSerializer.h"
+#include "Struct/InventorySlots.h"
+#include "Iris/ReplicationState/PropertyNetSerializerInfoRegistry.h"
+#include "Iris/Serialization/NetBitStreamReader.h"
+#include "Iris/Serialization/NetBitStreamUtil.h"
+#include "Iris/Serialization/NetBitStreamWriter.h"
+#include "Iris/Serialization/NetSerializerDelegates.h"
+
+// Only registered where Iris replicates; the config struct in the header exists in every build.
+#if UE_WITH_IRIS
+namespace UE::Net
+{
+
+struct FInventorySlotHeaderNetSerializer
+{
+	static constexpr uint32 Version = 0;
+
+	// Same encoding as the generic NetSerialize: index shifted by one, amount ZigZag-encoded.
+	struct FQuantizedType
+	{
+		uint32 PackedIndex;
+		uint32 PackedAmount;
+	};
+
+	typedef FInventorySlotHeader SourceType;
+	typedef FQuantizedType QuantizedType;
+	typedef FInventorySlotHeaderNetSerializerConfig ConfigType;
+
+	static const ConfigType DefaultConfig;
+
+	static void Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args);
+	static void Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args);
+
+	static void SerializeDelta(FNetSerializationContext& Context, const FNetSerializeDeltaArgs& Args)
+	{ NetSerializeDeltaDefault<Serialize>(Context, Args); }
+	static void DeserializeDelta(FNetSerializationContext& Context, const FNetDeserializeDeltaArgs& Args)
+	{ NetDeserializeDeltaDefault<Deserialize>(Context, Args); }
+
+	static void Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args);
+	static void Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args);
+	static bool IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args);
+	static bool Validate(FNetSerializationContext& Context, const FNetValidateArgs& Args) { return true; }
+
+private:
+	class FNetSerializerRegistryDelegates final : private UE::Net::FNetSerializerRegistryDelegates
+	{
+	public:
+		virtual ~FNetSerializerRegistryDelegates();
+
+	private:
+		virtual void OnPreFreezeNetSerializerRegistry() override;
+	};
+
+	static FInventorySlotHeaderNetSerializer::FNetSerializerRegistryDelegates NetSerializerRegistryDelegates;
+};
+
+UE_NET_IMPLEMENT_SERIALIZER(FInventorySlotHeaderNetSerializer);
+
+const FInventorySlotHeaderNetSerializer::ConfigType FInventorySlotHeaderNetSerializer::DefaultConfig;
+FInventorySlotHeaderNetSerializer::FNetSerializerRegistryDelegates FInventorySlotHeaderNetSerializer::NetSerializerRegistryDelegates;
+
+static const FName PropertyNetSerializerRegistry_NAME_InventorySlotHeader("InventorySlotHeader");
+UE_NET_IMPLEMENT_NAMED_STRUCT_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_InventorySlotHeader, FInventorySlotHeaderNetSerializer);
+
+void FInventorySlotHeaderNetSerializer::Serialize(FNetSerializationContext& Context, const FNetSerializeArgs& Args)
+{
+	const QuantizedType& Value = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	FNetBitStreamWriter* Writer = Context.GetBitStreamWriter();
+	WritePackedUint32(Writer, Value.PackedIndex);
+	WritePackedUint32(Writer, Value.PackedAmount);
+}
+
+void FInventorySlotHeaderNetSerializer::Deserialize(FNetSerializationContext& Context, const FNetDeserializeArgs& Args)
+{
+	QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+	FNetBitStreamReader* Reader = Context.GetBitStreamReader();
+	Target.PackedIndex = ReadPackedUint32(Reader);
+	Target.PackedAmount = ReadPackedUint32(Reader);
+}
+
+void FInventorySlotHeaderNetSerializer::Quantize(FNetSerializationContext& Context, const FNetQuantizeArgs& Args)
+{
+	const SourceType& Source = *reinterpret_cast<const SourceType*>(Args.Source);
+	QuantizedType& Target = *reinterpret_cast<QuantizedType*>(Args.Target);
+	Target.PackedIndex = static_cast<uint32>(Source.SlotIndex + 1);
+	Target.PackedAmount = (static_cast<uint32>(Source.Amount) << 1) ^ static_cast<uint32>(Source.Amount >> 31);
+}
+
+void FInventorySlotHeaderNetSerializer::Dequantize(FNetSerializationContext& Context, const FNetDequantizeArgs& Args)
+{
+	const QuantizedType& Source = *reinterpret_cast<const QuantizedType*>(Args.Source);
+	SourceType& Target = *reinterpret_cast<SourceType*>(Args.Target);
+	Target.SlotIndex = static_cast<int32>(Source.PackedIndex) - 1;
+	Target.Amount = static_cast<int32>(Source.PackedAmount >> 1) ^ -static_cast<int32>(Source.PackedAmount & 1);
+}
+
+bool FInventorySlotHeaderNetSerializer::IsEqual(FNetSerializationContext& Context, const FNetIsEqualArgs& Args)
+{
+	if (Args.bStateIsQuantized)
+	{
+		const QuantizedType& A = *reinterpret_cast<const QuantizedType*>(Args.Source0);
+		const QuantizedType& B = *reinterpret_cast<const QuantizedType*>(Args.Source1);
+		return A.PackedIndex == B.PackedIndex && A.PackedAmount == B.PackedAmount;
+	}
+	
+	const SourceType& A = *reinterpret_cast<const SourceType*>(Args.Source0);
+	const SourceType& B = *reinterpret_cast<const SourceType*>(Args.Source1);
+	return A.SlotIndex == B.SlotIndex && A.Amount == B.Amount;
+}
+
+FInventorySlotHeaderNetSerializer::FNetSerializerRegistryDelegates::~FNetSerializerRegistryDelegates()
+{ UE_NET_UNREGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_InventorySlotHeader); }
+
+void FInventorySlotHeaderNetSerializer::FNetSerializerRegistryDelegates::OnPreFreezeNetSerializerRegistry()
+{ UE_NET_REGISTER_NETSERIALIZER_INFO(PropertyNetSerializerRegistry_NAME_InventorySlotHeader); }
+
+}
+#endif
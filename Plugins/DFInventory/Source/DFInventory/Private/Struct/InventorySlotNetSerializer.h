@@ -0,0 +1,17 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Iris/Serialization/NetSerializer.h"
+#include "InventorySlotNetSerializer.generated.h"
+
+USTRUCT()
+struct FInventorySlotHeaderNetSerializerConfig : public FNetSerializerConfig
+{
+	GENERATED_BODY()
+};
+
+namespace UE::Net
+{
+	// Iris counterpart of FInventorySlotHeader::NetSerialize: slot index and amount as packed varints.
+	UE_NET_DECLARE_SERIALIZER(FInventorySlotHeaderNetSerializer, DFINVENTORY_API);
+}
@@ -0,0 +1,180 @@
+#include "Struct/InventorySlots.h"
+#include "Component/InventoryComponent.h"
+#include "Data/ItemData.h"
+#include "Struct/InventoryNetStats.h"
+
+FInventoryNetStats& FInventoryNetStats::Get()
+{
+	static FInventoryNetStats Stats;
+	return Stats;
+}
+
+bool FInventorySlotEntry::CaptureState(UItemData* SourceItem)
+{
+	const FItemStruct Info = SourceItem->GetItemInfo();
+	
+	// A definition clients can't resolve by name (e.g. one created at runtime) arrives as null; send the full info instead.
+	UItemData* NewDefinition = Info.ParentItem && Info.ParentItem->IsNameStableForNetworking() ? Info.ParentItem : nullptr;
+	
+	FInstancedStruct NewPayload;
+	if (!NewDefinition)
+	{
+		NewPayload.InitializeAs<FItemStruct>(Info);
+	}
+	else
+	{
+		const FItemStruct DefinitionInfo = NewDefinition->GetItemInfo();
+		const bool bStaticsMatch = Info.Icon == DefinitionInfo.Icon
+			&& Info.ItemName.Equals(DefinitionInfo.ItemName, ESearchCase::CaseSensitive)
+			&& Info.Description.EqualTo(DefinitionInfo.Description)
+			&& Info.MaxAmount == DefinitionInfo.MaxAmount;
+		
+		if (!bStaticsMatch)
+		{
+			NewPayload.InitializeAs<FItemStruct>(Info);
+		}
+		else if (!(Info.ExtraInfo == DefinitionInfo.ExtraInfo) || Info.Fragments != DefinitionInfo.Fragments)
+		{
+			FItemInstancePayload Instance;
+			Instance.ExtraInfo = Info.ExtraInfo;
+			Instance.Fragments = Info.Fragments;
+			NewPayload.InitializeAs<FItemInstancePayload>(MoveTemp(Instance));
+		}
+	}
+	
+	if (Definition == NewDefinition && Header.Amount == Info.Amount && Payload == NewPayload) return false;
+	
+	Definition = NewDefinition;
+	Header.Amount = Info.Amount;
+	Payload = MoveTemp(NewPayload);
+	return true;
+}
+
+FItemStruct FInventorySlotEntry::ResolveInfo() const
+{
+	FItemStruct Info;
+	if (const FItemStruct* Full = Payload.GetPtr<FItemStruct>())
+	{ Info = *Full; }
+	else if (Definition)
+	{ Info = Definition->GetItemInfo(); }
+	
+	if (const FItemInstancePayload* Instance = Payload.GetPtr<FItemInstancePayload>())
+	{
+		Info.ExtraInfo = Instance->ExtraInfo;
+		Info.Fragments = Instance->Fragments;
+	}
+	
+	Info.ParentItem = Definition;
+	Info.Amount = Header.Amount;
+	return Info;
+}
+
+void FInventorySlotEntry::PreReplicatedRemove(const FInventorySlotArray& InArraySerializer)
+{
+	FInventoryClientRepScope RepScope;
+	if (InArraySerializer.Owner)
+	{ InArraySerializer.Owner->ApplyReplicatedSlot(Header.SlotIndex, nullptr); }
+}
+
+void FInventorySlotEntry::PostReplicatedAdd(const FInventorySlotArray& InArraySerializer)
+{ PostReplicatedChange(InArraySerializer); }
+
+void FInventorySlotEntry::PostReplicatedChange(const FInventorySlotArray& InArraySerializer)
+{
+	FInventoryClientRepScope RepScope;
+	if (!InArraySerializer.Owner) return;
+	
+	// Struct state is turned into item views once per bunch, in PostReplicatedReceive.
+	if (HasStructState())
+	{ InArraySerializer.Owner->QueueReplicatedSlotState(Header.SlotIndex); }
+	else
+	{ InArraySerializer.Owner->ApplyReplicatedSlot(Header.SlotIndex, Item); }
+}
+
+void FInventorySlotArray::PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters)
+{
+	FInventoryClientRepScope RepScope;
+	if (Owner)
+	{ Owner->FlushReplicatedSlotStates(); }
+}
+
+int32 FInventorySlotArray::FindEntryIndex(int32 SlotIndex) const
+{ return Slots.IndexOfByPredicate([SlotIndex](const FInventorySlotEntry& Entry){ return Entry.Header.SlotIndex == SlotIndex; }); }
+
+bool FInventorySlotArray::CaptureEntry(FInventorySlotEntry& Entry, UItemData* Item)
+{
+	// Read from the owner every time, so a mode set in defaults or Blueprint applies as well as SetReplicationMode.
+	if (Owner && !Owner->ReplicatesItemSubobjects())
+	{
+		Entry.Item = nullptr;
+		if (!Entry.CaptureState(Item)) return false;
+		
+		MarkItemDirty(Entry);
+		return true;
+	}
+	
+	if (Entry.Item == Item && !Entry.HasStructState()) return false;
+	
+	Entry.Item = Item;
+	Entry.Definition = nullptr;
+	Entry.Payload.Reset();
+	MarkItemDirty(Entry);
+	return true;
+}
+
+bool FInventorySlotArray::SetSlot(int32 SlotIndex, UItemData* Item)
+{
+	const int32 EntryIndex = FindEntryIndex(SlotIndex);
+	
+	if (!Item)
+	{
+		if (EntryIndex == INDEX_NONE) return false;
+		Slots.RemoveAtSwap(EntryIndex);
+		MarkArrayDirty();
+		return true;
+	}
+	
+	if (EntryIndex == INDEX_NONE)
+	{
+		FInventorySlotEntry& NewEntry = Slots.AddDefaulted_GetRef();
+		NewEntry.Header.SlotIndex = SlotIndex;
+		return CaptureEntry(NewEntry, Item);
+	}
+	
+	return CaptureEntry(Slots[EntryIndex], Item);
+}
+
+void FInventorySlotArray::Rebuild(const TArray<TObjectPtr<UItemData>>& Items)
+{ Rebuild(Items, [](int32){ return true; }); }
+
+void FInventorySlotArray::Rebuild(const TArray<TObjectPtr<UItemData>>& Items, TFunctionRef<bool(int32)> ShouldInclude)
+{
+	Slots.Reset();
+	for (int32 i = 0; i < Items.Num(); ++i)
+	{
+		if (!Items[i] || !ShouldInclude(i)) continue;
+		
+		FInventorySlotEntry& Entry = Slots.AddDefaulted_GetRef();
+		Entry.Header.SlotIndex = i;
+		CaptureEntry(Entry, Items[i]);
+	}
+	MarkArrayDirty();
+}
+
+bool FInventorySlotHeader::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Index shifted so INDEX_NONE packs, amount ZigZag-encoded so stray negatives stay small.
+	uint32 PackedIndex = Ar.IsSaving() ? static_cast<uint32>(SlotIndex + 1) : 0;
+	uint32 PackedAmount = Ar.IsSaving() ? (static_cast<uint32>(Amount) << 1) ^ static_cast<uint32>(Amount >> 31) : 0;
+	Ar.SerializeIntPacked(PackedIndex);
+	Ar.SerializeIntPacked(PackedAmount);
+	
+	if (Ar.IsLoading())
+	{
+		SlotIndex = static_cast<int32>(PackedIndex) - 1;
+		Amount = static_cast<int32>(PackedAmount >> 1) ^ -static_cast<int32>(PackedAmount & 1);
+	}
+	
+	bOutSuccess = true;
+	return true;
+}
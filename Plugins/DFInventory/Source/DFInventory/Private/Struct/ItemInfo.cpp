@@ -0,0 +1,153 @@
+#include "Struct/ItemInfo.h"
+#include "Data/ItemData.h"
+#include "Engine/Texture2D.h"
+#include "UObject/CoreNet.h"
+
+namespace ItemNetSerialization
+{
+	// One bit per field that is sent only when it differs from the baseline.
+	enum EFieldOverride : uint8
+	{
+		Override_Icon        = 1 << 0,
+		Override_ItemName    = 1 << 1,
+		Override_Description = 1 << 2,
+		Override_MaxAmount   = 1 << 3,
+		Override_ExtraInfo   = 1 << 4,
+		Override_Fragments   = 1 << 5,
+	};
+	constexpr uint32 OverrideBitCount = 6;
+	
+	// Guards against corrupt streams allocating huge fragment arrays.
+	constexpr uint32 MaxFragments = 64;
+	
+	// A definition is only a safe baseline when the receiver already holds the same object with the same values,
+	// i.e. data assets and other stable-named objects. Runtime items would be resolved mid-replication.
+	bool IsUsableDefinition(const UItemData* Definition)
+	{ return Definition && Definition->IsNameStableForNetworking(); }
+	
+	// ZigZag so small negative values stay small once packed.
+	void SerializePackedInt(FArchive& Ar, int32& Value)
+	{
+		uint32 Packed = Ar.IsSaving() ? (static_cast<uint32>(Value) << 1) ^ static_cast<uint32>(Value >> 31) : 0;
+		Ar.SerializeIntPacked(Packed);
+		if (Ar.IsLoading())
+		{ Value = static_cast<int32>(Packed >> 1) ^ -static_cast<int32>(Packed & 1); }
+	}
+	
+	// Fragments the baseline already carries unchanged are sent as an index into its list instead of in full.
+	void SerializeFragments(TArray<FInstancedStruct>& Fragments, const TArray<FInstancedStruct>& BaselineFragments,
+		FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+	{
+		uint32 Num = Fragments.Num();
+		Ar.SerializeIntPacked(Num);
+		if (Ar.IsLoading())
+		{
+			if (Num > MaxFragments)
+			{
+				Ar.SetError();
+				bOutSuccess = false;
+				return;
+			}
+			Fragments.SetNum(Num);
+		}
+		
+		for (FInstancedStruct& Fragment : Fragments)
+		{
+			// 0 means sent in full, otherwise baseline index + 1
+			uint32 BaselineRef = 0;
+			if (Ar.IsSaving())
+			{ BaselineRef = BaselineFragments.IndexOfByKey(Fragment) + 1; }
+			Ar.SerializeIntPacked(BaselineRef);
+			
+			if (BaselineRef == 0)
+			{
+				bool bFragmentSuccess = true;
+				Fragment.NetSerialize(Ar, Map, bFragmentSuccess);
+				bOutSuccess &= bFragmentSuccess;
+			}
+			else if (Ar.IsLoading())
+			{
+				if (BaselineFragments.IsValidIndex(BaselineRef - 1))
+				{ Fragment = BaselineFragments[BaselineRef - 1]; }
+				else
+				{
+					Fragment.Reset();
+					bOutSuccess = false;
+				}
+			}
+		}
+	}
+	
+	bool SerializeItem(FItemStruct& Item, FArchive& Ar, UPackageMap* Map, bool& bOutSuccess, bool bAllowDefinition)
+	{
+		bOutSuccess = true;
+		if (!Map)
+		{
+			bOutSuccess = false;
+			return false;
+		}
+		
+		UObject* Definition = Item.ParentItem;
+		Map->SerializeObject(Ar, UItemData::StaticClass(), Definition);
+		if (Ar.IsLoading())
+		{ Item.ParentItem = Cast<UItemData>(Definition); }
+		
+		uint8 bDefinitionBaseline = Ar.IsSaving() && bAllowDefinition && IsUsableDefinition(Item.ParentItem);
+		Ar.SerializeBits(&bDefinitionBaseline, 1);
+		
+		// If the definition failed to resolve on this end, unsent fields fall back to defaults.
+		// Copied rather than referenced because a self-referencing definition owns this very struct.
+		static const FItemStruct DefaultItem;
+		const FItemStruct Baseline = bDefinitionBaseline && Item.ParentItem ? Item.ParentItem->GetInfoRef() : DefaultItem;
+		
+		SerializePackedInt(Ar, Item.Amount);
+		
+		uint8 Overrides = 0;
+		if (Ar.IsSaving())
+		{
+			if (Item.Icon != Baseline.Icon) Overrides |= Override_Icon;
+			if (!Item.ItemName.Equals(Baseline.ItemName, ESearchCase::CaseSensitive)) Overrides |= Override_ItemName;
+			if (!Item.Description.EqualTo(Baseline.Description)) Overrides |= Override_Description;
+			if (Item.MaxAmount != Baseline.MaxAmount) Overrides |= Override_MaxAmount;
+			if (!(Item.ExtraInfo == Baseline.ExtraInfo)) Overrides |= Override_ExtraInfo;
+			if (Item.Fragments != Baseline.Fragments) Overrides |= Override_Fragments;
+		}
+		Ar.SerializeBits(&Overrides, OverrideBitCount);
+		
+		if (Overrides & Override_Icon)
+		{
+			UObject* Icon = Item.Icon;
+			Map->SerializeObject(Ar, UTexture2D::StaticClass(), Icon);
+			if (Ar.IsLoading()) Item.Icon = Cast<UTexture2D>(Icon);
+		}
+		else if (Ar.IsLoading()) Item.Icon = Baseline.Icon;
+		
+		if (Overrides & Override_ItemName) Ar << Item.ItemName;
+		else if (Ar.IsLoading()) Item.ItemName = Baseline.ItemName;
+		
+		if (Overrides & Override_Description) Ar << Item.Description;
+		else if (Ar.IsLoading()) Item.Description = Baseline.Description;
+		
+		if (Overrides & Override_MaxAmount) SerializePackedInt(Ar, Item.MaxAmount);
+		else if (Ar.IsLoading()) Item.MaxAmount = Baseline.MaxAmount;
+		
+		if (Overrides & Override_ExtraInfo)
+		{
+			bool bExtraSuccess = true;
+			Item.ExtraInfo.NetSerialize(Ar, Map, bExtraSuccess);
+			bOutSuccess &= bExtraSuccess;
+		}
+		else if (Ar.IsLoading()) Item.ExtraInfo = Baseline.ExtraInfo;
+		
+		if (Overrides & Override_Fragments) SerializeFragments(Item.Fragments, Baseline.Fragments, Ar, Map, bOutSuccess);
+		else if (Ar.IsLoading()) Item.Fragments = Baseline.Fragments;
+		
+		return !Ar.IsError();
+	}
+}
+
+bool FItemStruct::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{ return ItemNetSerialization::SerializeItem(*this, Ar, Map, bOutSuccess, true); }
+
+bool FItemStruct::NetSerializeWithoutDefinition(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{ return ItemNetSerialization::SerializeItem(*this, Ar, Map, bOutSuccess, false); }
@@ -1,20 +1,1060 @@
 #include "Subsystem/DFInventorySubsystem.h"
+#include "Component/InventoryComponent.h"
+#include "Settings/DFInventorySettings.h"
+#include "Struct/InventorySaveFormat.h"
+#include "Subsystem/InventorySQLiteStorage.h"
+#include "Kismet/GameplayStatics.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "Engine/Engine.h"
+#include "Engine/LevelStreaming.h"
+#include "Engine/World.h"
+#include "Streaming/LevelStreamingDelegates.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 WorldFileMagic = 0x57494644; // "DFIW"
+	constexpr uint16 WorldFileVersion = 1;
+	
+	// Magic, version, flags, index offset.
+	constexpr int64 WorldHeaderSize = sizeof(uint32) + sizeof(uint16) + sizeof(uint16) + sizeof(int64);
+	
+	constexpr uint32 LevelManifestMagic = 0x4C494644; // "DFIL"
+	constexpr uint16 LevelManifestVersion = 1;
+}
+
+void UDFInventorySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	if (GetDefault<UDFInventorySettings>()->bUseWorldSaveFile) OpenWorldFile();
+	
+	// Spill files are per game instance; PIE clients run several in one process.
+	FInventoryMemoryStore::FOptions StoreOptions;
+	StoreOptions.SpillPath = FPaths::ProjectSavedDir() / TEXT("Temp") / FString::Printf(TEXT("InventoryStore_%u.spill"), GetGameInstance()->GetUniqueID());
+	StoreOptions.BudgetBytes = int64(GetDefault<UDFInventorySettings>()->MemoryStoreBudget) * 1024 * 1024;
+	MemoryStore = MakeUnique<FInventoryMemoryStore>(StoreOptions);
+	
+	for (int32 i = 0; i < FMath::Max(GetDefault<UDFInventorySettings>()->MaxConcurrentSaveWrites, 1); ++i)
+	{ WritePipes.Add(MakeUnique<UE::Tasks::FPipe>(TEXT("InventorySaveWrites"))); }
+	
+	NextAutoSaveTime = FPlatformTime::Seconds() + GetDefault<UDFInventorySettings>()->AutoSaveInterval;
+	AutoSaveTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDFInventorySubsystem::TickAutoSave));
+	
+	StoragePipe = MakeUnique<UE::Tasks::FPipe>(TEXT("InventoryStorage"));
+	StorageTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UDFInventorySubsystem::TickStorage));
+	
+	LoadLevelManifest();
+	PreLoadMapHandle = FCoreUObjectDelegates::PreLoadMapWithContext.AddUObject(this, &UDFInventorySubsystem::HandlePreLoadMap);
+	LevelStreamingHandle = FLevelStreamingDelegates::OnLevelStreamingStateChanged.AddUObject(this, &UDFInventorySubsystem::HandleLevelStreamingStateChanged);
+}
+
+void UDFInventorySubsystem::Deinitialize()
+{
+	FTSTicker::GetCoreTicker().RemoveTicker(AutoSaveTickerHandle);
+	FTSTicker::GetCoreTicker().RemoveTicker(StorageTickerHandle);
+	FCoreUObjectDelegates::PreLoadMapWithContext.Remove(PreLoadMapHandle);
+	FLevelStreamingDelegates::OnLevelStreamingStateChanged.Remove(LevelStreamingHandle);
+	
+	// Quitting must not lose saves that are still being written.
+	FlushPendingSaves();
+	for (const TUniquePtr<UE::Tasks::FPipe>& Pipe : WritePipes) Pipe->WaitUntilEmpty();
+	WritePipes.Reset();
+	UE::Tasks::Wait(WorldPrefetchTasks);
+	WorldPrefetchTasks.Reset();
+	Prefetches.Reset();
+	LevelPrefetches.Reset();
+	WorldReader.Reset();
+	if (Journal) Journal->Close();
+	FlushStorage();
+	if (!StorageQueued.IsEmpty())
+	{ UE_LOG(LogTemp, Error, TEXT("[Inventory] %d inventories could not be stored before shutdown"), StorageQueued.Num()); }
+	if (Storage) Storage->Close();
+	Storage.Reset();
+	StoragePipe.Reset();
+	MemoryStore.Reset();
+	SaveLevelManifest();
+	Super::Deinitialize();
+}
+
+void UDFInventorySubsystem::AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector)
+{
+	Super::AddReferencedObjects(InThis, Collector);
+	
+	// Definitions and icons of data waiting to be written must outlive the write.
+	UDFInventorySubsystem* This = CastChecked<UDFInventorySubsystem>(InThis);
+	auto AddData = [&Collector, This](FItemSaveData& Data)
+	{ Collector.AddPropertyReferencesWithStructARO(FItemSaveData::StaticStruct(), &Data, This); };
+	
+	for (TPair<FString, FDiskSaveSlot>& Pair : This->DiskSaves)
+	{
+		if (Pair.Value.Queued.IsSet()) AddData(Pair.Value.Queued->Data);
+		if (Pair.Value.InFlight) AddData(const_cast<FItemSaveData&>(*Pair.Value.InFlight));
+	}
+	
+	for (const TSharedPtr<FWorldSaveBatch>& Batch : { This->WorldInFlight, This->WorldQueued })
+	{
+		if (!Batch) continue;
+		for (TPair<FString, FItemSaveData>& Entry : Batch->Entries) AddData(Entry.Value);
+	}
+	
+	for (TPair<FString, FPrefetch>& Pair : This->Prefetches)
+	{ if (Pair.Value.bFound) AddData(Pair.Value.Data); }
+	
+	if (This->MemoryStore) This->MemoryStore->AddReferencedObjects(Collector, This);
+}
 
 void UDFInventorySubsystem::StoreInventoryData(FName Key, const FItemSaveData& Data)
-{ SavedInventories.Add(Key, Data); }
+{ MemoryStore->Store(Key, CopyTemp(Data)); }
+
+void UDFInventorySubsystem::StoreInventoryData(FName Key, FItemSaveData&& Data)
+{ MemoryStore->Store(Key, MoveTemp(Data)); }
 
 bool UDFInventorySubsystem::RetrieveInventoryData(FName Key, FItemSaveData& OutData)
+{ return MemoryStore->Retrieve(Key, OutData); }
+
+bool UDFInventorySubsystem::TakeInventoryData(FName Key, FItemSaveData& OutData)
+{ return MemoryStore->Take(Key, OutData); }
+
+void UDFInventorySubsystem::RemoveStoredInventoryData(FName Key)
+{ MemoryStore->Remove(Key); }
+
+void UDFInventorySubsystem::ClearAllStoredInventoryData()
+{ MemoryStore->Empty(); }
+
+FInventoryJournal* UDFInventorySubsystem::GetJournal()
+{
+	if (Journal) return Journal->IsOpen() ? Journal.Get() : nullptr;
+	
+	const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
+	FInventoryJournal::FOptions Options;
+	Options.Directory = FPaths::ProjectSavedDir() / TEXT("SaveGames");
+	Options.Name = Settings->JournalName;
+	Options.CommitIntervalSeconds = Settings->JournalCommitInterval;
+	Options.CompactionBytes = int64(Settings->JournalCompactionSize) * 1024 * 1024;
+	
+	Journal = MakeUnique<FInventoryJournal>(Options);
+	if (!Journal->Open())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[Inventory] Could not open the inventory journal in %s"), *Options.Directory);
+		return nullptr;
+	}
+	UE_LOG(LogTemp, Log, TEXT("[Inventory] Journal replayed %lld records for %d inventories"), Journal->GetNumReplayedRecords(), Journal->GetNumInventories());
+	return Journal.Get();
+}
+
+IInventoryStorage* UDFInventorySubsystem::GetStorage()
+{
+	if (Storage || bStorageOpenFailed) return Storage.Get();
+	
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("SaveGames") / (GetDefault<UDFInventorySettings>()->StorageDatabaseName + TEXT(".db"));
+	SetStorage(MakeUnique<FInventorySQLiteStorage>(Path));
+	return Storage.Get();
+}
+
+void UDFInventorySubsystem::SetStorage(TUniquePtr<IInventoryStorage> NewStorage)
+{
+	FlushStorage();
+	if (Storage) Storage->Close();
+	Storage.Reset();
+	bStorageOpenFailed = false;
+	if (!NewStorage) return;
+	
+	if (!NewStorage->Open())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[Inventory] Could not open the inventory storage %s"), *NewStorage->GetDescription());
+		bStorageOpenFailed = true;
+		return;
+	}
+	Storage = MoveTemp(NewStorage);
+}
+
+bool UDFInventorySubsystem::WriteToStorage(const FString& SaveID, const FItemSaveData& Data)
+{
+	if (SaveID.IsEmpty() || !GetStorage()) return false;
+	
+	// Encoded now, so the batch holds no objects while it is committed.
+	TArray<uint8>& Bytes = StorageQueued.FindOrAdd(SaveID);
+	Bytes.Reset();
+	InventorySaveFormat::Write(Data, Bytes);
+	InventorySaveFormat::Compress(Bytes, InventorySaveFormat::FCompressionOptions::FromSettings());
+	return true;
+}
+
+bool UDFInventorySubsystem::RemoveFromStorage(const FString& SaveID)
+{
+	if (SaveID.IsEmpty() || !GetStorage()) return false;
+	StorageQueued.FindOrAdd(SaveID).Reset();
+	return true;
+}
+
+bool UDFInventorySubsystem::ReadFromStorage(const FString& SaveID, FItemSaveData& OutData)
+{
+	if (SaveID.IsEmpty() || !GetStorage()) return false;
+	
+	// The newest write wins: queued, then the batches being committed, then the database.
+	const TArray<uint8>* Pending = StorageQueued.Find(SaveID);
+	for (int32 i = StorageInFlight.Num() - 1; i >= 0 && !Pending; --i) Pending = StorageInFlight[i].Batch->Find(SaveID);
+	
+	TArray<uint8> Bytes;
+	if (Pending)
+	{
+		if (Pending->IsEmpty()) return false;
+		Bytes = *Pending;
+	}
+	else if (!Storage->Read(SaveID, Bytes)) return false;
+	
+	return InventorySaveFormat::Decompress(Bytes) && InventorySaveFormat::Read(Bytes, OutData);
+}
+
+void UDFInventorySubsystem::FlushStorage()
+{
+	CommitStorageBatch();
+	FinishStorageCommits(true);
+}
+
+bool UDFInventorySubsystem::TickStorage(float DeltaTime)
+{
+	// After a failed commit the retry waits a moment, so a storage that stays broken isn't hit every frame.
+	if (FPlatformTime::Seconds() >= StorageRetryTime) CommitStorageBatch();
+	FinishStorageCommits(false);
+	return true;
+}
+
+void UDFInventorySubsystem::CommitStorageBatch()
+{
+	if (StorageQueued.IsEmpty() || !Storage) return;
+	
+	TSharedPtr<const TMap<FString, TArray<uint8>>> Batch = MakeShared<const TMap<FString, TArray<uint8>>>(MoveTemp(StorageQueued));
+	StorageQueued.Reset();
+	
+	// The backend outlives the task: replacing it or shutting down flushes first.
+	IInventoryStorage* Target = Storage.Get();
+	UE::Tasks::TTask<bool> Task = StoragePipe->Launch(TEXT("InventoryStorageCommit"), [Target, Batch]() { return Target->Write(*Batch); });
+	StorageInFlight.Add({ Batch, MoveTemp(Task) });
+}
+
+void UDFInventorySubsystem::FinishStorageCommits(bool bWait)
+{
+	// Batches finish in order on the pipe; reported the same way.
+	while (!StorageInFlight.IsEmpty() && (bWait || StorageInFlight[0].Task.IsCompleted()))
+	{
+		FStorageCommit Commit = MoveTemp(StorageInFlight[0]);
+		StorageInFlight.RemoveAt(0);
+		const bool bSuccess = Commit.Task.GetResult();
+		if (!bSuccess)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[Inventory] A batch of %d inventories could not be committed to %s, retrying"),
+				Commit.Batch->Num(), Storage ? *Storage->GetDescription() : TEXT("the storage"));
+			
+			// The transaction stored none of them. Entries written again since, queued or in a later batch, are newer.
+			for (const TPair<FString, TArray<uint8>>& Pair : *Commit.Batch)
+			{
+				const bool bSuperseded = StorageQueued.Contains(Pair.Key) || StorageInFlight.ContainsByPredicate(
+					[&Pair](const FStorageCommit& Later) { return Later.Batch->Contains(Pair.Key); });
+				if (!bSuperseded) StorageQueued.Add(Pair.Key, Pair.Value);
+			}
+			StorageRetryTime = FPlatformTime::Seconds() + StorageRetryDelay;
+		}
+		for (const TPair<FString, TArray<uint8>>& Pair : *Commit.Batch)
+		{ if (!Pair.Value.IsEmpty()) OnInventorySaved.Broadcast(Pair.Key, bSuccess); }
+	}
+}
+
+int32 UDFInventorySubsystem::SaveAllDirtyInventories(ESaveType SaveType)
+{
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	FBulkSave Bulk;
+	
+	int32 NumSaved = 0;
+	for (auto It = Inventories.CreateIterator(); It; ++It)
+	{
+		UInventoryComponent* Inventory = It->Get();
+		if (!Inventory)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		if (!Inventory->IsSavedByPasses(SaveType) || !Inventory->IsSaveDirty(SaveType) || !Inventory->SaveInventory(SaveType)) continue;
+		
+		++NumSaved;
+		if (SaveType == ESaveType::Disk) Bulk.Remaining.Add(Inventory->GetSaveID());
+	}
+	
+	if (!Bulk.Remaining.IsEmpty())
+	{
+		Bulk.StartCycles = StartCycles;
+		Bulk.Stats.NumInventories = Bulk.Remaining.Num();
+		Bulk.Stats.SnapshotSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - StartCycles);
+		BulkSaves.Add(MoveTemp(Bulk));
+	}
+	return NumSaved;
+}
+
+void UDFInventorySubsystem::StartAutoSavePass()
+{
+	if (!AutoSaveQueue.IsEmpty()) return;
+	
+	struct FCandidate
+	{
+		double DirtySince;
+		UInventoryComponent* Inventory;
+	};
+	TArray<FCandidate> Candidates;
+	const double Now = FPlatformTime::Seconds();
+	for (auto It = Inventories.CreateIterator(); It; ++It)
+	{
+		UInventoryComponent* Inventory = It->Get();
+		if (!Inventory)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+		if (Inventory->IsLoadPending() || !Inventory->IsSavedByPasses(ESaveType::Disk) || !Inventory->IsSaveDirty(ESaveType::Disk)) continue;
+		
+		const double DirtySince = Inventory->GetDiskDirtySince();
+		Candidates.Add({ DirtySince > 0.0 ? DirtySince : Now, Inventory });
+	}
+	
+	// Popped from the back, so the oldest change goes last in the array.
+	Candidates.Sort([](const FCandidate& A, const FCandidate& B) { return A.DirtySince > B.DirtySince; });
+	AutoSaveQueue.Reserve(Candidates.Num());
+	for (const FCandidate& Candidate : Candidates) AutoSaveQueue.Add(Candidate.Inventory);
+	
+	AutoSaveStats.NumPending = AutoSaveQueue.Num();
+	AutoSaveStats.NumSaved = 0;
+	AutoSaveStats.NumFrames = 0;
+}
+
+bool UDFInventorySubsystem::TickAutoSave(float DeltaTime)
+{
+	const UDFInventorySettings* Settings = GetDefault<UDFInventorySettings>();
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	
+	if (AutoSaveQueue.IsEmpty())
+	{
+		if (Settings->AutoSaveInterval <= 0.0f || FPlatformTime::Seconds() < NextAutoSaveTime) return true;
+		NextAutoSaveTime = FPlatformTime::Seconds() + Settings->AutoSaveInterval;
+		StartAutoSavePass();
+		if (AutoSaveQueue.IsEmpty()) return true;
+	}
+	
+	// Building the queue counts against the first frame's budget; one inventory is always saved so the pass ends.
+	const uint64 BudgetCycles = uint64(Settings->AutoSaveFrameBudget / (FPlatformTime::GetSecondsPerCycle64() * 1000000.0));
+	do
+	{
+		UInventoryComponent* Inventory = AutoSaveQueue.Pop(EAllowShrinking::No).Get();
+		if (Inventory && Inventory->IsSaveDirty(ESaveType::Disk) && Inventory->SaveInventory(ESaveType::Disk)) ++AutoSaveStats.NumSaved;
+	}
+	while (!AutoSaveQueue.IsEmpty() && FPlatformTime::Cycles64() - StartCycles < BudgetCycles);
+	
+	AutoSaveStats.LastFrameMicroseconds = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles) * 1000.0;
+	AutoSaveStats.MaxFrameMicroseconds = FMath::Max(AutoSaveStats.MaxFrameMicroseconds, AutoSaveStats.LastFrameMicroseconds);
+	AutoSaveStats.NumPending = AutoSaveQueue.Num();
+	++AutoSaveStats.NumFrames;
+	
+	if (AutoSaveQueue.IsEmpty())
+	{
+		AutoSaveQueue.Empty();
+		UE_LOG(LogTemp, Verbose, TEXT("[Inventory] Autosave pass saved %d inventories over %d frames, at most %.0f us per frame"),
+			AutoSaveStats.NumSaved, AutoSaveStats.NumFrames, AutoSaveStats.MaxFrameMicroseconds);
+	}
+	return true;
+}
+
+void UDFInventorySubsystem::NoteSaveFinished(const FString& SaveID, bool bSuccess, const FInventorySaveCost& Cost)
+{
+	// A coalesced newer write is the one that counts.
+	if (BulkSaves.IsEmpty() || HasUnwrittenData(SaveID)) return;
+	
+	for (int32 i = BulkSaves.Num() - 1; i >= 0; --i)
+	{
+		FBulkSave& Bulk = BulkSaves[i];
+		if (Bulk.Remaining.Remove(SaveID) == 0) continue;
+		
+		FInventoryBulkSaveStats& Stats = Bulk.Stats;
+		Stats.NumFailed += bSuccess ? 0 : 1;
+		Stats.Bytes += Cost.Bytes;
+		Stats.SerializeSeconds += FPlatformTime::ToSeconds64(Cost.SerializeCycles);
+		Stats.WriteSeconds += FPlatformTime::ToSeconds64(Cost.WriteCycles);
+		if (!Bulk.Remaining.IsEmpty()) continue;
+		
+		Stats.WallSeconds = FPlatformTime::ToSeconds64(FPlatformTime::Cycles64() - Bulk.StartCycles);
+		LastBulkSaveStats = Stats;
+		BulkSaves.RemoveAt(i);
+		
+		UE_LOG(LogTemp, Log, TEXT("[Inventory] Saved %d inventories in %.1f ms (snapshot %.2f ms, %.3f ms per inventory on workers, %lld bytes, %d failed)"),
+			LastBulkSaveStats.NumInventories, LastBulkSaveStats.WallSeconds * 1000.0, LastBulkSaveStats.SnapshotSeconds * 1000.0,
+			LastBulkSaveStats.GetAverageCostMs(), LastBulkSaveStats.Bytes, LastBulkSaveStats.NumFailed);
+		OnBulkSaveFinished.Broadcast(LastBulkSaveStats);
+	}
+}
+
+void UDFInventorySubsystem::SaveInventoryDataAsync(const FString& SaveID, FItemSaveData&& Data, TSubclassOf<USaveGame> SaveGameClass, UInventoryComponent* Inventory)
+{
+	// A prefetch still reading would return what this save replaces; whoever waited on it gets this data instead.
+	TArray<TWeakObjectPtr<UInventoryComponent>> Deferred;
+	if (FPrefetch* Stale = Prefetches.Find(SaveID))
+	{
+		Deferred = MoveTemp(Stale->Deferred);
+		Prefetches.Remove(SaveID);
+	}
+	for (const TWeakObjectPtr<UInventoryComponent>& Waiting : Deferred)
+	{ if (Waiting.IsValid()) Waiting->HandleDeferredLoad(&Data); }
+	RecordInventoryLevel(SaveID, Inventory);
+	
+	if (UsesWorldFile(SaveGameClass))
+	{
+		QueueWorldSave(SaveID, MoveTemp(Data), Inventory);
+		return;
+	}
+	
+	FDiskSaveSlot& Slot = DiskSaves.FindOrAdd(SaveID);
+	
+	// Only the newest data matters; whoever waited on the replaced buffer is notified by this one.
+	FDiskSaveBuffer& Buffer = Slot.Queued.IsSet() ? Slot.Queued.GetValue() : Slot.Queued.Emplace();
+	Buffer.Data = MoveTemp(Data);
+	Buffer.SaveGameClass = SaveGameClass;
+	if (Inventory) Buffer.Waiters.Add(Inventory, Inventory->GetSaveRevision());
+	
+	if (!Slot.InFlight) StartDiskSave(SaveID, Slot);
+}
+
+void UDFInventorySubsystem::StartDiskSave(const FString& SaveID, FDiskSaveSlot& Slot)
+{
+	FDiskSaveBuffer Buffer = MoveTemp(Slot.Queued.GetValue());
+	Slot.Queued.Reset();
+	
+	UClass* SaveClass = Buffer.SaveGameClass && Buffer.SaveGameClass->IsChildOf<UInventorySaveGame>()
+		? Buffer.SaveGameClass.Get() : UInventorySaveGame::StaticClass();
+	// Subclasses of UInventorySaveGame may carry their own properties, so only the base class uses the binary format.
+	const bool bBinary = SaveClass == UInventorySaveGame::StaticClass()
+		&& GetDefault<UDFInventorySettings>()->SaveFormat == EInventorySaveFormat::Binary;
+	const TSharedRef<const FItemSaveData> Data = MakeShared<FItemSaveData>(MoveTemp(Buffer.Data));
+	
+	// The SaveGame format serializes a UObject through its reflected properties, which is only safe on the game thread,
+	// so it happens here and the worker only compresses. The binary format only reads the data and runs on the worker.
+	const TSharedRef<FDiskWrite> Write = MakeShared<FDiskWrite>();
+	if (!bBinary)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		UInventorySaveGame* SaveGame = Cast<UInventorySaveGame>(UGameplayStatics::CreateSaveGameObject(SaveClass));
+		SaveGame->SaveData = *Data;
+		Write->bSerialized = UGameplayStatics::SaveGameToMemory(SaveGame, Write->Bytes);
+		Write->Cost.SerializeCycles = FPlatformTime::Cycles64() - StartCycles;
+	}
+	
+	Slot.InFlight = Data;
+	Slot.InFlightWrite = Write;
+	Slot.InFlightWaiters = MoveTemp(Buffer.Waiters);
+	Slot.Serial = NextSaveSerial++;
+	
+	const uint32 Serial = Slot.Serial;
+	TWeakObjectPtr<UDFInventorySubsystem> WeakThis(this);
+	const InventorySaveFormat::FCompressionOptions Compression = InventorySaveFormat::FCompressionOptions::FromSettings();
+	
+	// Binary serialization and compression run on any worker, so many saves at once use every core. Writes go through
+	// a few pipes instead, so they don't all hit the disk at the same time.
+	const UE::Tasks::FTask SerializeTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Write, Data, bBinary, Compression]()
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		if (bBinary)
+		{
+			InventorySaveFormat::Write(*Data, Write->Bytes);
+			Write->bSerialized = true;
+		}
+		if (Write->bSerialized) InventorySaveFormat::Compress(Write->Bytes, Compression);
+		Write->Cost.SerializeCycles += FPlatformTime::Cycles64() - StartCycles;
+		Write->Cost.Bytes = Write->Bytes.Num();
+	});
+	
+	UE::Tasks::FPipe& Pipe = *WritePipes[NextWritePipe++ % WritePipes.Num()];
+	Slot.Task = Pipe.Launch(UE_SOURCE_LOCATION, [Write, SaveID, Serial, WeakThis]()
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		const bool bSuccess = Write->bSerialized && UGameplayStatics::SaveDataToSlot(Write->Bytes, SaveID, 0);
+		Write->Cost.WriteCycles = FPlatformTime::Cycles64() - StartCycles;
+		Write->Bytes.Empty();
+		
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, SaveID, Serial, bSuccess]()
+		{
+			if (UDFInventorySubsystem* Subsystem = WeakThis.Get())
+			{ Subsystem->FinishDiskSave(SaveID, Serial, bSuccess); }
+		});
+		return bSuccess;
+	}, UE::Tasks::Prerequisites(SerializeTask));
+}
+
+void UDFInventorySubsystem::FinishDiskSave(const FString& SaveID, uint32 Serial, bool bSuccess)
+{
+	// A flush may already have finished this write.
+	FDiskSaveSlot* Slot = DiskSaves.Find(SaveID);
+	if (!Slot || Slot->Serial != Serial || !Slot->InFlight) return;
+	
+	Slot->InFlight.Reset();
+	const FInventorySaveCost Cost = Slot->InFlightWrite->Cost;
+	Slot->InFlightWrite.Reset();
+	const FSaveWaiters Waiters = MoveTemp(Slot->InFlightWaiters);
+	if (Slot->Queued.IsSet())
+	{ StartDiskSave(SaveID, *Slot); }
+	else
+	{ DiskSaves.Remove(SaveID); }
+	
+	if (!bSuccess)
+	{ UE_LOG(LogTemp, Warning, TEXT("[Inventory] Failed to write save slot %s"), *SaveID); }
+	
+	OnInventorySaved.Broadcast(SaveID, bSuccess);
+	NotifyWaiters(Waiters, bSuccess);
+	NoteSaveFinished(SaveID, bSuccess, Cost);
+}
+
+void UDFInventorySubsystem::NotifyWaiters(const FSaveWaiters& Waiters, bool bSuccess)
+{
+	for (const TPair<TWeakObjectPtr<UInventoryComponent>, uint32>& Waiter : Waiters)
+	{ if (Waiter.Key.IsValid()) Waiter.Key->HandleDiskSaveFinished(Waiter.Value, bSuccess); }
+}
+
+void UDFInventorySubsystem::FlushPendingSaves()
+{
+	while (!DiskSaves.IsEmpty())
+	{
+		// Finishing a write starts the queued one or drops the slot, so walk a copy of the IDs.
+		TArray<FString> SaveIDs;
+		DiskSaves.GetKeys(SaveIDs);
+		for (const FString& SaveID : SaveIDs)
+		{
+			FDiskSaveSlot* Slot = DiskSaves.Find(SaveID);
+			if (!Slot) continue;
+			
+			if (!Slot->InFlight)
+			{
+				DiskSaves.Remove(SaveID);
+				continue;
+			}
+			Slot->Task.Wait();
+			FinishDiskSave(SaveID, Slot->Serial, Slot->Task.GetResult());
+		}
+	}
+	
+	// Finishing a world write starts the queued one, so loop until both buffers are on disk.
+	while (WorldInFlight || WorldQueued)
+	{
+		if (!WorldInFlight)
+		{
+			StartWorldSave();
+			continue;
+		}
+		WorldTask.Wait();
+		FinishWorldSave(WorldTask.GetResult());
+	}
+}
+
+bool UDFInventorySubsystem::FindUnwrittenData(const FString& SaveID, FItemSaveData& OutData) const
 {
-	if (SavedInventories.Contains(Key))
+	if (const FDiskSaveSlot* Slot = DiskSaves.Find(SaveID))
 	{
-		OutData = SavedInventories[Key];
+		if (Slot->Queued.IsSet())
+		{
+			OutData = Slot->Queued->Data;
+			return true;
+		}
+		if (Slot->InFlight)
+		{
+			OutData = *Slot->InFlight;
+			return true;
+		}
+	}
+	
+	for (const TSharedPtr<FWorldSaveBatch>& Batch : { WorldQueued, WorldInFlight })
+	{
+		if (const FItemSaveData* Pending = Batch ? Batch->Entries.Find(SaveID) : nullptr)
+		{
+			OutData = *Pending;
+			return true;
+		}
+	}
+	return false;
+}
+
+bool UDFInventorySubsystem::HasUnwrittenData(const FString& SaveID) const
+{
+	return DiskSaves.Contains(SaveID)
+		|| (WorldQueued && WorldQueued->Entries.Contains(SaveID))
+		|| (WorldInFlight && WorldInFlight->Entries.Contains(SaveID));
+}
+
+bool UDFInventorySubsystem::DecodeSaveData(const TArray<uint8>& Bytes, FItemSaveData& OutData)
+{
+	// Files are recognized by their header, so switching formats keeps older saves loadable.
+	if (InventorySaveFormat::IsBinary(Bytes))
+	{ return InventorySaveFormat::Read(Bytes, OutData); }
+	
+	if (const UInventorySaveGame* SaveGame = Cast<UInventorySaveGame>(UGameplayStatics::LoadGameFromMemory(Bytes)))
+	{
+		OutData = SaveGame->SaveData;
 		return true;
 	}
 	return false;
 }
 
-void UDFInventorySubsystem::RemoveStoredInventoryData(FName Key)
-{ SavedInventories.Remove(Key); }
+bool UDFInventorySubsystem::LoadInventoryDataFromDisk(UDFInventorySubsystem* Subsystem, const FString& SaveID, FItemSaveData& OutData, TSubclassOf<USaveGame> SaveGameClass)
+{
+	if (Subsystem)
+	{
+		// Data not yet on disk is newer than the file.
+		if (Subsystem->FindUnwrittenData(SaveID, OutData)) return true;
+		
+		// A finished prefetch already did the read; one still running is not waited for, the read below is as fast.
+		const bool bWorldFile = Subsystem->ReadsWorldFile(SaveID, SaveGameClass);
+		if (FPrefetch* Prefetch = Subsystem->Prefetches.Find(SaveID); Prefetch && Prefetch->bDone && Prefetch->bWorldFile == bWorldFile)
+		{
+			const bool bFound = Prefetch->bFound;
+			if (bFound) OutData = MoveTemp(Prefetch->Data);
+			Subsystem->Prefetches.Remove(SaveID);
+			return bFound;
+		}
+		
+		if (bWorldFile) return Subsystem->ReadWorldEntry(SaveID, OutData);
+	}
+	
+	TArray<uint8> Bytes;
+	return UGameplayStatics::LoadDataFromSlot(Bytes, SaveID, 0) && InventorySaveFormat::Decompress(Bytes) && DecodeSaveData(Bytes, OutData);
+}
 
-void UDFInventorySubsystem::ClearAllStoredInventoryData()
-{ SavedInventories.Empty(); }
+bool UDFInventorySubsystem::UsesWorldFile(TSubclassOf<USaveGame> SaveGameClass)
+{
+	return GetDefault<UDFInventorySettings>()->bUseWorldSaveFile
+		&& (!SaveGameClass || SaveGameClass == UInventorySaveGame::StaticClass());
+}
+
+FString UDFInventorySubsystem::GetWorldSavePath()
+{ return FPaths::ProjectSavedDir() / TEXT("SaveGames") / GetDefault<UDFInventorySettings>()->WorldSaveName + TEXT(".invworld"); }
+
+void UDFInventorySubsystem::QueueWorldSave(const FString& SaveID, FItemSaveData&& Data, UInventoryComponent* Inventory)
+{
+	if (!WorldQueued) WorldQueued = MakeShared<FWorldSaveBatch>();
+	WorldQueued->Entries.Add(SaveID, MoveTemp(Data));
+	if (Inventory) WorldQueued->Waiters.Add(Inventory, Inventory->GetSaveRevision());
+	
+	// Started on the next tick so every inventory saving this frame (e.g. on map change) shares one rewrite.
+	if (!WorldInFlight)
+	{
+		TWeakObjectPtr<UDFInventorySubsystem> WeakThis(this);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis]()
+		{
+			if (UDFInventorySubsystem* Subsystem = WeakThis.Get())
+			{ Subsystem->StartWorldSave(); }
+		});
+	}
+}
+
+void UDFInventorySubsystem::StartWorldSave()
+{
+	if (WorldInFlight || !WorldQueued) return;
+	
+	WorldInFlight = MoveTemp(WorldQueued);
+	WorldInFlight->Compression = InventorySaveFormat::FCompressionOptions::FromSettings();
+	const TSharedPtr<FWorldSaveBatch> Batch = WorldInFlight;
+	const FString TempPath = GetWorldSavePath() + TEXT(".tmp");
+	TWeakObjectPtr<UDFInventorySubsystem> WeakThis(this);
+	WorldTask = UE::Tasks::Launch(UE_SOURCE_LOCATION, [Batch, OldIndex = WorldIndex, TempPath, WeakThis]()
+	{
+		const bool bSuccess = WriteWorldFile(*Batch, OldIndex, TempPath);
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, Batch, bSuccess]()
+		{
+			// A flush may already have finished this write.
+			UDFInventorySubsystem* Subsystem = WeakThis.Get();
+			if (Subsystem && Subsystem->WorldInFlight == Batch)
+			{ Subsystem->FinishWorldSave(bSuccess); }
+		});
+		return bSuccess;
+	});
+}
+
+void UDFInventorySubsystem::FinishWorldSave(bool bSuccess)
+{
+	const TSharedPtr<FWorldSaveBatch> Batch = MoveTemp(WorldInFlight);
+	const FString Path = GetWorldSavePath();
+	
+	if (bSuccess)
+	{
+		// Closed before replacing it, some platforms can't move over open files. Prefetches read by the old index.
+		WorldReader.Reset();
+		UE::Tasks::Wait(WorldPrefetchTasks);
+		WorldPrefetchTasks.Reset();
+		bSuccess = IFileManager::Get().Move(*Path, *(Path + TEXT(".tmp")), true, true);
+		if (bSuccess) WorldIndex = MoveTemp(Batch->NewIndex);
+		WorldReader.Reset(IFileManager::Get().CreateFileReader(*Path));
+	}
+	
+	if (WorldQueued) StartWorldSave();
+	
+	if (!bSuccess)
+	{ UE_LOG(LogTemp, Warning, TEXT("[Inventory] Failed to write world save %s"), *Path); }
+	
+	for (const TPair<FString, FItemSaveData>& Entry : Batch->Entries)
+	{ OnInventorySaved.Broadcast(Entry.Key, bSuccess); }
+	NotifyWaiters(Batch->Waiters, bSuccess);
+	for (const TPair<FString, FItemSaveData>& Entry : Batch->Entries)
+	{ NoteSaveFinished(Entry.Key, bSuccess, Batch->Costs.FindRef(Entry.Key)); }
+}
+
+bool UDFInventorySubsystem::WriteWorldFile(FWorldSaveBatch& Batch, const TMap<FString, FWorldFileEntry>& OldIndex, const FString& TempPath)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*TempPath));
+	if (!Writer) return false;
+	
+	// Only the game thread's reader is swapped on finish, so a second reader on the current file is safe here.
+	TUniquePtr<FArchive> OldFile(OldIndex.IsEmpty() ? nullptr : IFileManager::Get().CreateFileReader(*GetWorldSavePath()));
+	if (!OldIndex.IsEmpty() && !OldFile) return false;
+	
+	uint32 Magic = WorldFileMagic;
+	uint16 Version = WorldFileVersion;
+	uint16 Flags = 0;
+	int64 IndexOffset = 0;
+	*Writer << Magic << Version << Flags << IndexOffset;
+	
+	auto WriteEntry = [&Batch, &Writer](const FString& SaveID, const TArray<uint8>& Bytes)
+	{
+		FWorldFileEntry& Entry = Batch.NewIndex.Add(SaveID);
+		Entry.Offset = Writer->Tell();
+		Entry.Size = Bytes.Num();
+		Writer->Serialize(const_cast<uint8*>(Bytes.GetData()), Bytes.Num());
+	};
+	
+	// Unchanged entries are copied as raw bytes, only the batch gets serialized.
+	TArray<uint8> Bytes;
+	for (const TPair<FString, FWorldFileEntry>& Old : OldIndex)
+	{
+		if (Batch.Entries.Contains(Old.Key)) continue;
+		Bytes.SetNumUninitialized(Old.Value.Size);
+		OldFile->Seek(Old.Value.Offset);
+		OldFile->Serialize(Bytes.GetData(), Bytes.Num());
+		if (OldFile->IsError()) return false;
+		WriteEntry(Old.Key, Bytes);
+	}
+	
+	// The batch is serialized in parallel, then appended in order.
+	TArray<const TPair<FString, FItemSaveData>*> NewEntries;
+	NewEntries.Reserve(Batch.Entries.Num());
+	for (const TPair<FString, FItemSaveData>& Entry : Batch.Entries) NewEntries.Add(&Entry);
+	
+	TArray<TArray<uint8>> Serialized;
+	TArray<uint64> SerializeCycles;
+	Serialized.SetNum(NewEntries.Num());
+	SerializeCycles.SetNumZeroed(NewEntries.Num());
+	ParallelFor(NewEntries.Num(), [&NewEntries, &Serialized, &SerializeCycles, &Batch](int32 i)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		InventorySaveFormat::Write(NewEntries[i]->Value, Serialized[i]);
+		InventorySaveFormat::Compress(Serialized[i], Batch.Compression);
+		SerializeCycles[i] = FPlatformTime::Cycles64() - StartCycles;
+	});
+	
+	for (int32 i = 0; i < NewEntries.Num(); ++i)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		WriteEntry(NewEntries[i]->Key, Serialized[i]);
+		FInventorySaveCost& Cost = Batch.Costs.Add(NewEntries[i]->Key);
+		Cost.SerializeCycles = SerializeCycles[i];
+		Cost.WriteCycles = FPlatformTime::Cycles64() - StartCycles;
+		Cost.Bytes = Serialized[i].Num();
+		Serialized[i].Empty();
+	}
+	
+	// The index goes last so entries can be streamed out; the header points at it.
+	IndexOffset = Writer->Tell();
+	uint32 NumEntries = Batch.NewIndex.Num();
+	Writer->SerializeIntPacked(NumEntries);
+	for (TPair<FString, FWorldFileEntry>& Entry : Batch.NewIndex)
+	{
+		FString SaveID = Entry.Key;
+		*Writer << SaveID << Entry.Value.Offset << Entry.Value.Size;
+	}
+	
+	Writer->Seek(0);
+	*Writer << Magic << Version << Flags << IndexOffset;
+	return Writer->Close();
+}
+
+void UDFInventorySubsystem::OpenWorldFile()
+{
+	WorldIndex.Reset();
+	WorldReader.Reset(IFileManager::Get().CreateFileReader(*GetWorldSavePath()));
+	if (!WorldReader) return;
+	
+	uint32 Magic = 0;
+	uint16 Version = 0, Flags = 0;
+	int64 IndexOffset = 0;
+	*WorldReader << Magic << Version << Flags << IndexOffset;
+	
+	const int64 FileSize = WorldReader->TotalSize();
+	if (Magic == WorldFileMagic && Version <= WorldFileVersion && IndexOffset >= WorldHeaderSize && IndexOffset < FileSize)
+	{
+		WorldReader->Seek(IndexOffset);
+		uint32 NumEntries = 0;
+		WorldReader->SerializeIntPacked(NumEntries);
+		WorldIndex.Reserve(FMath::Min<int64>(NumEntries, FileSize - IndexOffset));
+		for (uint32 i = 0; i < NumEntries && !WorldReader->IsError(); ++i)
+		{
+			FString SaveID;
+			FWorldFileEntry Entry;
+			*WorldReader << SaveID << Entry.Offset << Entry.Size;
+			if (Entry.Offset < WorldHeaderSize || Entry.Size < 0 || Entry.Offset + Entry.Size > IndexOffset) WorldReader->SetError();
+			WorldIndex.Add(MoveTemp(SaveID), Entry);
+		}
+	}
+	else
+	{ WorldReader->SetError(); }
+	
+	if (WorldReader->IsError())
+	{
+		UE_LOG(LogTemp, Warning, TEXT("[Inventory] Ignoring unreadable world save %s"), *GetWorldSavePath());
+		WorldIndex.Reset();
+		WorldReader.Reset();
+	}
+}
+
+bool UDFInventorySubsystem::ReadWorldEntry(const FString& SaveID, FItemSaveData& OutData)
+{
+	const FWorldFileEntry* Entry = WorldIndex.Find(SaveID);
+	if (!Entry || !WorldReader) return false;
+	
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(Entry->Size);
+	WorldReader->Seek(Entry->Offset);
+	WorldReader->Serialize(Bytes.GetData(), Bytes.Num());
+	if (WorldReader->IsError())
+	{
+		// Reopening clears the error for the next read.
+		WorldReader.Reset(IFileManager::Get().CreateFileReader(*GetWorldSavePath()));
+		return false;
+	}
+	return InventorySaveFormat::Decompress(Bytes) && InventorySaveFormat::Read(Bytes, OutData);
+}
+
+void UDFInventorySubsystem::PrefetchInventoryData(const TArray<FString>& SaveIDs)
+{
+	for (const FString& SaveID : SaveIDs)
+	{
+		if (SaveID.IsEmpty() || Prefetches.Contains(SaveID) || HasUnwrittenData(SaveID)) continue;
+		StartPrefetch(SaveID);
+	}
+}
+
+EInventoryDiskLoad UDFInventorySubsystem::LoadInventoryDataDeferred(const FString& SaveID, FItemSaveData& OutData, UInventoryComponent* Inventory, TSubclassOf<USaveGame> SaveGameClass)
+{
+	RecordInventoryLevel(SaveID, Inventory);
+	if (FindUnwrittenData(SaveID, OutData)) return EInventoryDiskLoad::Loaded;
+	
+	// Level prefetches don't know the save class; one that read the other source is started again, keeping its waiters.
+	FPrefetch* Prefetch = Prefetches.Find(SaveID);
+	if (!Prefetch || Prefetch->bWorldFile != ReadsWorldFile(SaveID, SaveGameClass))
+	{
+		TArray<TWeakObjectPtr<UInventoryComponent>> Deferred;
+		if (Prefetch) Deferred = MoveTemp(Prefetch->Deferred);
+		StartPrefetch(SaveID, SaveGameClass);
+		Prefetch = Prefetches.Find(SaveID);
+		Prefetch->Deferred = MoveTemp(Deferred);
+	}
+	if (!Prefetch->bDone)
+	{
+		if (Inventory) Prefetch->Deferred.AddUnique(Inventory);
+		return EInventoryDiskLoad::Pending;
+	}
+	
+	// Handed out once; a later load reads the disk again.
+	const bool bFound = Prefetch->bFound;
+	if (bFound) OutData = MoveTemp(Prefetch->Data);
+	Prefetches.Remove(SaveID);
+	return bFound ? EInventoryDiskLoad::Loaded : EInventoryDiskLoad::Missing;
+}
+
+void UDFInventorySubsystem::StartPrefetch(const FString& SaveID, TSubclassOf<USaveGame> SaveGameClass)
+{
+	FPrefetch& Prefetch = Prefetches.Add(SaveID);
+	Prefetch.Serial = NextPrefetchSerial++;
+	Prefetch.bWorldFile = ReadsWorldFile(SaveID, SaveGameClass);
+	
+	const TOptional<FWorldFileEntry> WorldEntry = Prefetch.bWorldFile ? TOptional<FWorldFileEntry>(WorldIndex[SaveID]) : NullOpt;
+	const FString WorldPath = GetWorldSavePath();
+	const uint32 Serial = Prefetch.Serial;
+	TWeakObjectPtr<UDFInventorySubsystem> WeakThis(this);
+	
+	// Only the read and decompression run here; decoding resolves item definitions, which needs the game thread.
+	UE::Tasks::FTask Task = UE::Tasks::Launch(UE_SOURCE_LOCATION, [SaveID, Serial, WorldEntry, WorldPath, WeakThis]()
+	{
+		TArray<uint8> Bytes;
+		bool bRead = false;
+		if (WorldEntry.IsSet())
+		{
+			TUniquePtr<FArchive> Reader(IFileManager::Get().CreateFileReader(*WorldPath));
+			if (Reader)
+			{
+				Bytes.SetNumUninitialized(WorldEntry->Size);
+				Reader->Seek(WorldEntry->Offset);
+				Reader->Serialize(Bytes.GetData(), Bytes.Num());
+				bRead = !Reader->IsError();
+			}
+		}
+		else
+		{ bRead = UGameplayStatics::LoadDataFromSlot(Bytes, SaveID, 0); }
+		bRead = bRead && InventorySaveFormat::Decompress(Bytes);
+		
+		AsyncTask(ENamedThreads::GameThread, [WeakThis, SaveID, Serial, Bytes = MoveTemp(Bytes), bRead]()
+		{
+			if (UDFInventorySubsystem* Subsystem = WeakThis.Get())
+			{ Subsystem->FinishPrefetch(SaveID, Serial, Bytes, bRead); }
+		});
+	});
+	
+	if (WorldEntry.IsSet())
+	{
+		WorldPrefetchTasks.RemoveAllSwap([](const UE::Tasks::FTask& Other) { return Other.IsCompleted(); });
+		WorldPrefetchTasks.Add(MoveTemp(Task));
+	}
+}
+
+void UDFInventorySubsystem::FinishPrefetch(const FString& SaveID, uint32 Serial, const TArray<uint8>& Bytes, bool bRead)
+{
+	// Dropped by a save of the same ID since.
+	FPrefetch* Prefetch = Prefetches.Find(SaveID);
+	if (!Prefetch || Prefetch->Serial != Serial) return;
+	
+	Prefetch->bDone = true;
+	Prefetch->bFound = bRead && DecodeSaveData(Bytes, Prefetch->Data);
+	if (Prefetch->Deferred.IsEmpty()) return;
+	
+	// Inventories already playing take the data now; it isn't kept for anyone else.
+	const FPrefetch Done = MoveTemp(*Prefetch);
+	Prefetches.Remove(SaveID);
+	for (const TWeakObjectPtr<UInventoryComponent>& Inventory : Done.Deferred)
+	{ if (Inventory.IsValid()) Inventory->HandleDeferredLoad(Done.bFound ? &Done.Data : nullptr); }
+}
+
+FString UDFInventorySubsystem::GetLevelKey(const FString& PackageName)
+{ return UWorld::RemovePIEPrefix(PackageName); }
+
+void UDFInventorySubsystem::RecordInventoryLevel(const FString& SaveID, const UInventoryComponent* Inventory)
+{
+	const AActor* Owner = Inventory ? Inventory->GetOwner() : nullptr;
+	const ULevel* Level = Owner ? Owner->GetLevel() : nullptr;
+	if (!Level || SaveID.IsEmpty()) return;
+	
+	bool bAlreadyKnown = false;
+	LevelInventories.FindOrAdd(GetLevelKey(Level->GetPackage()->GetName())).Add(SaveID, &bAlreadyKnown);
+	bLevelInventoriesDirty |= !bAlreadyKnown;
+}
+
+void UDFInventorySubsystem::PrefetchLevel(const FString& PackageName)
+{
+	if (const TSet<FString>* SaveIDs = LevelInventories.Find(GetLevelKey(PackageName)))
+	{ PrefetchForLevel(PackageName, SaveIDs->Array()); }
+}
+
+void UDFInventorySubsystem::PrefetchForLevel(const FString& PackageName, const TArray<FString>& SaveIDs)
+{
+	TMap<FString, uint32>& Started = LevelPrefetches.FindOrAdd(GetLevelKey(PackageName));
+	for (const FString& SaveID : SaveIDs)
+	{
+		if (SaveID.IsEmpty() || Prefetches.Contains(SaveID) || HasUnwrittenData(SaveID)) continue;
+		StartPrefetch(SaveID);
+		Started.Add(SaveID, Prefetches[SaveID].Serial);
+	}
+}
+
+void UDFInventorySubsystem::DropLevelPrefetches(const FString& PackageName)
+{
+	TMap<FString, uint32> Started;
+	if (!LevelPrefetches.RemoveAndCopyValue(GetLevelKey(PackageName), Started)) return;
+	
+	// Reads still running are ignored when they finish. Those an inventory waits on, or started again since, stay.
+	for (const TPair<FString, uint32>& Pair : Started)
+	{
+		const FPrefetch* Prefetch = Prefetches.Find(Pair.Key);
+		if (Prefetch && Prefetch->Serial == Pair.Value && Prefetch->Deferred.IsEmpty()) Prefetches.Remove(Pair.Key);
+	}
+}
+
+void UDFInventorySubsystem::HandlePreLoadMap(const FWorldContext& WorldContext, const FString& MapName)
+{
+	if (WorldContext.OwningGameInstance != GetGameInstance()) return;
+	
+	// Reads nobody claimed belong to the map being left.
+	TArray<FString> Levels;
+	LevelPrefetches.GetKeys(Levels);
+	for (const FString& Level : Levels) DropLevelPrefetches(Level);
+	for (auto It = Prefetches.CreateIterator(); It; ++It)
+	{ if (It->Value.bDone) It.RemoveCurrent(); }
+	
+	SaveLevelManifest();
+	PrefetchLevel(MapName);
+}
+
+void UDFInventorySubsystem::HandleLevelStreamingStateChanged(UWorld* World, const ULevelStreaming* StreamingLevel, ULevel* LevelIfLoaded, ELevelStreamingState PreviousState, ELevelStreamingState NewState)
+{
+	// Clients don't load saves.
+	if (!World || World->GetGameInstance() != GetGameInstance() || World->GetNetMode() == NM_Client || !StreamingLevel) return;
+	
+	const FString PackageName = StreamingLevel->GetWorldAssetPackageName();
+	if (NewState == ELevelStreamingState::Loading)
+	{
+		PrefetchLevel(PackageName);
+	}
+	else if (NewState == ELevelStreamingState::LoadedNotVisible && PreviousState == ELevelStreamingState::Loading && LevelIfLoaded)
+	{
+		// Inventories the manifest doesn't know yet are still read before the level becomes visible.
+		TArray<FString> SaveIDs;
+		for (const AActor* Actor : LevelIfLoaded->Actors)
+		{
+			if (!Actor) continue;
+			TInlineComponentArray<UInventoryComponent*> Components(Actor);
+			for (const UInventoryComponent* Inventory : Components)
+			{ if (Inventory->UsesDiskSaves()) SaveIDs.Add(Inventory->GetSaveID()); }
+		}
+		PrefetchForLevel(PackageName, SaveIDs);
+	}
+	else if (NewState == ELevelStreamingState::LoadedVisible || NewState == ELevelStreamingState::Unloaded
+		|| NewState == ELevelStreamingState::Removed || NewState == ELevelStreamingState::FailedToLoad)
+	{
+		// Its inventories began play by now, or never will: what they didn't take is not needed.
+		DropLevelPrefetches(PackageName);
+	}
+}
+
+FString UDFInventorySubsystem::GetLevelManifestPath()
+{ return FPaths::ProjectSavedDir() / TEXT("SaveGames") / TEXT("InventoryLevels.manifest"); }
+
+void UDFInventorySubsystem::LoadLevelManifest()
+{
+	LevelInventories.Reset();
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *GetLevelManifestPath(), FILEREAD_Silent)) return;
+	
+	FMemoryReader Reader(Bytes);
+	uint32 Magic = 0;
+	uint16 Version = 0;
+	Reader << Magic << Version;
+	if (Magic == LevelManifestMagic && Version <= LevelManifestVersion) Reader << LevelInventories;
+	
+	// Only a hint for prefetching, so a bad file is simply dropped.
+	if (Magic != LevelManifestMagic || Reader.IsError()) LevelInventories.Reset();
+}
+
+void UDFInventorySubsystem::SaveLevelManifest()
+{
+	if (!bLevelInventoriesDirty) return;
+	bLevelInventoriesDirty = false;
+	
+	TArray<uint8> Bytes;
+	FMemoryWriter Writer(Bytes);
+	uint32 Magic = LevelManifestMagic;
+	uint16 Version = LevelManifestVersion;
+	Writer << Magic << Version << LevelInventories;
+	if (!FFileHelper::SaveArrayToFile(Bytes, *GetLevelManifestPath()))
+	{ UE_LOG(LogTemp, Warning, TEXT("[Inventory] Failed to write %s"), *GetLevelManifestPath()); }
+}
@@ -0,0 +1,461 @@
+#include "Subsystem/InventoryJournal.h"
+#include "Settings/InventorySaveGame.h"
+#include "Struct/InventorySaveFormat.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/Event.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/Crc.h"
+#include "Misc/ScopeLock.h"
+#include "Serialization/MemoryWriter.h"
+#include "Serialization/MemoryReader.h"
+
+namespace
+{
+	enum class EJournalOp : uint8
+	{
+		Inventory,
+		SetSlot,
+		ClearSlot,
+	};
+
+	constexpr uint32 SnapshotMagic = 0x4A494644; // "DFIJ"
+	constexpr uint16 SnapshotVersion = 1;
+
+	// Payload size and CRC in front of every log record.
+	constexpr int32 RecordHeaderSize = sizeof(uint32) * 2;
+
+	// Anything larger is a torn or garbage header.
+	constexpr uint32 MaxRecordSize = 64 * 1024 * 1024;
+
+	TSharedRef<const TArray<uint8>> ReadSlotRecord(FArchive& Ar)
+	{
+		TArray<uint8> Bytes;
+		Ar << Bytes;
+		return MakeShared<const TArray<uint8>>(MoveTemp(Bytes));
+	}
+}
+
+FInventoryJournal::FInventoryJournal(const FOptions& InOptions)
+	: Options(InOptions)
+{
+}
+
+FInventoryJournal::~FInventoryJournal()
+{ Close(); }
+
+FString FInventoryJournal::GetSnapshotPath() const
+{ return Options.Directory / Options.Name + TEXT(".snapshot"); }
+
+FString FInventoryJournal::GetLogPath(int32 InGeneration) const
+{ return Options.Directory / FString::Printf(TEXT("%s_%d.log"), *Options.Name, InGeneration); }
+
+TArray<int32> FInventoryJournal::FindLogGenerations() const
+{
+	TArray<FString> Files;
+	IFileManager::Get().FindFiles(Files, *(Options.Directory / Options.Name + TEXT("_*.log")), true, false);
+
+	TArray<int32> Generations;
+	const FString Prefix = Options.Name + TEXT("_");
+	for (const FString& File : Files)
+	{
+		const FString Number = FPaths::GetBaseFilename(File).RightChop(Prefix.Len());
+		if (Number.IsNumeric()) Generations.Add(FCString::Atoi(*Number));
+	}
+	Generations.Sort();
+	return Generations;
+}
+
+bool FInventoryJournal::Open()
+{
+	if (Thread) return true;
+
+	IFileManager::Get().MakeDirectory(*Options.Directory, true);
+
+	int32 SnapshotGeneration = 0;
+	State.Reset();
+	if (IFileManager::Get().FileExists(*GetSnapshotPath()) && !ReadSnapshot(GetSnapshotPath(), State, SnapshotGeneration))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[Inventory] Journal snapshot %s is unreadable"), *GetSnapshotPath());
+		return false;
+	}
+
+	// Logs at or below the snapshot's generation were folded into it but not deleted before a crash.
+	// Replayed logs count towards compaction, or every restart would replay the sessions before it again.
+	NumReplayedRecords = 0;
+	BytesSinceCompaction = 0;
+	Generation = SnapshotGeneration;
+	for (const int32 LogGeneration : FindLogGenerations())
+	{
+		if (LogGeneration > SnapshotGeneration)
+		{
+			ReplayLog(GetLogPath(LogGeneration), State, NumReplayedRecords);
+			BytesSinceCompaction += FMath::Max<int64>(IFileManager::Get().FileSize(*GetLogPath(LogGeneration)), 0);
+		}
+		Generation = FMath::Max(Generation, LogGeneration);
+	}
+
+	// A fresh log, so nothing is ever appended behind a torn record.
+	if (!OpenLog(Generation + 1)) return false;
+
+	bStopping = false;
+	WakeEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	CommittedEvent = FPlatformProcess::GetSynchEventFromPool(false);
+	Thread = FRunnableThread::Create(this, TEXT("InventoryJournal"), 0, TPri_BelowNormal);
+	if (!Thread) return false;
+
+	if (BytesSinceCompaction >= Options.CompactionBytes) Compact();
+	return true;
+}
+
+void FInventoryJournal::Close()
+{
+	if (!Thread) return;
+
+	Stop();
+	Thread->WaitForCompletion();
+	delete Thread;
+	Thread = nullptr;
+	Log.Reset();
+
+	FPlatformProcess::ReturnSynchEventToPool(WakeEvent);
+	FPlatformProcess::ReturnSynchEventToPool(CommittedEvent);
+	WakeEvent = CommittedEvent = nullptr;
+}
+
+void FInventoryJournal::WriteInventory(const FString& SaveID, const FItemSaveData& Data)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter Ar(Payload);
+	EJournalOp Op = EJournalOp::Inventory;
+	FString ID = SaveID;
+	uint32 MaxSlots = FMath::Max(Data.MaxSlots, 0);
+	Ar << Op << ID;
+	Ar.SerializeIntPacked(MaxSlots);
+
+	const bool bSparse = Data.SlotIndexes.Num() == Data.Items.Num();
+	uint32 NumItems = Data.Items.Num();
+	Ar.SerializeIntPacked(NumItems);
+	for (int32 i = 0; i < Data.Items.Num(); ++i)
+	{
+		uint32 Slot = bSparse ? Data.SlotIndexes[i] : i;
+		Ar.SerializeIntPacked(Slot);
+
+		// Length-prefixed so the state can keep the record without decoding it.
+		TArray<uint8> Item;
+		FMemoryWriter ItemAr(Item);
+		InventorySaveFormat::WriteItem(ItemAr, Data.Items[i]);
+		Ar << Item;
+	}
+	Append(Payload);
+}
+
+void FInventoryJournal::WriteSlot(const FString& SaveID, int32 Slot, const FItemStruct* Item)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter Ar(Payload);
+	EJournalOp Op = Item ? EJournalOp::SetSlot : EJournalOp::ClearSlot;
+	FString ID = SaveID;
+	uint32 PackedSlot = Slot;
+	Ar << Op << ID;
+	Ar.SerializeIntPacked(PackedSlot);
+	if (Item)
+	{
+		TArray<uint8> ItemBytes;
+		FMemoryWriter ItemAr(ItemBytes);
+		InventorySaveFormat::WriteItem(ItemAr, *Item);
+		Ar << ItemBytes;
+	}
+	Append(Payload);
+}
+
+bool FInventoryJournal::ReadInventory(const FString& SaveID, FItemSaveData& OutData) const
+{
+	const FEntry* Entry = State.Find(SaveID);
+	if (!Entry) return false;
+
+	TArray<int32> Slots;
+	Entry->Slots.GetKeys(Slots);
+	Slots.Sort();
+
+	FItemSaveData Data;
+	Data.MaxSlots = Entry->MaxSlots;
+	Data.Items.Reserve(Slots.Num());
+	Data.SlotIndexes.Reserve(Slots.Num());
+	for (const int32 Slot : Slots)
+	{
+		FMemoryReader Ar(*Entry->Slots[Slot]);
+		FItemStruct Info;
+		if (!InventorySaveFormat::ReadItem(Ar, Info)) continue;
+		Data.Items.Add(MoveTemp(Info));
+		Data.SlotIndexes.Add(Slot);
+	}
+	OutData = MoveTemp(Data);
+	return true;
+}
+
+void FInventoryJournal::Append(const TArray<uint8>& Payload)
+{
+	ApplyRecord(State, Payload);
+
+	uint32 Size = Payload.Num();
+	uint32 Crc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+	{
+		FScopeLock Lock(&Mutex);
+		Pending.Append(reinterpret_cast<const uint8*>(&Size), sizeof(Size));
+		Pending.Append(reinterpret_cast<const uint8*>(&Crc), sizeof(Crc));
+		Pending.Append(Payload);
+		PendingSerial = ++AppendedSerial;
+	}
+
+	BytesSinceCompaction += RecordHeaderSize + Payload.Num();
+	if (BytesSinceCompaction >= Options.CompactionBytes && !bCompacting) Compact();
+}
+
+void FInventoryJournal::Flush()
+{
+	if (!Thread) return;
+
+	// A compaction requested before counts as well, so callers can time or rely on it.
+	const uint64 Target = AppendedSerial;
+	while (CommittedSerial < Target || bCompacting)
+	{
+		WakeEvent->Trigger();
+		CommittedEvent->Wait(FTimespan::FromMilliseconds(10.0));
+	}
+}
+
+void FInventoryJournal::Compact()
+{
+	if (!Thread || bCompacting.exchange(true)) return;
+
+	// Records appended before this point are in the copy; the writer rotates the log at the same point.
+	// The copy only takes references to the slot records, which later records replace rather than change.
+	TSharedPtr<const FState> Snapshot = MakeShared<FState>(State);
+	BytesSinceCompaction = 0;
+
+	FScopeLock Lock(&Mutex);
+	PendingSnapshot = MoveTemp(Snapshot);
+	PendingSnapshotOffset = Pending.Num();
+	WakeEvent->Trigger();
+}
+
+uint32 FInventoryJournal::Run()
+{
+	while (!bStopping)
+	{
+		// Whatever arrives during the interval goes out with a single write and flush.
+		WakeEvent->Wait(FTimespan::FromSeconds(Options.CommitIntervalSeconds));
+		CommitPending();
+	}
+	CommitPending();
+	return 0;
+}
+
+void FInventoryJournal::Stop()
+{
+	bStopping = true;
+	if (WakeEvent) WakeEvent->Trigger();
+}
+
+void FInventoryJournal::CommitPending()
+{
+	TArray<uint8> Bytes;
+	TSharedPtr<const FState> Snapshot;
+	int64 SnapshotOffset = 0;
+	uint64 Serial = 0;
+	{
+		FScopeLock Lock(&Mutex);
+		Swap(Bytes, Pending);
+		Serial = PendingSerial;
+		Snapshot = MoveTemp(PendingSnapshot);
+		SnapshotOffset = PendingSnapshotOffset;
+	}
+
+	bool bSuccess = WriteToLog(Bytes.GetData(), Snapshot ? SnapshotOffset : Bytes.Num());
+	if (Snapshot)
+	{
+		// The snapshot covers everything up to the log being closed here, so that log and older ones can go.
+		const int32 Folded = Generation;
+		bSuccess &= OpenLog(Generation + 1);
+		if (WriteSnapshot(GetSnapshotPath(), *Snapshot, Folded))
+		{
+			for (const int32 LogGeneration : FindLogGenerations())
+			{ if (LogGeneration <= Folded) IFileManager::Get().Delete(*GetLogPath(LogGeneration)); }
+		}
+		bCompacting = false;
+		bSuccess &= WriteToLog(Bytes.GetData() + SnapshotOffset, Bytes.Num() - SnapshotOffset);
+	}
+
+	if (!bSuccess)
+	{ UE_LOG(LogTemp, Error, TEXT("[Inventory] Journal failed to write %s"), *GetLogPath(Generation)); }
+
+	CommittedSerial = Serial;
+	CommittedEvent->Trigger();
+}
+
+bool FInventoryJournal::WriteToLog(const uint8* Data, int64 Num)
+{
+	if (Num == 0) return true;
+	return Log && Log->Write(Data, Num) && Log->Flush(true);
+}
+
+bool FInventoryJournal::OpenLog(int32 NewGeneration)
+{
+	Log.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*GetLogPath(NewGeneration), true));
+	Generation = NewGeneration;
+	return Log.IsValid();
+}
+
+bool FInventoryJournal::ApplyRecord(FState& InState, TConstArrayView<uint8> Payload)
+{
+	TArray<uint8> Bytes(Payload.GetData(), Payload.Num());
+	FMemoryReader Ar(Bytes);
+	EJournalOp Op;
+	FString SaveID;
+	Ar << Op << SaveID;
+	if (Ar.IsError()) return false;
+
+	FEntry& Entry = InState.FindOrAdd(SaveID);
+	switch (Op)
+	{
+	case EJournalOp::Inventory:
+	{
+		uint32 MaxSlots = 0, NumItems = 0;
+		Ar.SerializeIntPacked(MaxSlots);
+		Ar.SerializeIntPacked(NumItems);
+		Entry.MaxSlots = MaxSlots;
+		Entry.Slots.Reset();
+		for (uint32 i = 0; i < NumItems && !Ar.IsError(); ++i)
+		{
+			uint32 Slot = 0;
+			Ar.SerializeIntPacked(Slot);
+			Entry.Slots.Add(Slot, ReadSlotRecord(Ar));
+		}
+		break;
+	}
+	case EJournalOp::SetSlot:
+	{
+		uint32 Slot = 0;
+		Ar.SerializeIntPacked(Slot);
+		Entry.Slots.Add(Slot, ReadSlotRecord(Ar));
+		break;
+	}
+	case EJournalOp::ClearSlot:
+	{
+		uint32 Slot = 0;
+		Ar.SerializeIntPacked(Slot);
+		Entry.Slots.Remove(Slot);
+		break;
+	}
+	default:
+		return false;
+	}
+	return !Ar.IsError();
+}
+
+bool FInventoryJournal::ReplayLog(const FString& Path, FState& InState, int64& OutNumRecords)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path)) return false;
+
+	int64 Offset = 0;
+	while (Offset + RecordHeaderSize <= Bytes.Num())
+	{
+		uint32 Size = 0, Crc = 0;
+		FMemory::Memcpy(&Size, Bytes.GetData() + Offset, sizeof(Size));
+		FMemory::Memcpy(&Crc, Bytes.GetData() + Offset + sizeof(Size), sizeof(Crc));
+
+		const uint8* Payload = Bytes.GetData() + Offset + RecordHeaderSize;
+		if (Size > MaxRecordSize || Offset + RecordHeaderSize + Size > Bytes.Num() || FCrc::MemCrc32(Payload, Size) != Crc)
+		{
+			// The tail a crash cut off; everything before it is intact.
+			UE_LOG(LogTemp, Warning, TEXT("[Inventory] Journal %s ends in a torn record at %lld"), *Path, Offset);
+			break;
+		}
+
+		if (ApplyRecord(InState, TConstArrayView<uint8>(Payload, Size))) ++OutNumRecords;
+		Offset += RecordHeaderSize + Size;
+	}
+	return true;
+}
+
+bool FInventoryJournal::ReadSnapshot(const FString& Path, FState& OutState, int32& OutGeneration)
+{
+	TArray<uint8> Bytes;
+	if (!FFileHelper::LoadFileToArray(Bytes, *Path)) return false;
+
+	FMemoryReader Ar(Bytes);
+	uint32 Magic = 0, PayloadCrc = 0;
+	uint16 Version = 0;
+	int32 SnapshotGeneration = 0;
+	Ar << Magic << Version << SnapshotGeneration << PayloadCrc;
+	const int64 PayloadOffset = Ar.Tell();
+	if (Ar.IsError() || Magic != SnapshotMagic || Version > SnapshotVersion
+		|| FCrc::MemCrc32(Bytes.GetData() + PayloadOffset, Bytes.Num() - PayloadOffset) != PayloadCrc)
+	{ return false; }
+
+	uint32 NumEntries = 0;
+	Ar.SerializeIntPacked(NumEntries);
+	FState Loaded;
+	Loaded.Reserve(FMath::Min<int64>(NumEntries, Bytes.Num()));
+	for (uint32 i = 0; i < NumEntries && !Ar.IsError(); ++i)
+	{
+		FString SaveID;
+		uint32 MaxSlots = 0, NumSlots = 0;
+		Ar << SaveID;
+		Ar.SerializeIntPacked(MaxSlots);
+		Ar.SerializeIntPacked(NumSlots);
+
+		FEntry& Entry = Loaded.Add(MoveTemp(SaveID));
+		Entry.MaxSlots = MaxSlots;
+		for (uint32 j = 0; j < NumSlots && !Ar.IsError(); ++j)
+		{
+			uint32 Slot = 0;
+			Ar.SerializeIntPacked(Slot);
+			Entry.Slots.Add(Slot, ReadSlotRecord(Ar));
+		}
+	}
+	if (Ar.IsError()) return false;
+
+	OutState = MoveTemp(Loaded);
+	OutGeneration = SnapshotGeneration;
+	return true;
+}
+
+bool FInventoryJournal::WriteSnapshot(const FString& Path, const FState& InState, int32 InGeneration)
+{
+	TArray<uint8> Payload;
+	FMemoryWriter Ar(Payload);
+	uint32 NumEntries = InState.Num();
+	Ar.SerializeIntPacked(NumEntries);
+	for (const TPair<FString, FEntry>& Pair : InState)
+	{
+		FString SaveID = Pair.Key;
+		uint32 MaxSlots = Pair.Value.MaxSlots;
+		uint32 NumSlots = Pair.Value.Slots.Num();
+		Ar << SaveID;
+		Ar.SerializeIntPacked(MaxSlots);
+		Ar.SerializeIntPacked(NumSlots);
+		for (const TPair<int32, TSharedRef<const TArray<uint8>>>& Slot : Pair.Value.Slots)
+		{
+			uint32 Index = Slot.Key;
+			Ar.SerializeIntPacked(Index);
+			Ar << const_cast<TArray<uint8>&>(*Slot.Value);
+		}
+	}
+
+	TArray<uint8> Bytes;
+	FMemoryWriter Header(Bytes);
+	uint32 Magic = SnapshotMagic;
+	uint16 Version = SnapshotVersion;
+	uint32 PayloadCrc = FCrc::MemCrc32(Payload.GetData(), Payload.Num());
+	Header << Magic << Version << InGeneration << PayloadCrc;
+	Bytes.Append(Payload);
+
+	// Written aside and moved over, so a crash leaves either the old or the new snapshot.
+	const FString TempPath = Path + TEXT(".tmp");
+	return FFileHelper::SaveArrayToFile(Bytes, *TempPath) && IFileManager::Get().Move(*Path, *TempPath, true, true);
+}
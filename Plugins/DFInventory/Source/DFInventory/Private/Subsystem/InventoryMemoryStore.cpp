@@ -0,0 +1,295 @@
+#include "Subsystem/InventoryMemoryStore.h"
+#include "Data/ItemData.h"
+#include "Struct/InventorySaveFormat.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "UObject/UnrealType.h"
+
+FInventoryMemoryStore::FInventoryMemoryStore(const FOptions& InOptions)
+	: Options(InOptions)
+{}
+
+FInventoryMemoryStore::~FInventoryMemoryStore()
+{ Empty(); }
+
+int64 FInventoryMemoryStore::EstimateSize(const FItemSaveData& Data)
+{
+	int64 Bytes = sizeof(FEntry) + Data.Items.GetAllocatedSize() + Data.SlotIndexes.GetAllocatedSize();
+	for (const FItemStruct& Info : Data.Items)
+	{
+		Bytes += Info.ItemName.GetAllocatedSize() + Info.Fragments.GetAllocatedSize();
+		if (const UScriptStruct* Extra = Info.ExtraInfo.GetScriptStruct()) Bytes += Extra->GetStructureSize();
+		for (const FInstancedStruct& Fragment : Info.Fragments)
+		{ if (Fragment.GetScriptStruct()) Bytes += Fragment.GetScriptStruct()->GetStructureSize(); }
+	}
+	return Bytes;
+}
+
+bool FInventoryMemoryStore::ReferencesOnlyAssets(const FInstancedStruct& Instance)
+{
+	const UScriptStruct* Struct = Instance.GetScriptStruct();
+	if (!Struct) return true;
+	
+	// Walks nested structs and containers; instanced structs inside are opaque to the iterator and checked the same way.
+	for (TPropertyValueIterator<const FProperty> It(Struct, Instance.GetMemory()); It; ++It)
+	{
+		if (const FObjectPropertyBase* ObjectProperty = CastField<FObjectPropertyBase>(It.Key()))
+		{
+			const UObject* Object = ObjectProperty->GetObjectPropertyValue(It.Value());
+			if (Object && !Object->IsAsset()) return false;
+		}
+		else if (const FStructProperty* StructProperty = CastField<FStructProperty>(It.Key());
+			StructProperty && StructProperty->Struct == FInstancedStruct::StaticStruct())
+		{
+			if (!ReferencesOnlyAssets(*static_cast<const FInstancedStruct*>(It.Value()))) return false;
+		}
+	}
+	return true;
+}
+
+bool FInventoryMemoryStore::CanPack(const FItemSaveData& Data)
+{
+	for (const FItemStruct& Info : Data.Items)
+	{
+		if (Info.ParentItem && !Info.ParentItem->IsAsset()) return false;
+		if (Info.Icon && !Info.Icon->IsAsset()) return false;
+		if (!ReferencesOnlyAssets(Info.ExtraInfo)) return false;
+		for (const FInstancedStruct& Fragment : Info.Fragments)
+		{ if (!ReferencesOnlyAssets(Fragment)) return false; }
+	}
+	return true;
+}
+
+void FInventoryMemoryStore::Store(FName Key, FItemSaveData&& Data)
+{
+	FEntry& Entry = Entries.FindOrAdd(Key);
+	Forget(Entry);
+	Entry.Data = FItemSaveData();
+	Entry.Packed.Reset();
+	if (CanPack(Data)) InventorySaveFormat::Write(Data, Entry.Packed);
+	else Entry.Data = MoveTemp(Data);
+	MakeResident(Key, Entry);
+	EnforceBudget(Key);
+	CompactSpillFile();
+}
+
+bool FInventoryMemoryStore::Retrieve(FName Key, FItemSaveData& OutData)
+{
+	FEntry* Entry = Entries.Find(Key);
+	if (!Entry) return false;
+
+	if (Entry->IsSpilled())
+	{
+		TArray<uint8> Bytes;
+		if (!ReadSpilled(*Entry, Bytes)) return false;
+		Forget(*Entry);
+		Entry->Packed = MoveTemp(Bytes);
+		MakeResident(Key, *Entry);
+		++Stats.NumReloads;
+	}
+	else
+	{
+		// Most recently used goes to the head.
+		Lru.RemoveNode(Entry->Node, false);
+		Lru.AddHead(Entry->Node);
+	}
+
+	if (!Unpack(*Entry, OutData, false)) return false;
+	EnforceBudget(Key);
+	CompactSpillFile();
+	return true;
+}
+
+bool FInventoryMemoryStore::Take(FName Key, FItemSaveData& OutData)
+{
+	FEntry* Entry = Entries.Find(Key);
+	if (!Entry) return false;
+
+	bool bFound = true;
+	if (Entry->IsSpilled())
+	{
+		TArray<uint8> Bytes;
+		bFound = ReadSpilled(*Entry, Bytes) && InventorySaveFormat::Read(Bytes, OutData);
+		if (bFound) ++Stats.NumReloads;
+	}
+	else
+	{ bFound = Unpack(*Entry, OutData, true); }
+
+	// A failed read keeps the entry, so a later attempt can still get the data.
+	if (!bFound) return false;
+	Remove(Key);
+	return true;
+}
+
+void FInventoryMemoryStore::Remove(FName Key)
+{
+	if (FEntry* Entry = Entries.Find(Key))
+	{
+		Forget(*Entry);
+		Entries.Remove(Key);
+		Stats.NumEntries = Entries.Num();
+		CompactSpillFile();
+	}
+}
+
+void FInventoryMemoryStore::Empty()
+{
+	Entries.Empty();
+	Lru.Empty();
+	SpillFile.Reset();
+	if (!Options.SpillPath.IsEmpty()) FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*Options.SpillPath);
+
+	const int32 NumSpills = Stats.NumSpills, NumReloads = Stats.NumReloads;
+	Stats = FStats();
+	Stats.NumSpills = NumSpills;
+	Stats.NumReloads = NumReloads;
+}
+
+void FInventoryMemoryStore::AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer)
+{
+	for (TPair<FName, FEntry>& Pair : Entries)
+	{
+		if (!Pair.Value.IsSpilled() && Pair.Value.Packed.IsEmpty())
+		{ Collector.AddPropertyReferencesWithStructARO(FItemSaveData::StaticStruct(), &Pair.Value.Data, Referencer); }
+	}
+}
+
+bool FInventoryMemoryStore::Unpack(FEntry& Entry, FItemSaveData& OutData, bool bMove)
+{
+	if (!Entry.Packed.IsEmpty()) return InventorySaveFormat::Read(Entry.Packed, OutData);
+	
+	if (bMove) OutData = MoveTemp(Entry.Data);
+	else OutData = Entry.Data;
+	return true;
+}
+
+void FInventoryMemoryStore::MakeResident(FName Key, FEntry& Entry)
+{
+	Entry.Bytes = Entry.Packed.IsEmpty() ? EstimateSize(Entry.Data) : sizeof(FEntry) + Entry.Packed.GetAllocatedSize();
+	Lru.AddHead(Key);
+	Entry.Node = Lru.GetHead();
+	Stats.ResidentBytes += Entry.Bytes;
+	Stats.NumEntries = Entries.Num();
+}
+
+void FInventoryMemoryStore::Forget(FEntry& Entry)
+{
+	if (Entry.Node)
+	{
+		Lru.RemoveNode(Entry.Node);
+		Entry.Node = nullptr;
+		Stats.ResidentBytes -= Entry.Bytes;
+	}
+	if (Entry.IsSpilled())
+	{
+		Stats.SpilledBytes -= Entry.SpillSize;
+		--Stats.NumSpilled;
+		Entry.SpillOffset = INDEX_NONE;
+		Entry.SpillSize = 0;
+	}
+	Entry.Bytes = 0;
+}
+
+void FInventoryMemoryStore::EnforceBudget(FName Keep)
+{
+	if (Options.BudgetBytes <= 0) return;
+
+	FLruList::TDoubleLinkedListNode* Node = Lru.GetTail();
+	while (Node && Stats.ResidentBytes > Options.BudgetBytes)
+	{
+		FLruList::TDoubleLinkedListNode* Prev = Node->GetPrevNode();
+		FEntry& Entry = Entries.FindChecked(Node->GetValue());
+		if (Node->GetValue() != Keep && !Entry.Packed.IsEmpty() && !Spill(Entry)) return;
+		Node = Prev;
+	}
+}
+
+bool FInventoryMemoryStore::Spill(FEntry& Entry)
+{
+	if (!SpillFile)
+	{
+		SpillFile.Reset(FPlatformFileManager::Get().GetPlatformFile().OpenWrite(*Options.SpillPath, false, true));
+		if (!SpillFile)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("[Inventory] Could not open %s, the memory store stays over budget"), *Options.SpillPath);
+			return false;
+		}
+	}
+
+	// Already in the save format, so spilling is a plain write.
+	const int64 Offset = SpillFile->Size();
+	const int32 Size = Entry.Packed.Num();
+	if (!SpillFile->Seek(Offset) || !SpillFile->Write(Entry.Packed.GetData(), Size)) return false;
+
+	Forget(Entry);
+	Entry.Packed.Empty();
+	Entry.SpillOffset = Offset;
+	Entry.SpillSize = Size;
+	Stats.SpilledBytes += Size;
+	Stats.SpillFileBytes = Offset + Size;
+	++Stats.NumSpilled;
+	++Stats.NumSpills;
+	return true;
+}
+
+bool FInventoryMemoryStore::ReadSpilled(const FEntry& Entry, TArray<uint8>& OutBytes)
+{
+	OutBytes.SetNumUninitialized(Entry.SpillSize);
+	return SpillFile && SpillFile->Seek(Entry.SpillOffset) && SpillFile->Read(OutBytes.GetData(), OutBytes.Num());
+}
+
+void FInventoryMemoryStore::CompactSpillFile()
+{
+	if (!SpillFile) return;
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	if (Stats.NumSpilled == 0)
+	{
+		SpillFile.Reset();
+		PlatformFile.DeleteFile(*Options.SpillPath);
+		Stats.SpillFileBytes = 0;
+		return;
+	}
+
+	// Dead space is only reclaimed once it clearly dominates, so removals don't keep rewriting the file.
+	constexpr int64 MinDeadBytes = 1024 * 1024;
+	if (Stats.SpillFileBytes - Stats.SpilledBytes < FMath::Max(MinDeadBytes, 3 * Stats.SpilledBytes)) return;
+
+	const FString TempPath = Options.SpillPath + TEXT(".tmp");
+	TUniquePtr<IFileHandle> NewFile(PlatformFile.OpenWrite(*TempPath, false, true));
+	if (!NewFile) return;
+
+	TArray<uint8> Bytes;
+	TArray<TPair<FEntry*, int64>> Moved;
+	for (TPair<FName, FEntry>& Pair : Entries)
+	{
+		FEntry& Entry = Pair.Value;
+		if (!Entry.IsSpilled()) continue;
+
+		Bytes.SetNumUninitialized(Entry.SpillSize);
+		const int64 NewOffset = NewFile->Tell();
+		if (!SpillFile->Seek(Entry.SpillOffset) || !SpillFile->Read(Bytes.GetData(), Bytes.Num())
+			|| !NewFile->Write(Bytes.GetData(), Bytes.Num()))
+		{
+			NewFile.Reset();
+			PlatformFile.DeleteFile(*TempPath);
+			return;
+		}
+		Moved.Emplace(&Entry, NewOffset);
+	}
+
+	// Offsets only change once the new file is in place; if it can't be moved, the old one stays in use.
+	const int64 NewSize = NewFile->Tell();
+	NewFile.Reset();
+	SpillFile.Reset();
+	if (!IFileManager::Get().Move(*Options.SpillPath, *TempPath, true, true))
+	{
+		PlatformFile.DeleteFile(*TempPath);
+		SpillFile.Reset(PlatformFile.OpenWrite(*Options.SpillPath, true, true));
+		return;
+	}
+	for (const TPair<FEntry*, int64>& Pair : Moved) Pair.Key->SpillOffset = Pair.Value;
+	SpillFile.Reset(PlatformFile.OpenWrite(*Options.SpillPath, true, true));
+	Stats.SpillFileBytes = NewSize;
+}
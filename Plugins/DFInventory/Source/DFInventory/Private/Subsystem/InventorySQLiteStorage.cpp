@@ -0,0 +1,98 @@
+#include "Subsystem/InventorySQLiteStorage.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+
+FInventorySQLiteStorage::FInventorySQLiteStorage(const FString& InPath)
+	: Path(InPath)
+{}
+
+FInventorySQLiteStorage::~FInventorySQLiteStorage()
+{ Close(); }
+
+bool FInventorySQLiteStorage::Execute(FSQLiteDatabase& Database, const TCHAR* Statement)
+{
+	if (Database.Execute(Statement)) return true;
+	UE_LOG(LogTemp, Error, TEXT("[Inventory] %s failed on %s: %s"), Statement, *Path, *Database.GetLastError());
+	return false;
+}
+
+bool FInventorySQLiteStorage::Open()
+{
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(Path), true);
+	if (!Writer.Open(*Path, ESQLiteDatabaseOpenMode::ReadWriteCreate))
+	{
+		UE_LOG(LogTemp, Error, TEXT("[Inventory] Could not open %s: %s"), *Path, *Writer.GetLastError());
+		return false;
+	}
+
+	// WAL lets the reader run beside a commit. NORMAL only syncs at checkpoints, which survives a crash of the process.
+	const bool bReady = Execute(Writer, TEXT("PRAGMA journal_mode=WAL;"))
+		&& Execute(Writer, TEXT("PRAGMA synchronous=NORMAL;"))
+		&& Execute(Writer, TEXT("PRAGMA busy_timeout=1000;"))
+		&& Execute(Writer, TEXT("CREATE TABLE IF NOT EXISTS Inventories (SaveID TEXT PRIMARY KEY NOT NULL, Data BLOB NOT NULL) WITHOUT ROWID;"));
+	if (!bReady || !Reader.Open(*Path, ESQLiteDatabaseOpenMode::ReadOnly) || !Execute(Reader, TEXT("PRAGMA busy_timeout=1000;")))
+	{
+		Close();
+		return false;
+	}
+
+	UpsertStatement = Writer.PrepareStatement(TEXT("INSERT OR REPLACE INTO Inventories (SaveID, Data) VALUES (?1, ?2);"), ESQLitePreparedStatementFlags::Persistent);
+	DeleteStatement = Writer.PrepareStatement(TEXT("DELETE FROM Inventories WHERE SaveID = ?1;"), ESQLitePreparedStatementFlags::Persistent);
+	SelectStatement = Reader.PrepareStatement(TEXT("SELECT Data FROM Inventories WHERE SaveID = ?1;"), ESQLitePreparedStatementFlags::Persistent);
+	if (!UpsertStatement.IsValid() || !DeleteStatement.IsValid() || !SelectStatement.IsValid())
+	{
+		UE_LOG(LogTemp, Error, TEXT("[Inventory] Could not prepare the statements of %s"), *Path);
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void FInventorySQLiteStorage::Close()
+{
+	// Statements must be finalized before their connection closes.
+	UpsertStatement.Destroy();
+	DeleteStatement.Destroy();
+	SelectStatement.Destroy();
+	if (Reader.IsValid()) Reader.Close();
+	if (Writer.IsValid()) Writer.Close();
+}
+
+bool FInventorySQLiteStorage::Write(const TMap<FString, TArray<uint8>>& Batch)
+{
+	if (!Writer.IsValid() || !Execute(Writer, TEXT("BEGIN IMMEDIATE;"))) return false;
+
+	bool bSuccess = true;
+	for (const TPair<FString, TArray<uint8>>& Pair : Batch)
+	{
+		FSQLitePreparedStatement& Statement = Pair.Value.IsEmpty() ? DeleteStatement : UpsertStatement;
+		Statement.Reset();
+		Statement.ClearBindings();
+		bSuccess = Statement.SetBindingValueByIndex(1, Pair.Key);
+		if (bSuccess && !Pair.Value.IsEmpty()) bSuccess = Statement.SetBindingValueByIndex(2, TArrayView<const uint8>(Pair.Value), false);
+		bSuccess = bSuccess && Statement.Step() == ESQLitePreparedStatementStepResult::Done;
+		Statement.Reset();
+		if (!bSuccess)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[Inventory] Writing %s to %s failed: %s"), *Pair.Key, *Path, *Writer.GetLastError());
+			break;
+		}
+	}
+
+	if (bSuccess && Execute(Writer, TEXT("COMMIT;"))) return true;
+	Execute(Writer, TEXT("ROLLBACK;"));
+	return false;
+}
+
+bool FInventorySQLiteStorage::Read(const FString& SaveID, TArray<uint8>& OutBytes)
+{
+	if (!Reader.IsValid()) return false;
+
+	SelectStatement.Reset();
+	SelectStatement.ClearBindings();
+	const bool bFound = SelectStatement.SetBindingValueByIndex(1, SaveID)
+		&& SelectStatement.Step() == ESQLitePreparedStatementStepResult::Row
+		&& SelectStatement.GetColumnValueByIndex(0, OutBytes);
+	SelectStatement.Reset();
+	return bFound;
+}
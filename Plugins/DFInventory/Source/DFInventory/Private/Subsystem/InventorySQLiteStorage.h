@@ -0,0 +1,38 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystem/InventoryStorage.h"
+#include "SQLiteDatabase.h"
+
+/**
+ * Inventories in a local SQLite database, one row per SaveID.
+ * The database runs in WAL mode with separate connections for writing and reading, so point reads never wait for a
+ * batch being committed and see the last committed state.
+ */
+class FInventorySQLiteStorage : public IInventoryStorage
+{
+public:
+	explicit FInventorySQLiteStorage(const FString& InPath);
+	virtual ~FInventorySQLiteStorage() override;
+
+	// IInventoryStorage
+	virtual bool Open() override;
+	virtual void Close() override;
+	virtual bool Write(const TMap<FString, TArray<uint8>>& Batch) override;
+	virtual bool Read(const FString& SaveID, TArray<uint8>& OutBytes) override;
+	virtual FString GetDescription() const override { return Path; }
+
+private:
+	bool Execute(FSQLiteDatabase& Database, const TCHAR* Statement);
+
+	FString Path;
+
+	// Write thread.
+	FSQLiteDatabase Writer;
+	FSQLitePreparedStatement UpsertStatement;
+	FSQLitePreparedStatement DeleteStatement;
+
+	// Read thread.
+	FSQLiteDatabase Reader;
+	FSQLitePreparedStatement SelectStatement;
+};
@@ -0,0 +1,211 @@
+#include "Subsystem/InventorySyncSubsystem.h"
+#include "Component/InventoryComponent.h"
+#include "Settings/DFInventorySettings.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Engine/World.h"
+#include "Net/Core/Misc/NetConditionGroupManager.h"
+#include "Net/Subsystems/NetworkSubsystem.h"
+
+void UInventorySyncSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+	PostLoginHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &UInventorySyncSubsystem::HandlePostLogin);
+	LogoutHandle = FGameModeEvents::GameModeLogoutEvent.AddUObject(this, &UInventorySyncSubsystem::HandleLogout);
+}
+
+void UInventorySyncSubsystem::Deinitialize()
+{
+	FGameModeEvents::GameModePostLoginEvent.Remove(PostLoginHandle);
+	FGameModeEvents::GameModeLogoutEvent.Remove(LogoutHandle);
+	
+	// Controllers kept through seamless travel would bring this world's groups along: the synced group would skip
+	// their sync in the next world, and the per-inventory names could match unrelated inventories there.
+	for (const TPair<TWeakObjectPtr<APlayerController>, FJoiningPlayer>& Pair : JoiningPlayers)
+	{
+		if (!Pair.Key.IsValid()) continue;
+		for (const TWeakObjectPtr<UInventoryComponent>& Inventory : Pair.Value.Granted)
+		{ if (Inventory.IsValid()) Pair.Key->RemoveFromNetConditionGroup(GetInventoryGroup(Inventory.Get())); }
+	}
+	for (const TWeakObjectPtr<APlayerController>& Player : KnownPlayers)
+	{ if (Player.IsValid()) Player->RemoveFromNetConditionGroup(GetSyncedGroup()); }
+	
+	JoiningPlayers.Reset();
+	KnownPlayers.Reset();
+	Inventories.Reset();
+	Super::Deinitialize();
+}
+
+TStatId UInventorySyncSubsystem::GetStatId() const
+{ RETURN_QUICK_DECLARE_CYCLE_STAT(UInventorySyncSubsystem, STATGROUP_Tickables); }
+
+bool UInventorySyncSubsystem::IsBudgetingEnabled(const UWorld* World)
+{
+	return World && World->GetNetMode() != NM_Client && World->GetNetMode() != NM_Standalone
+		&& GetDefault<UDFInventorySettings>()->bBudgetInitialSync;
+}
+
+FName UInventorySyncSubsystem::GetSyncedGroup()
+{ return FName(TEXT("InventorySynced")); }
+
+FName UInventorySyncSubsystem::GetInventoryGroup(const UInventoryComponent* Inventory)
+{ return FName(TEXT("InventorySync"), Inventory ? Inventory->GetUniqueID() : 0); }
+
+void UInventorySyncSubsystem::RegisterInventory(UInventoryComponent* Inventory)
+{
+	UNetworkSubsystem* NetSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UNetworkSubsystem>() : nullptr;
+	if (!Inventory || !NetSubsystem) return;
+
+	FNetConditionGroupManager& Groups = NetSubsystem->GetNetConditionGroupManager();
+	Groups.RegisterSubObjectInGroup(Inventory, GetInventoryGroup(Inventory));
+	Groups.RegisterSubObjectInGroup(Inventory, GetSyncedGroup());
+	Inventories.Add(Inventory);
+}
+
+void UInventorySyncSubsystem::UnregisterInventory(UInventoryComponent* Inventory)
+{
+	if (!Inventory || Inventories.Remove(Inventory) == 0) return;
+
+	const FName Group = GetInventoryGroup(Inventory);
+	for (TPair<TWeakObjectPtr<APlayerController>, FJoiningPlayer>& Pair : JoiningPlayers)
+	{
+		if (Pair.Value.Granted.Remove(Inventory) > 0 && Pair.Key.IsValid())
+		{ Pair.Key->RemoveFromNetConditionGroup(Group); }
+	}
+
+	if (UNetworkSubsystem* NetSubsystem = GetWorld() ? GetWorld()->GetSubsystem<UNetworkSubsystem>() : nullptr)
+	{
+		FNetConditionGroupManager& Groups = NetSubsystem->GetNetConditionGroupManager();
+		Groups.UnregisterSubObjectFromGroup(Inventory, Group);
+		Groups.UnregisterSubObjectFromGroup(Inventory, GetSyncedGroup());
+	}
+}
+
+void UInventorySyncSubsystem::BeginInitialSync(APlayerController* Player)
+{
+	// Local players read the server's state directly.
+	if (!Player || Player->IsLocalController() || !IsBudgetingEnabled(GetWorld())) return;
+
+	// A replay takes back what the previous run granted, so the player only gets what the new run sends.
+	Player->RemoveFromNetConditionGroup(GetSyncedGroup());
+	FJoiningPlayer& State = JoiningPlayers.FindOrAdd(Player);
+	for (const TWeakObjectPtr<UInventoryComponent>& Inventory : State.Granted)
+	{ if (Inventory.IsValid()) Player->RemoveFromNetConditionGroup(GetInventoryGroup(Inventory.Get())); }
+	State = FJoiningPlayer();
+	KnownPlayers.Add(Player);
+	State.StartTime = GetWorld()->GetTimeSeconds();
+}
+
+void UInventorySyncSubsystem::HandlePostLogin(AGameModeBase* GameMode, APlayerController* Player)
+{
+	if (GameMode && GameMode->GetWorld() == GetWorld())
+	{ BeginInitialSync(Player); }
+}
+
+void UInventorySyncSubsystem::HandleLogout(AGameModeBase* GameMode, AController* Exiting)
+{
+	JoiningPlayers.Remove(Cast<APlayerController>(Exiting));
+	KnownPlayers.Remove(Cast<APlayerController>(Exiting));
+}
+
+void UInventorySyncSubsystem::BeginSyncForTravelledPlayers()
+{
+	// Same point HandleStartingNewPlayer is reached for them: once their client loaded this world.
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* Player = It->Get();
+		if (Player && !Player->IsLocalController() && !KnownPlayers.Contains(Player) && Player->HasClientLoadedCurrentWorld())
+		{ BeginInitialSync(Player); }
+	}
+}
+
+int32 UInventorySyncSubsystem::GetPriorityTier(const UInventoryComponent* Inventory, const APlayerController* Player, const FVector& ViewLocation) const
+{
+	const AActor* Owner = Inventory->GetOwner();
+	if (Owner && Owner->GetNetOwner() == Player) return 0;
+	if (Inventory->IsViewer(Player)) return 1;
+
+	const float NearbyDistance = GetDefault<UDFInventorySettings>()->InitialSyncNearbyDistance;
+	if (Owner && FVector::DistSquared(Owner->GetActorLocation(), ViewLocation) <= FMath::Square(NearbyDistance)) return 2;
+	return 3;
+}
+
+void UInventorySyncSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+	if (IsBudgetingEnabled(GetWorld())) BeginSyncForTravelledPlayers();
+	if (JoiningPlayers.IsEmpty()) return;
+
+	const double BytesPerSecond = GetDefault<UDFInventorySettings>()->InitialSyncBytesPerSecond;
+
+	struct FCandidate
+	{
+		int32 Tier;
+		double DistSq;
+		UInventoryComponent* Inventory;
+		bool operator<(const FCandidate& Other) const
+		{ return Tier != Other.Tier ? Tier < Other.Tier : DistSq < Other.DistSq; }
+	};
+	TArray<FCandidate> Candidates;
+
+	for (auto It = JoiningPlayers.CreateIterator(); It; ++It)
+	{
+		APlayerController* Player = It.Key().Get();
+		if (!Player)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		// At most one second of budget is banked, so a stalled player can't burst later.
+		FJoiningPlayer& State = It.Value();
+		State.Tokens = FMath::Min(State.Tokens + BytesPerSecond * DeltaTime, BytesPerSecond);
+
+		FVector ViewLocation;
+		FRotator ViewRotation;
+		Player->GetPlayerViewPoint(ViewLocation, ViewRotation);
+
+		Candidates.Reset();
+		for (const TWeakObjectPtr<UInventoryComponent>& Weak : Inventories)
+		{
+			UInventoryComponent* Inventory = Weak.Get();
+			if (!Inventory || State.Granted.Contains(Weak)) continue;
+
+			const FVector Location = Inventory->GetOwner() ? Inventory->GetOwner()->GetActorLocation() : ViewLocation;
+			Candidates.Add({ GetPriorityTier(Inventory, Player, ViewLocation), FVector::DistSquared(Location, ViewLocation), Inventory });
+		}
+
+		if (Candidates.IsEmpty())
+		{
+			FinishInitialSync(Player, State);
+			It.RemoveCurrent();
+			continue;
+		}
+
+		// Only the few inventories that fit this frame are popped, so there is no need to sort them all.
+		Candidates.Heapify();
+		while (State.Tokens > 0.0 && Candidates.Num() > 0)
+		{
+			FCandidate Next;
+			Candidates.HeapPop(Next, EAllowShrinking::No);
+
+			// A large inventory may overdraw the budget; the next ones wait until it is paid back.
+			const int32 Cost = Next.Inventory->EstimateInitialSyncBytes();
+			State.Tokens -= Cost;
+			State.BytesSent += Cost;
+			State.Granted.Add(Next.Inventory);
+			Player->IncludeInNetConditionGroup(GetInventoryGroup(Next.Inventory));
+		}
+	}
+}
+
+void UInventorySyncSubsystem::FinishInitialSync(APlayerController* Player, FJoiningPlayer& State)
+{
+	// One shared group instead of a group per inventory keeps the per-connection condition checks cheap.
+	Player->IncludeInNetConditionGroup(GetSyncedGroup());
+	for (const TWeakObjectPtr<UInventoryComponent>& Inventory : State.Granted)
+	{ if (Inventory.IsValid()) Player->RemoveFromNetConditionGroup(GetInventoryGroup(Inventory.Get())); }
+
+	UE_LOG(LogTemp, Log, TEXT("[Inventory] Initial sync for %s done after %.2fs (%d inventories, ~%d bytes)"),
+		*Player->GetName(), GetWorld()->GetTimeSeconds() - State.StartTime, State.Granted.Num(), State.BytesSent);
+}
@@ -2,6 +2,9 @@
 #include "Data/ItemData.h"
 #include "Misc/AutomationTest.h"
 #include "UObject/Package.h"
+#include "UObject/EnumProperty.h"
+#include "GameFramework/PlayerController.h"
+#include "Tests/AutomationEditorCommon.h"
 
 // Expose protected members for testing
 class UTestInventory : public UInventoryComponent
@@ -12,6 +15,13 @@ public:
 	using UInventoryComponent::FindEmptySlot;
 	using UInventoryComponent::FindStackableItem;
 	using UInventoryComponent::IsInventoryFull;
+	using UInventoryComponent::ReplicatedSlots;
+	using UInventoryComponent::MaxItemSlots;
+	using UInventoryComponent::bPagedReplication;
+	using UInventoryComponent::ReplicationPageSize;
+	using UInventoryComponent::MaxVisiblePagesPerViewer;
+	using UInventoryComponent::IsSlotStreamed;
+	using UInventoryComponent::SetPlayerVisibleRange;
 };
 
 // --- Helper Functions ---
@@ -309,3 +319,116 @@ bool FInventorySplitTest::RunTest(const FString& Parameters)
 	
 	return true;
 }
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryFragmentTest, "DFInventory.Core.Fragments", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryFragmentTest::RunTest(const FString& Parameters)
+{
+	UTestInventory* Inventory = NewObject<UTestInventory>(GetTransientPackage());
+	Inventory->CreateNewInventory();
+	
+	UItemData* Equipment = CreateTestItem(GetTransientPackage());
+	UItemData* Plain = CreateTestItem(GetTransientPackage());
+	
+	FEquipmentStruct EquipmentFragment;
+	Equipment->SetFragment(FInstancedStruct::Make(EquipmentFragment));
+	
+	TestTrue("Equipment has fragment", Equipment->HasFragment(FEquipmentStruct::StaticStruct()));
+	TestFalse("Plain item has no fragment", Plain->HasFragment(FEquipmentStruct::StaticStruct()));
+	TestNotNull("Typed getter", Equipment->GetFragment<FEquipmentStruct>());
+	
+	// Setting the same type again replaces instead of appending
+	Equipment->SetFragment(FInstancedStruct::Make(EquipmentFragment));
+	TestEqual("One fragment per type", Equipment->GetItemInfo().Fragments.Num(), 1);
+	
+	Inventory->AddItemAtIndex(Plain, 0);
+	Inventory->AddItemAtIndex(Equipment, 2);
+	
+	TArray<int32> Found = Inventory->FindItemsWithFragment(FEquipmentStruct::StaticStruct());
+	if (TestEqual("Only equipment matched", Found.Num(), 1))
+	{
+		TestEqual("Equipment slot", Found[0], 2);
+	}
+	
+	TestTrue("Fragment removed", Equipment->RemoveFragment(FEquipmentStruct::StaticStruct()));
+	TestEqual("No matches after removal", Inventory->FindItemsWithFragment(FEquipmentStruct::StaticStruct()).Num(), 0);
+	
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryReplicationModePropertyTest, "DFInventory.Core.ReplicationModeProperty", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryReplicationModePropertyTest::RunTest(const FString& Parameters)
+{
+	// Set through the property, as the editor and Blueprint defaults do, not through SetReplicationMode.
+	UTestInventory* Inventory = NewObject<UTestInventory>(GetTransientPackage());
+	const FEnumProperty* ModeProperty = FindFProperty<FEnumProperty>(UInventoryComponent::StaticClass(), TEXT("ReplicationMode"));
+	if (!TestNotNull("ReplicationMode property", ModeProperty)) return false;
+	ModeProperty->GetUnderlyingProperty()->SetIntPropertyValue(ModeProperty->ContainerPtrToValuePtr<void>(Inventory),
+		static_cast<int64>(EInventoryReplicationMode::SlotStructs));
+	TestFalse("No item subobjects", Inventory->ReplicatesItemSubobjects());
+
+	Inventory->CreateNewInventory();
+	Inventory->AddItemAtIndex(CreateTestItem(GetTransientPackage(), 3, 10), 1);
+
+	const int32 EntryIndex = Inventory->ReplicatedSlots.FindEntryIndex(1);
+	if (!TestTrue("Slot mirrored", EntryIndex != INDEX_NONE)) return false;
+	const FInventorySlotEntry& Entry = Inventory->ReplicatedSlots.Slots[EntryIndex];
+	TestNull("Entry carries no item pointer", Entry.Item.Get());
+	TestTrue("Entry carries the state", Entry.HasStructState());
+	TestEqual("Amount resolved from the entry", Entry.ResolveInfo().Amount, 3);
+	return true;
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryPagedReplicationTest, "DFInventory.Core.PagedReplication", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryPagedReplicationTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+	if (!TestNotNull("World Created", World)) return false;
+	const APlayerController* PlayerA = World->SpawnActor<APlayerController>();
+	const APlayerController* PlayerB = World->SpawnActor<APlayerController>();
+
+	UTestInventory* Inventory = NewObject<UTestInventory>(GetTransientPackage());
+	Inventory->MaxItemSlots = 30;
+	Inventory->bPagedReplication = true;
+	Inventory->ReplicationPageSize = 10;
+	Inventory->MaxVisiblePagesPerViewer = 2;
+	Inventory->CreateNewInventory();
+	Inventory->AddItemAtIndex(CreateTestItem(GetTransientPackage(), 3, 10), 2);
+	Inventory->AddItemAtIndex(CreateTestItem(GetTransientPackage(), 4, 10), 15);
+	Inventory->AddItemAtIndex(CreateTestItem(GetTransientPackage(), 5, 10), 25);
+
+	// Nobody looks: only the summaries go out.
+	TestEqual("Page count", Inventory->GetReplicationPageCount(), 3);
+	TestEqual("Page 1 occupied", Inventory->GetPageSummary(1).OccupiedSlots, 1);
+	TestEqual("Page 1 amount", Inventory->GetPageSummary(1).TotalAmount, 4);
+	TestEqual("Nothing streamed", Inventory->ReplicatedSlots.Slots.Num(), 0);
+
+	Inventory->SetPlayerVisibleRange(PlayerA, 10, 10);
+	TestTrue("Visible page streams", Inventory->IsSlotStreamed(15));
+	TestFalse("Other pages don't", Inventory->IsSlotStreamed(2));
+	TestTrue("Visible slot mirrored", Inventory->ReplicatedSlots.FindEntryIndex(15) != INDEX_NONE);
+	TestEqual("Only the visible slot", Inventory->ReplicatedSlots.Slots.Num(), 1);
+
+	// Streamed pages are the union of every viewer's range.
+	Inventory->SetPlayerVisibleRange(PlayerB, 20, 5);
+	TestEqual("Both viewers' slots", Inventory->ReplicatedSlots.Slots.Num(), 2);
+
+	// Changes on pages nobody streams only update their summary.
+	Inventory->AddItemAtIndex(CreateTestItem(GetTransientPackage(), 6, 10), 3);
+	TestEqual("Page 0 occupied", Inventory->GetPageSummary(0).OccupiedSlots, 2);
+	TestEqual("Page 0 amount", Inventory->GetPageSummary(0).TotalAmount, 9);
+	TestEqual("Hidden slot not mirrored", Inventory->ReplicatedSlots.FindEntryIndex(3), INDEX_NONE);
+
+	// Closing the UI drops the page unless another viewer still has it.
+	Inventory->SetPlayerVisibleRange(PlayerA, 0, 0);
+	TestFalse("Closed page stops", Inventory->IsSlotStreamed(15));
+	TestEqual("Closed slot dropped", Inventory->ReplicatedSlots.FindEntryIndex(15), INDEX_NONE);
+	TestTrue("Other viewer's slot kept", Inventory->ReplicatedSlots.FindEntryIndex(25) != INDEX_NONE);
+
+	// A range wider than MaxVisiblePagesPerViewer is cut at its start.
+	Inventory->SetPlayerVisibleRange(PlayerA, 0, 30);
+	TestTrue("First page streams", Inventory->IsSlotStreamed(3));
+	TestTrue("Second page streams", Inventory->IsSlotStreamed(15));
+	Inventory->SetPlayerVisibleRange(PlayerB, 0, 0);
+	TestFalse("Third page capped", Inventory->IsSlotStreamed(25));
+	return true;
+}
@@ -2,11 +2,26 @@
 #include "Component/MultiInventory.h"
 #include "Data/ItemData.h"
 #include "Net/UnrealNetwork.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "Engine/Engine.h"
+#include "GameFramework/PlayerController.h"
+#include "UObject/CoreNet.h"
+#include "CoreGlobals.h"
 
 AInventoryMultiplayerTest::AInventoryMultiplayerTest()
 {
 	bReplicates = true;
+	bReplicateUsingRegisteredSubObjectList = true;
 	TimeLimit = 10.0f; 
+	
+	BitsReportDefinition = CreateDefaultSubobject<UItemData>(TEXT("BitsReportDefinition"));
+	FItemStruct DefinitionInfo;
+	DefinitionInfo.ParentItem = BitsReportDefinition;
+	DefinitionInfo.ItemName = FString("Healing Potion");
+	DefinitionInfo.Description = NSLOCTEXT("DFInventoryTests", "PotionDescription", "Restores a small amount of health over a few seconds.");
+	DefinitionInfo.MaxAmount = 20;
+	BitsReportDefinition->SetInfo(DefinitionInfo);
 }
 
 void AInventoryMultiplayerTest::PrepareTest()
@@ -54,10 +69,43 @@ void AInventoryMultiplayerTest::Server_AddItem()
 
 	SourceInventory->AddItemToInventory(NewItem);
 	bItemAdded = true;
+	ReportItemNetBits();
 	
 	LogStep(ELogVerbosity::Log, "Server: Added Item to Source");
 }
 
+void AInventoryMultiplayerTest::ReportItemNetBits()
+{
+	const UNetDriver* Driver = GetWorld()->GetNetDriver();
+	if (!Driver || Driver->ClientConnections.IsEmpty()) return;
+	
+	// Iris replicates FItemStruct member-wise and never calls its NetSerialize.
+	if (Driver->IsUsingIrisReplication())
+	{
+		LogStep(ELogVerbosity::Log, "Bits per item: skipped, Iris replication is active");
+		return;
+	}
+	UPackageMap* Map = Driver->ClientConnections[0]->PackageMap;
+	
+	auto MeasureBits = [Map](FItemStruct Info, bool bCompact)
+	{
+		FNetBitWriter Writer(Map, 0);
+		bool bSuccess = true;
+		if (bCompact) Info.NetSerialize(Writer, Map, bSuccess);
+		else Info.NetSerializeWithoutDefinition(Writer, Map, bSuccess);
+		return Writer.GetNumBits();
+	};
+	
+	FItemStruct Stack = BitsReportDefinition->GetItemInfo();
+	Stack.Amount = 7;
+	
+	FItemStruct Loose;
+	Loose.ItemName = FString("RepItem");
+	
+	LogStep(ELogVerbosity::Log, FString::Printf(TEXT("Bits per item (full vs compact): definition-backed stack %lld vs %lld, item without definition %lld vs %lld"),
+		MeasureBits(Stack, false), MeasureBits(Stack, true), MeasureBits(Loose, false), MeasureBits(Loose, true)));
+}
+
 void AInventoryMultiplayerTest::Server_TransferItem()
 {
 	if (!SourceInventory || !TargetInventory) return;
@@ -126,6 +174,318 @@ void AInventoryMultiplayerTest::Client_VerifyItem()
 	}
 }
 
+AInventoryReplicationModeTest::AInventoryReplicationModeTest()
+{
+	bReplicates = true;
+	bReplicateUsingRegisteredSubObjectList = true;
+	TimeLimit = 60.0f;
+	Modes = { EInventoryReplicationMode::FullArray, EInventoryReplicationMode::SlotDeltas, EInventoryReplicationMode::SlotStructs };
+}
+
+void AInventoryReplicationModeTest::StartTest()
+{
+	Super::StartTest();
+	if (!HasAuthority()) return;
+	
+	if (!GetWorld()->GetNetDriver())
+	{
+		FinishTest(EFunctionalTestResult::Error, "Replication comparison requires a listen server with a connected client");
+		return;
+	}
+	
+	ModeIndex = 0;
+	Results.Reset();
+	BeginMode(Modes[ModeIndex]);
+}
+
+uint64 AInventoryReplicationModeTest::GetTotalBytesSent() const
+{
+	const UNetDriver* Driver = GetWorld()->GetNetDriver();
+	return Driver ? Driver->OutTotalBytes : 0;
+}
+
+void AInventoryReplicationModeTest::BeginMode(EInventoryReplicationMode Mode)
+{
+	const FName CompName = *FString::Printf(TEXT("BenchInv_%s"), *UEnum::GetValueAsString(Mode));
+	BenchInventory = NewObject<UMPInventoryComponent>(this, CompName);
+	BenchInventory->SetReplicationMode(Mode);
+	BenchInventory->SetMaxItemSlots(SlotCount);
+	BenchInventory->RegisterComponent();
+	BenchInventory->SetIsReplicated(true);
+	AddInstanceComponent(BenchInventory);
+	
+	for (int32 i = 0; i < SlotCount; ++i)
+	{
+		UItemData* Item = NewObject<UItemData>(BenchInventory);
+		FItemStruct Info;
+		Info.ItemName = FString::Printf(TEXT("BenchItem_%d"), i);
+		Item->SetInfo(Info);
+		BenchInventory->AddItemAtIndex(Item, i);
+	}
+	
+	UpdatesDone = 0;
+	PhaseTime = 0.0f;
+	Phase = EPhase::Warmup;
+}
+
+void AInventoryReplicationModeTest::ChangeOneSlot()
+{
+	const int32 Index = UpdatesDone % SlotCount;
+	BenchInventory->RemoveItemFromInventory(Index);
+	
+	UItemData* Item = NewObject<UItemData>(BenchInventory);
+	FItemStruct Info;
+	Info.ItemName = FString::Printf(TEXT("BenchItem_%d_%d"), Index, UpdatesDone);
+	Item->SetInfo(Info);
+	BenchInventory->AddItemAtIndex(Item, Index);
+}
+
+void AInventoryReplicationModeTest::EndMode()
+{
+	const uint64 BytesSent = GetTotalBytesSent() - StartBytes;
+	const double AvgFrameMs = FrameCount > 0 ? FrameMsSum / FrameCount : 0.0;
+	
+	const UNetDriver* Driver = GetWorld()->GetNetDriver();
+	const FString Line = FString::Printf(TEXT("%s (%s): %llu bytes for %d single-slot updates (%.1f bytes/update), avg server game thread %.3f ms"),
+		*UEnum::GetValueAsString(BenchInventory->GetReplicationMode()),
+		Driver && Driver->IsUsingIrisReplication() ? TEXT("Iris") : TEXT("Generic"), BytesSent, UpdatesDone,
+		UpdatesDone > 0 ? static_cast<double>(BytesSent) / UpdatesDone : 0.0, AvgFrameMs);
+	Results.Add(Line);
+	LogStep(ELogVerbosity::Log, Line);
+	
+	BenchInventory->DestroyComponent();
+	BenchInventory = nullptr;
+	Phase = EPhase::Idle;
+	
+	if (Modes.IsValidIndex(++ModeIndex))
+	{
+		BeginMode(Modes[ModeIndex]);
+		return;
+	}
+	FinishTest(EFunctionalTestResult::Succeeded, FString::Join(Results, TEXT(" | ")));
+}
+
+void AInventoryReplicationModeTest::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	if (!HasAuthority() || !BenchInventory) return;
+	
+	PhaseTime += DeltaSeconds;
+	switch (Phase)
+	{
+	case EPhase::Warmup:
+		if (PhaseTime < SettleSeconds) break;
+		StartBytes = GetTotalBytesSent();
+		FrameMsSum = 0.0;
+		FrameCount = 0;
+		Phase = EPhase::Updating;
+		break;
+		
+	case EPhase::Updating:
+		FrameMsSum += FPlatformTime::ToMilliseconds(GGameThreadTime);
+		++FrameCount;
+		ChangeOneSlot();
+		if (++UpdatesDone >= UpdatesPerMode)
+		{
+			PhaseTime = 0.0f;
+			Phase = EPhase::Settling;
+		}
+		break;
+		
+	case EPhase::Settling:
+		FrameMsSum += FPlatformTime::ToMilliseconds(GGameThreadTime);
+		++FrameCount;
+		if (PhaseTime >= SettleSeconds) EndMode();
+		break;
+		
+	default:
+		break;
+	}
+}
+
+AInventoryPredictionLatencyTest::AInventoryPredictionLatencyTest()
+{
+	bReplicates = true;
+	bReplicateUsingRegisteredSubObjectList = true;
+	TimeLimit = 15.0f;
+}
+
+void AInventoryPredictionLatencyTest::PrepareTest()
+{
+	Super::PrepareTest();
+	if (!HasAuthority()) return;
+	
+	// Clients can only send server RPCs through actors they own.
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		APlayerController* PC = It->Get();
+		if (PC && !PC->IsLocalController())
+		{
+			SetOwner(PC);
+			break;
+		}
+	}
+	
+	PredictInventory = NewObject<UMPInventoryComponent>(this, TEXT("PredictInv"));
+	PredictInventory->SetMaxItemSlots(4);
+	PredictInventory->RegisterComponent();
+	PredictInventory->SetIsReplicated(true);
+	AddInstanceComponent(PredictInventory);
+	
+	UItemData* Item = NewObject<UItemData>(PredictInventory);
+	FItemStruct Info;
+	Info.ItemName = FString("PredictedItem");
+	Item->SetInfo(Info);
+	PredictInventory->AddItemAtIndex(Item, 0);
+}
+
+void AInventoryPredictionLatencyTest::StartTest()
+{
+	Super::StartTest();
+	if (HasAuthority() && !GetOwner())
+	{ FinishTest(EFunctionalTestResult::Error, "Prediction test requires a listen server with a connected client"); }
+}
+
+void AInventoryPredictionLatencyTest::SetPacketLag(int32 LagMs)
+{
+	if (GEngine)
+	{ GEngine->Exec(GetWorld(), *FString::Printf(TEXT("Net PktLag=%d"), LagMs)); }
+}
+
+void AInventoryPredictionLatencyTest::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	if (!HasAuthority()) Client_Tick();
+}
+
+void AInventoryPredictionLatencyTest::Client_Tick()
+{
+	TArray<UMPInventoryComponent*> Comps;
+	GetComponents(Comps);
+	UMPInventoryComponent* ClientInventory = nullptr;
+	for (UMPInventoryComponent* Comp : Comps)
+	{ if (Comp->GetName().Contains("PredictInv")) ClientInventory = Comp; }
+	if (!ClientInventory) return;
+	
+	const TArray<UItemData*> Items = ClientInventory->GetInventoryItems();
+	switch (Step)
+	{
+	case EStep::WaitForReplication:
+	{
+		if (!Items.IsValidIndex(1) || !Items[0]) break;
+		
+		SetPacketLag(SimulatedLagMs);
+		const double Start = FPlatformTime::Seconds();
+		const bool bRequested = ClientInventory->RequestSwapItemSlots(0, 1);
+		LocalApplyMs = (FPlatformTime::Seconds() - Start) * 1000.0;
+		
+		const TArray<UItemData*> Predicted = ClientInventory->GetInventoryItems();
+		if (!bRequested || Predicted[0] || !Predicted[1])
+		{
+			FinishTest(EFunctionalTestResult::Failed, "Client: move was not applied locally");
+			Step = EStep::Done;
+			break;
+		}
+		Step = EStep::WaitForConfirm;
+		break;
+	}
+	
+	case EStep::WaitForConfirm:
+		if (ClientInventory->HasPendingPredictions()) break;
+		
+		if (Items[0] || !Items[1] || Items[1]->GetItemInfo().ItemName != FString("PredictedItem"))
+		{
+			FinishTest(EFunctionalTestResult::Failed, "Client: server state does not match the prediction");
+			Step = EStep::Done;
+			break;
+		}
+		SingleRoundTripMs = ClientInventory->GetLastPredictionRoundTripMs();
+		
+		// Two moves in one gesture: one RPC, one acknowledgement.
+		{
+			TArray<FInventoryCommand> Commands;
+			FInventoryCommand& First = Commands.AddDefaulted_GetRef();
+			First.SourceIndex = 1;
+			First.TargetIndex = 2;
+			FInventoryCommand& Second = Commands.AddDefaulted_GetRef();
+			Second.SourceIndex = 2;
+			Second.TargetIndex = 3;
+			
+			if (ClientInventory->RequestCommands(Commands) != 2)
+			{
+				FinishTest(EFunctionalTestResult::Failed, "Client: batch was not applied locally");
+				Step = EStep::Done;
+				break;
+			}
+		}
+		Step = EStep::WaitForBatch;
+		break;
+		
+	case EStep::WaitForBatch:
+		if (ClientInventory->HasPendingPredictions()) break;
+		
+		Step = EStep::Done;
+		if (Items[1] || Items[2] || !Items[3])
+		{
+			FinishTest(EFunctionalTestResult::Failed, "Client: server state does not match the predicted batch");
+			break;
+		}
+		FinishTest(EFunctionalTestResult::Succeeded, FString::Printf(
+			TEXT("Client: move shown after %.3f ms, confirmed after %.1f ms, batch of 2 confirmed after %.1f ms with %d ms simulated lag"),
+			LocalApplyMs, SingleRoundTripMs, ClientInventory->GetLastPredictionRoundTripMs(), SimulatedLagMs));
+		break;
+		
+	default:
+		break;
+	}
+}
+
+void AInventoryPredictionLatencyTest::CleanUp()
+{
+	if (!HasAuthority()) SetPacketLag(0);
+	Super::CleanUp();
+}
+
+// Slot struct capture round trip, no network involved
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySlotStructTest, "DFInventory.Multiplayer.SlotStructs", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventorySlotStructTest::RunTest(const FString& Parameters)
+{
+	UItemData* Definition = NewObject<UItemData>(GetTransientPackage());
+	FItemStruct DefinitionInfo;
+	DefinitionInfo.ParentItem = Definition;
+	DefinitionInfo.ItemName = FString("Potion");
+	DefinitionInfo.MaxAmount = 20;
+	Definition->SetInfo(DefinitionInfo);
+	
+	UItemData* Instance = NewObject<UItemData>(GetTransientPackage());
+	FItemStruct InstanceInfo = DefinitionInfo;
+	InstanceInfo.Amount = 7;
+	Instance->SetInfo(InstanceInfo);
+	
+	FInventorySlotEntry Entry;
+	TestTrue("First capture changes state", Entry.CaptureState(Instance));
+	TestFalse("Unmodified instance sends no payload", Entry.Payload.IsValid());
+	TestFalse("Recapture without changes is clean", Entry.CaptureState(Instance));
+	
+	FItemStruct Resolved = Entry.ResolveInfo();
+	TestEqual("Name from definition", Resolved.ItemName, FString("Potion"));
+	TestEqual("Max from definition", Resolved.MaxAmount, 20);
+	TestEqual("Amount replicated", Resolved.Amount, 7);
+	
+	// Items without a definition fall back to the full info
+	UItemData* Loose = NewObject<UItemData>(GetTransientPackage());
+	FItemStruct LooseInfo;
+	LooseInfo.ItemName = FString("Loose");
+	Loose->SetInfo(LooseInfo);
+	
+	FInventorySlotEntry LooseEntry;
+	LooseEntry.CaptureState(Loose);
+	TestTrue("Full payload without definition", LooseEntry.Payload.GetPtr<FItemStruct>() != nullptr);
+	TestEqual("Loose name resolved", LooseEntry.ResolveInfo().ItemName, FString("Loose"));
+	
+	return true;
+}
+
 // Static Config Test
 IMPLEMENT_SIMPLE_AUTOMATION_TEST(FMultiplayerConfigTest, "DFInventory.Multiplayer.Config", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
 bool FMultiplayerConfigTest::RunTest(const FString& Parameters)
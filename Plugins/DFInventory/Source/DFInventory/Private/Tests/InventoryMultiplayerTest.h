@@ -2,9 +2,11 @@
 
 #include "CoreMinimal.h"
 #include "FunctionalTest.h"
+#include "Component/InventoryComponent.h"
 #include "InventoryMultiplayerTest.generated.h"
 
 class UMPInventoryComponent;
+class UItemData;
 
 /**
  * Functional Test to verify Inventory Replication.
@@ -37,8 +39,103 @@ private:
 	void Server_TransferItem();
 	
 	void Client_VerifyItem();
+
+	// Logs serialized bits per item for the compact and the full (no definition) wire format.
+	void ReportItemNetBits();
+	
+	// Stable-named stand-in for an item data asset, so the compact format can use it as a baseline.
+	UPROPERTY()
+	TObjectPtr<UItemData> BitsReportDefinition;
 	
 	bool bItemAdded = false;
 	bool bTransferTriggered = false;
 	float TimeWaited = 0.0f;
 };
+
+/**
+ * Functional Test comparing replication modes.
+ * Runs the same sequence of single-slot updates on a large inventory per mode and logs bytes sent and server frame time.
+ * Requires a listen server with at least one connected client.
+ */
+UCLASS()
+class DFINVENTORY_API AInventoryReplicationModeTest : public AFunctionalTest
+{
+	GENERATED_BODY()
+
+public:
+	AInventoryReplicationModeTest();
+
+protected:
+	virtual void StartTest() override;
+	virtual void Tick(float DeltaSeconds) override;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 1))
+	int32 SlotCount = 200;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 1))
+	int32 UpdatesPerMode = 60;
+
+	// Time given to initial replication before measuring, and to the last updates after.
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float SettleSeconds = 1.0f;
+
+private:
+	enum class EPhase : uint8 { Idle, Warmup, Updating, Settling };
+
+	UPROPERTY()
+	TObjectPtr<UMPInventoryComponent> BenchInventory;
+
+	void BeginMode(EInventoryReplicationMode Mode);
+	void EndMode();
+	void ChangeOneSlot();
+	uint64 GetTotalBytesSent() const;
+
+	TArray<EInventoryReplicationMode> Modes;
+	TArray<FString> Results;
+	int32 ModeIndex = 0;
+	int32 UpdatesDone = 0;
+	EPhase Phase = EPhase::Idle;
+	float PhaseTime = 0.0f;
+	uint64 StartBytes = 0;
+	double FrameMsSum = 0.0;
+	int32 FrameCount = 0;
+};
+
+/**
+ * Functional Test for client-predicted drag and drop.
+ * Hands the test actor to the first remote client, adds simulated packet lag there and checks that a requested
+ * move shows up locally in the same frame, then waits for the server to confirm it. Finishes with a two-command
+ * batch that must come back with a single acknowledgement.
+ * Requires a listen server with at least one connected client.
+ */
+UCLASS()
+class DFINVENTORY_API AInventoryPredictionLatencyTest : public AFunctionalTest
+{
+	GENERATED_BODY()
+
+public:
+	AInventoryPredictionLatencyTest();
+
+protected:
+	virtual void PrepareTest() override;
+	virtual void StartTest() override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void CleanUp() override;
+
+	// Outgoing lag added on the client, in milliseconds.
+	UPROPERTY(EditAnywhere, Category = "Prediction")
+	int32 SimulatedLagMs = 150;
+
+private:
+	enum class EStep : uint8 { WaitForReplication, WaitForConfirm, WaitForBatch, Done };
+
+	UPROPERTY()
+	TObjectPtr<UMPInventoryComponent> PredictInventory;
+
+	void Client_Tick();
+	void SetPacketLag(int32 LagMs);
+
+	EStep Step = EStep::WaitForReplication;
+	double LocalApplyMs = 0.0;
+	float SingleRoundTripMs = 0.0f;
+};
@@ -3,10 +3,73 @@
 #include "Subsystem/DFInventorySubsystem.h"
 #include "Data/ItemData.h"
 #include "Settings/InventorySaveGame.h"
+#include "Struct/InventorySaveFormat.h"
+#include "Subsystem/InventoryJournal.h"
+#include "Subsystem/InventoryMemoryStore.h"
+#include "Subsystem/InventorySQLiteStorage.h"
+#include "Settings/DFInventorySettings.h"
+#include "HAL/FileManager.h"
+#include "Misc/ScopeExit.h"
+#include "Misc/Paths.h"
+#include "Math/RandomStream.h"
 #include "Engine/GameInstance.h"
 #include "Engine/World.h"
 #include "Kismet/GameplayStatics.h"
 #include "Tests/AutomationEditorCommon.h"
+#include "ProfilingDebugging/ScopedTimers.h"
+#include "Async/TaskGraphInterfaces.h"
+
+namespace
+{
+	// A new map with an initialized game instance, which creates the subsystem. Callers shut the game instance down.
+	UGameInstance* StartTestGameInstance(UWorld*& OutWorld)
+	{
+		OutWorld = FAutomationEditorCommonUtils::CreateNewMap();
+		if (!OutWorld) return nullptr;
+		UGameInstance* GI = NewObject<UGameInstance>(GEngine);
+		OutWorld->SetGameInstance(GI);
+		GI->Init();
+		return GI;
+	}
+
+	// An inventory on its own actor, its first NumItems slots holding distinct stacks.
+	UInventoryComponent* SpawnTestInventory(UWorld* World, const FString& SaveID, int32 MaxSlots, int32 NumItems = 0)
+	{
+		AActor* Host = World->SpawnActor<AActor>();
+		UInventoryComponent* Inventory = NewObject<UInventoryComponent>(Host);
+		Inventory->RegisterComponent();
+		Inventory->SetSaveID(SaveID);
+		Inventory->SetMaxItemSlots(MaxSlots);
+		for (int32 Slot = 0; Slot < NumItems; ++Slot)
+		{
+			UItemData* Item = NewObject<UItemData>(Inventory);
+			FItemStruct Info;
+			Info.ItemName = FString::Printf(TEXT("Test item %d"), Slot);
+			Info.MaxAmount = 100;
+			Info.Amount = Slot % 99 + 1;
+			Item->SetInfo(Info);
+			Inventory->AddItemAtIndex(Item, Slot);
+		}
+		return Inventory;
+	}
+
+	// Save data with NumItems stacks of Amount, from FirstSlot on.
+	FItemSaveData MakeTestSaveData(int32 NumItems, int32 Amount, int32 FirstSlot = 0)
+	{
+		FItemSaveData Data;
+		Data.MaxSlots = FirstSlot + NumItems;
+		for (int32 Slot = FirstSlot; Slot < Data.MaxSlots; ++Slot)
+		{
+			FItemStruct Info;
+			Info.ItemName = FString::Printf(TEXT("Test item %d"), Slot);
+			Info.MaxAmount = 100;
+			Info.Amount = Amount;
+			Data.Items.Add(Info);
+			Data.SlotIndexes.Add(Slot);
+		}
+		return Data;
+	}
+}
 
 // Subsystem Test - Disable due to creating GameInstance/World in automation instability. Covered by Integration Test below.
 /*
@@ -74,16 +137,9 @@ bool FInventoryMemorySaveTest::RunTest(const FString& Parameters)
 	// Create Component
 	AActor* Host = World->SpawnActor<AActor>();
 	
-	// Set Manual SaveID using local subclass to expose protected 'SaveID'
-	class UTestPersistenceInventory : public UInventoryComponent
-	{
-		public:
-			void SetTestSaveID(FString NewID) { SaveID = NewID; }
-	};
-	
-	UTestPersistenceInventory* TestInv = NewObject<UTestPersistenceInventory>(Host);
+	UInventoryComponent* TestInv = NewObject<UInventoryComponent>(Host);
 	TestInv->RegisterComponent();
-	TestInv->SetTestSaveID("AutoTest_Memory_Inv");
+	TestInv->SetSaveID("AutoTest_Memory_Inv");
 	TestInv->SetMaxItemSlots(5);
 	
 	// Add Item
@@ -125,3 +181,932 @@ bool FInventoryMemorySaveTest::RunTest(const FString& Parameters)
 	
 	return true;
 }
+
+// Component Disk Save (background write, coalesced)
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryAsyncDiskSaveTest, "DFInventory.Persistence.AsyncDisk", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryAsyncDiskSaveTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = nullptr;
+	UGameInstance* GI = StartTestGameInstance(World);
+	if (!TestNotNull("World Created", GI)) return false;
+	ON_SCOPE_EXIT { GI->Shutdown(); };
+
+	UDFInventorySubsystem* Subsystem = GI->GetSubsystem<UDFInventorySubsystem>();
+	if (!TestNotNull("Subsystem Exists via GI", Subsystem)) return false;
+
+	const FString SlotName = TEXT("AutoTest_AsyncDisk_Inv");
+	UInventoryComponent* TestInv = SpawnTestInventory(World, SlotName, 5);
+
+	UItemData* Item = NewObject<UItemData>(TestInv);
+	FItemStruct Info;
+	Info.ItemName = FString("DiskItem");
+	Info.MaxAmount = 10;
+	Info.Amount = 1;
+	Item->SetInfo(Info);
+	TestInv->AddItemAtIndex(Item, 2);
+
+	// Three saves in a row: one write in flight, the later two coalesce into one more.
+	for (int32 Amount = 1; Amount <= 3; ++Amount)
+	{
+		Item->SetItemAmount(Amount);
+		TestTrue("Save queued", TestInv->SaveInventory(ESaveType::Disk));
+	}
+	TestTrue("Write pending", Subsystem->HasPendingSaves());
+
+	// Loads see the newest snapshot even before it reached the disk.
+	TestInv->CreateNewInventory();
+	if (TestTrue("Pending save loaded", TestInv->LoadInventory(ESaveType::Disk)))
+	{
+		UItemData* Pending = TestInv->GetInventoryItems()[2];
+		TestTrue("Slot kept", Pending != nullptr);
+		if (Pending) TestEqual("Newest amount", Pending->GetItemInfo().Amount, 3);
+	}
+
+	Subsystem->FlushPendingSaves();
+	TestFalse("Nothing pending after flush", Subsystem->HasPendingSaves());
+	TestTrue("Slot written", UGameplayStatics::DoesSaveGameExist(SlotName, 0));
+
+	TestInv->CreateNewInventory();
+	if (TestTrue("Disk save loaded", TestInv->LoadInventory(ESaveType::Disk)))
+	{
+		UItemData* Loaded = TestInv->GetInventoryItems()[2];
+		TestTrue("Slot restored", Loaded != nullptr);
+		if (Loaded)
+		{
+			TestEqual("Restored name", Loaded->GetItemInfo().ItemName, FString("DiskItem"));
+			TestEqual("Restored amount", Loaded->GetItemInfo().Amount, 3);
+		}
+	}
+
+	UGameplayStatics::DeleteGameInSlot(SlotName, 0);
+	return true;
+}
+
+// Dirty tracking: only changed inventories are saved
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryDirtySaveTest, "DFInventory.Persistence.DirtyTracking", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryDirtySaveTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = nullptr;
+	UGameInstance* GI = StartTestGameInstance(World);
+	if (!TestNotNull("World Created", GI)) return false;
+	ON_SCOPE_EXIT { GI->Shutdown(); };
+
+	UDFInventorySubsystem* Subsystem = GI->GetSubsystem<UDFInventorySubsystem>();
+	if (!TestNotNull("Subsystem Exists via GI", Subsystem)) return false;
+
+	constexpr int32 NumInventories = 200;
+	constexpr int32 NumModified = 10;
+	constexpr int32 NumItems = 40;
+
+	TArray<UInventoryComponent*> Inventories;
+	for (int32 i = 0; i < NumInventories; ++i)
+	{
+		UInventoryComponent* Inventory = SpawnTestInventory(World, FString::Printf(TEXT("AutoTest_Dirty_%d"), i), NumItems, NumItems);
+		Subsystem->RegisterInventory(Inventory);
+		Inventories.Add(Inventory);
+	}
+
+	double FullSeconds = 0.0, NoneSeconds = 0.0, PartialSeconds = 0.0;
+	int32 NumSaved = 0;
+	{
+		FSimpleScopeSecondsCounter Timer(FullSeconds);
+		NumSaved = Subsystem->SaveAllDirtyInventories(ESaveType::Memory);
+	}
+	TestEqual("First pass saves everything", NumSaved, NumInventories);
+
+	{
+		FSimpleScopeSecondsCounter Timer(NoneSeconds);
+		NumSaved = Subsystem->SaveAllDirtyInventories(ESaveType::Memory);
+	}
+	TestEqual("Unchanged inventories skipped", NumSaved, 0);
+
+	// In-place item changes count as well as slot changes.
+	for (int32 i = 0; i < NumModified; ++i)
+	{ Inventories[i * (NumInventories / NumModified)]->GetInventoryItems()[0]->SetItemAmount(5); }
+	{
+		FSimpleScopeSecondsCounter Timer(PartialSeconds);
+		NumSaved = Subsystem->SaveAllDirtyInventories(ESaveType::Memory);
+	}
+	TestEqual("Only modified inventories saved", NumSaved, NumModified);
+
+	// Items keep the outer they were created with; the inventory holding them still sees their changes.
+	UItemData* Picked = NewObject<UItemData>(GetTransientPackage());
+	FItemStruct PickedInfo;
+	PickedInfo.MaxAmount = 10;
+	Picked->SetInfo(PickedInfo);
+	Inventories[1]->RemoveItemFromInventory(0);
+	Inventories[1]->AddItemAtIndex(Picked, 0);
+	Subsystem->SaveAllDirtyInventories(ESaveType::Memory);
+	Picked->SetItemAmount(7);
+	TestTrue("Change to an item outered elsewhere marks its inventory dirty", Inventories[1]->IsSaveDirty(ESaveType::Memory));
+
+	// Disk saves stay dirty until their write finished.
+	UInventoryComponent* DiskInventory = Inventories[0];
+	TestTrue("Disk dirty before saving", DiskInventory->IsSaveDirty(ESaveType::Disk));
+	TestTrue("Disk save queued", DiskInventory->SaveInventory(ESaveType::Disk));
+	TestFalse("Write in flight not saved again", DiskInventory->IsSaveDirty(ESaveType::Disk));
+	Subsystem->FlushPendingSaves();
+	TestFalse("Disk clean after write", DiskInventory->IsSaveDirty(ESaveType::Disk));
+	DiskInventory->GetInventoryItems()[1]->SetItemAmount(3);
+	TestTrue("Disk dirty after change", DiskInventory->IsSaveDirty(ESaveType::Disk));
+	UGameplayStatics::DeleteGameInSlot(DiskInventory->GetSaveID(), 0);
+
+	AddInfo(FString::Printf(TEXT("%d inventories: full %.3f ms, none changed %.3f ms, %d changed %.3f ms"),
+		NumInventories, FullSeconds * 1000.0, NoneSeconds * 1000.0, NumModified, PartialSeconds * 1000.0));
+
+	Subsystem->ClearAllStoredInventoryData();
+	return true;
+}
+
+// World save file: one indexed file, entries read on demand
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryWorldFileTest, "DFInventory.Persistence.WorldFile", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryWorldFileTest::RunTest(const FString& Parameters)
+{
+	UDFInventorySettings* Settings = GetMutableDefault<UDFInventorySettings>();
+	const bool bPreviousWorldFile = Settings->bUseWorldSaveFile;
+	const FString PreviousName = Settings->WorldSaveName;
+	Settings->bUseWorldSaveFile = true;
+	Settings->WorldSaveName = TEXT("AutoTest_WorldFile");
+	ON_SCOPE_EXIT
+	{
+		IFileManager::Get().Delete(*UDFInventorySubsystem::GetWorldSavePath());
+		UGameplayStatics::DeleteGameInSlot(TEXT("AutoTest_Chest_Legacy"), 0);
+		Settings->bUseWorldSaveFile = bPreviousWorldFile;
+		Settings->WorldSaveName = PreviousName;
+	};
+	IFileManager::Get().Delete(*UDFInventorySubsystem::GetWorldSavePath());
+
+	constexpr int32 NumChests = 50;
+	UWorld* World = nullptr;
+	UGameInstance* GI = StartTestGameInstance(World);
+	if (!TestNotNull("World Created", GI)) return false;
+	ON_SCOPE_EXIT { if (GI) GI->Shutdown(); };
+	UDFInventorySubsystem* Subsystem = GI->GetSubsystem<UDFInventorySubsystem>();
+	if (!TestNotNull("Subsystem Exists", Subsystem)) return false;
+
+	// Saved to its own slot before the project switched to the world file.
+	Settings->bUseWorldSaveFile = false;
+	Subsystem->SaveInventoryDataAsync(TEXT("AutoTest_Chest_Legacy"), MakeTestSaveData(1, 42, 1));
+	Subsystem->FlushPendingSaves();
+	Settings->bUseWorldSaveFile = true;
+
+	for (int32 i = 0; i < NumChests; ++i)
+	{ Subsystem->SaveInventoryDataAsync(FString::Printf(TEXT("AutoTest_Chest_%d"), i), MakeTestSaveData(1, i + 1, 1)); }
+	Subsystem->FlushPendingSaves();
+	TestTrue("World file written", IFileManager::Get().FileExists(*UDFInventorySubsystem::GetWorldSavePath()));
+	TestFalse("No slot per inventory", UGameplayStatics::DoesSaveGameExist(TEXT("AutoTest_Chest_0"), 0));
+
+	// Rewriting one entry keeps the others.
+	Subsystem->SaveInventoryDataAsync(TEXT("AutoTest_Chest_7"), MakeTestSaveData(1, 99, 1));
+	Subsystem->FlushPendingSaves();
+	GI->Shutdown();
+
+	// A new session only reads the index up front.
+	GI = StartTestGameInstance(World);
+	if (!TestNotNull("World Recreated", GI)) return false;
+	Subsystem = GI->GetSubsystem<UDFInventorySubsystem>();
+	TestTrue("Index read", Subsystem->HasWorldSaveEntry(TEXT("AutoTest_Chest_0")));
+	TestFalse("Unknown ID", Subsystem->HasWorldSaveEntry(TEXT("AutoTest_Chest_Missing")));
+
+	FItemSaveData Loaded;
+	if (TestTrue("Entry loaded", UDFInventorySubsystem::LoadInventoryDataFromDisk(Subsystem, TEXT("AutoTest_Chest_3"), Loaded))
+		&& TestEqual("Item count", Loaded.Items.Num(), 1))
+	{
+		TestEqual("Amount", Loaded.Items[0].Amount, 4);
+		TestEqual("Slot", Loaded.SlotIndexes[0], 1);
+	}
+	if (TestTrue("Rewritten entry loaded", UDFInventorySubsystem::LoadInventoryDataFromDisk(Subsystem, TEXT("AutoTest_Chest_7"), Loaded)))
+	{ TestEqual("Newest amount", Loaded.Items[0].Amount, 99); }
+	TestFalse("Missing entry", UDFInventorySubsystem::LoadInventoryDataFromDisk(Subsystem, TEXT("AutoTest_Chest_Missing"), Loaded));
+	if (TestTrue("Slot saved before the world file loaded", UDFInventorySubsystem::LoadInventoryDataFromDisk(Subsystem, TEXT("AutoTest_Chest_Legacy"), Loaded)))
+	{ TestEqual("Slot amount", Loaded.Items[0].Amount, 42); }
+	return true;
+}
+
+// Prefetch: saves read in the background, BeginPlay loads never wait on the disk
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryPrefetchTest, "DFInventory.Persistence.Prefetch", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryPrefetchTest::RunTest(const FString& Parameters)
+{
+	const FString PrefetchedID = TEXT("AutoTest_Prefetch_Ready");
+	const FString DeferredID = TEXT("AutoTest_Prefetch_Deferred");
+	const FString MissingID = TEXT("AutoTest_Prefetch_Missing");
+	ON_SCOPE_EXIT
+	{
+		UGameplayStatics::DeleteGameInSlot(PrefetchedID, 0);
+		UGameplayStatics::DeleteGameInSlot(DeferredID, 0);
+	};
+
+	UWorld* World = nullptr;
+	UGameInstance* GI = StartTestGameInstance(World);
+	if (!TestNotNull("World Created", GI)) return false;
+	ON_SCOPE_EXIT { GI->Shutdown(); };
+
+	UDFInventorySubsystem* Subsystem = GI->GetSubsystem<UDFInventorySubsystem>();
+	if (!TestNotNull("Subsystem Exists via GI", Subsystem)) return false;
+
+	Subsystem->SaveInventoryDataAsync(PrefetchedID, MakeTestSaveData(1, 7, 2));
+	Subsystem->SaveInventoryDataAsync(DeferredID, MakeTestSaveData(1, 11, 2));
+	Subsystem->FlushPendingSaves();
+
+	// Results are handed to the game thread, so it has to keep pumping while waiting.
+	auto WaitFor = [](TFunctionRef<bool()> Done)
+	{
+		const double Deadline = FPlatformTime::Seconds() + 10.0;
+		while (!Done() && FPlatformTime::Seconds() < Deadline)
+		{
+			FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+			FPlatformProcess::Sleep(0.001f);
+		}
+		return Done();
+	};
+
+	Subsystem->PrefetchInventoryData({ PrefetchedID, MissingID });
+	TestTrue("Prefetches finished", WaitFor([&]() { return !Subsystem->IsPrefetchPending(PrefetchedID) && !Subsystem->IsPrefetchPending(MissingID); }));
+
+	FItemSaveData Loaded;
+	if (TestTrue("Prefetched data ready", Subsystem->LoadInventoryDataDeferred(PrefetchedID, Loaded, nullptr) == EInventoryDiskLoad::Loaded)
+		&& TestEqual("Item count", Loaded.Items.Num(), 1))
+	{ TestEqual("Amount", Loaded.Items[0].Amount, 7); }
+	TestTrue("Missing save reported", Subsystem->LoadInventoryDataDeferred(MissingID, Loaded, nullptr) == EInventoryDiskLoad::Missing);
+
+	// Not prefetched: the inventory starts with its defaults and gets the save once it was read.
+	UInventoryComponent* Inventory = SpawnTestInventory(World, DeferredID, 3);
+	Inventory->CreateNewInventory();
+	TestFalse("Not applied right away", Inventory->LoadInventoryDeferred());
+	TestTrue("Load pending", Inventory->IsLoadPending());
+	TestFalse("Defaults not saved over the pending load", Inventory->SaveInventory(ESaveType::Disk, true));
+
+	TestTrue("Deferred load finished", WaitFor([&]() { return !Inventory->IsLoadPending(); }));
+	UItemData* Item = Inventory->GetInventoryItems().IsValidIndex(2) ? Inventory->GetInventoryItems()[2] : nullptr;
+	if (TestNotNull("Deferred data applied", Item))
+	{ TestEqual("Deferred amount", Item->GetItemInfo().Amount, 11); }
+	TestFalse("Loaded state is clean", Inventory->IsSaveDirty(ESaveType::Disk));
+	return true;
+}
+
+// Memory store: bounded resident size, least recently used entries spill to disk and come back intact
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryMemoryStoreTest, "DFInventory.Persistence.MemoryStoreBudget", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryMemoryStoreTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumInventories = 500;
+	constexpr int32 NumItems = 40;
+
+	FInventoryMemoryStore::FOptions Options;
+	Options.SpillPath = FPaths::ProjectSavedDir() / TEXT("Temp") / TEXT("AutoTest_MemoryStore.spill");
+	Options.BudgetBytes = 256 * 1024;
+
+	auto MakeData = [](int32 Index) { return MakeTestSaveData(NumItems, Index % 100 + 1); };
+	auto KeyOf = [](int32 Index) { return FName(TEXT("AutoTest_Stored"), Index + 1); };
+
+	double StoreSeconds = 0.0;
+	{
+		FInventoryMemoryStore Store(Options);
+		{
+			FSimpleScopeSecondsCounter Timer(StoreSeconds);
+			for (int32 i = 0; i < NumInventories; ++i) Store.Store(KeyOf(i), MakeData(i));
+		}
+
+		const FInventoryMemoryStore::FStats& Stats = Store.GetStats();
+		const int64 EntryBytes = FInventoryMemoryStore::EstimateSize(MakeData(0));
+		TestEqual("Every inventory kept", Stats.NumEntries, NumInventories);
+		TestTrue("Resident memory within budget", Stats.ResidentBytes <= Options.BudgetBytes + EntryBytes);
+		TestTrue("Older inventories spilled", Stats.NumSpilled > 0);
+		TestTrue("Spill file written", IFileManager::Get().FileSize(*Options.SpillPath) >= Stats.SpilledBytes);
+
+		// The first stored was the first spilled; copying it out brings it back.
+		FItemSaveData Loaded;
+		if (TestTrue("Spilled entry retrieved", Store.Retrieve(KeyOf(0), Loaded)) && TestEqual("Item count", Loaded.Items.Num(), NumItems))
+		{ TestEqual("Spilled amount", Loaded.Items[5].Amount, 1); }
+		TestTrue("Retrieve keeps it", Store.Contains(KeyOf(0)));
+
+		if (TestTrue("Spilled entry taken", Store.Take(KeyOf(1), Loaded)))
+		{ TestEqual("Taken amount", Loaded.Items[0].Amount, 2); }
+		TestFalse("Take removes it", Store.Contains(KeyOf(1)));
+
+		const int32 NumReloads = Stats.NumReloads;
+		for (int32 i = 2; i < NumInventories; ++i) Store.Take(KeyOf(i), Loaded);
+		TestTrue("Spilled entries read back", Stats.NumReloads > NumReloads);
+		Store.Remove(KeyOf(0));
+		TestEqual("Store empty", Stats.NumEntries, 0);
+		TestEqual("No resident bytes left", Stats.ResidentBytes, int64(0));
+		TestFalse("Spill file removed with its last entry", IFileManager::Get().FileExists(*Options.SpillPath));
+
+		AddInfo(FString::Printf(TEXT("%d inventories stored in %.2f ms (~%lld bytes each), %d spills, %d reloads"),
+			NumInventories, StoreSeconds * 1000.0, EntryBytes, Stats.NumSpills, Stats.NumReloads));
+	}
+	return true;
+}
+
+// Bulk save: snapshots on the game thread, parallel serialization, bounded writes; compared with saving one by one
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryBulkSaveBenchmark, "DFInventory.Persistence.BulkSaveBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+bool FInventoryBulkSaveBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumInventories = 300;
+	constexpr int32 NumItems = 60;
+	ON_SCOPE_EXIT
+	{
+		for (int32 i = 0; i < NumInventories; ++i)
+		{
+			UGameplayStatics::DeleteGameInSlot(FString::Printf(TEXT("AutoTest_Bulk_%d"), i), 0);
+			UGameplayStatics::DeleteGameInSlot(FString::Printf(TEXT("AutoTest_Sequential_%d"), i), 0);
+		}
+	};
+
+	UWorld* World = nullptr;
+	UGameInstance* GI = StartTestGameInstance(World);
+	if (!TestNotNull("World Created", GI)) return false;
+	ON_SCOPE_EXIT { GI->Shutdown(); };
+
+	UDFInventorySubsystem* Subsystem = GI->GetSubsystem<UDFInventorySubsystem>();
+	if (!TestNotNull("Subsystem Exists via GI", Subsystem)) return false;
+
+	TArray<UInventoryComponent*> Inventories;
+	for (int32 i = 0; i < NumInventories; ++i)
+	{
+		UInventoryComponent* Inventory = SpawnTestInventory(World, FString::Printf(TEXT("AutoTest_Bulk_%d"), i), NumItems, NumItems);
+		Subsystem->RegisterInventory(Inventory);
+		Inventories.Add(Inventory);
+	}
+
+	// Baseline: what saving them one after another on the game thread costs.
+	double SequentialSeconds = 0.0;
+	{
+		FSimpleScopeSecondsCounter Timer(SequentialSeconds);
+		TArray<uint8> Bytes;
+		for (int32 i = 0; i < NumInventories; ++i)
+		{
+			Bytes.Reset();
+			InventorySaveFormat::Write(Inventories[i]->CreateSaveData(), Bytes);
+			UGameplayStatics::SaveDataToSlot(Bytes, FString::Printf(TEXT("AutoTest_Sequential_%d"), i), 0);
+		}
+	}
+
+	int32 NumReports = 0;
+	Subsystem->OnBulkSaveFinished.AddLambda([&NumReports](const FInventoryBulkSaveStats&) { ++NumReports; });
+
+	double CallSeconds = 0.0;
+	int32 NumSaved = 0;
+	{
+		FSimpleScopeSecondsCounter Timer(CallSeconds);
+		NumSaved = Subsystem->SaveAllDirtyInventories(ESaveType::Disk);
+	}
+	TestEqual("Every inventory saved", NumSaved, NumInventories);
+	TestTrue("Pass still running after the call", Subsystem->IsBulkSaveRunning() || NumReports == 1);
+	Subsystem->FlushPendingSaves();
+
+	const FInventoryBulkSaveStats& Stats = Subsystem->GetLastBulkSaveStats();
+	TestEqual("Reported once", NumReports, 1);
+	TestEqual("Report covers the pass", Stats.NumInventories, NumInventories);
+	TestEqual("No failed writes", Stats.NumFailed, 0);
+	TestTrue("Bytes counted", Stats.Bytes > 0);
+	TestFalse("Nothing dirty afterwards", Inventories.Last()->IsSaveDirty(ESaveType::Disk));
+
+	FItemSaveData Loaded;
+	if (TestTrue("Bulk save loads", UDFInventorySubsystem::LoadInventoryDataFromDisk(Subsystem, TEXT("AutoTest_Bulk_17"), Loaded)))
+	{ TestEqual("Loaded items", Loaded.Items.Num(), NumItems); }
+
+	AddInfo(FString::Printf(TEXT("%d inventories x %d items: sequential %.1f ms on the game thread; bulk call %.1f ms (snapshot %.1f ms), wall %.1f ms, %.3f ms per inventory on workers (serialize %.1f ms, write %.1f ms summed), %lld bytes"),
+		NumInventories, NumItems, SequentialSeconds * 1000.0, CallSeconds * 1000.0, Stats.SnapshotSeconds * 1000.0, Stats.WallSeconds * 1000.0,
+		Stats.GetAverageCostMs(), Stats.SerializeSeconds * 1000.0, Stats.WriteSeconds * 1000.0, Stats.Bytes));
+	return true;
+}
+
+// Autosave scheduler: snapshots spread over frames under a budget, oldest changes first
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryAutoSaveSchedulerTest, "DFInventory.Persistence.AutoSaveScheduler", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryAutoSaveSchedulerTest::RunTest(const FString& Parameters)
+{
+	UDFInventorySettings* Settings = GetMutableDefault<UDFInventorySettings>();
+	const int32 PreviousBudget = Settings->AutoSaveFrameBudget;
+	const float PreviousInterval = Settings->AutoSaveInterval;
+	Settings->AutoSaveInterval = 0.0f;
+	constexpr int32 NumInventories = 100;
+	ON_SCOPE_EXIT
+	{
+		Settings->AutoSaveFrameBudget = PreviousBudget;
+		Settings->AutoSaveInterval = PreviousInterval;
+		for (int32 i = 0; i < NumInventories; ++i) UGameplayStatics::DeleteGameInSlot(FString::Printf(TEXT("AutoTest_AutoSave_%d"), i), 0);
+	};
+
+	// Shutting down flushes the writes still pending, before the slots are deleted.
+	UWorld* World = nullptr;
+	UGameInstance* GI = StartTestGameInstance(World);
+	if (!TestNotNull("World Created", GI)) return false;
+	ON_SCOPE_EXIT { GI->Shutdown(); };
+
+	UDFInventorySubsystem* Subsystem = GI->GetSubsystem<UDFInventorySubsystem>();
+	if (!TestNotNull("Subsystem Exists via GI", Subsystem)) return false;
+
+	// Registered newest first, so registration order can't be mistaken for priority.
+	TArray<UInventoryComponent*> Inventories;
+	for (int32 i = 0; i < NumInventories; ++i) Inventories.Add(SpawnTestInventory(World, FString::Printf(TEXT("AutoTest_AutoSave_%d"), i), 20));
+	for (int32 i = NumInventories - 1; i >= 0; --i) Subsystem->RegisterInventory(Inventories[i]);
+
+	// Changed in index order, a little apart.
+	for (UInventoryComponent* Inventory : Inventories)
+	{
+		FPlatformProcess::Sleep(0.0001f);
+		UItemData* Item = NewObject<UItemData>(Inventory);
+		FItemStruct Info;
+		Info.ItemName = TEXT("Autosaved item");
+		Item->SetInfo(Info);
+		Inventory->AddItemAtIndex(Item, 0);
+	}
+	TestTrue("Dirty since recorded", Inventories[0]->GetDiskDirtySince() > 0.0 && Inventories[0]->GetDiskDirtySince() <= Inventories[1]->GetDiskDirtySince());
+
+	// The smallest budget saves exactly one inventory per frame, which shows the order.
+	Settings->AutoSaveFrameBudget = 1;
+	Subsystem->StartAutoSavePass();
+	TestEqual("Every changed inventory queued", Subsystem->GetAutoSaveStats().NumPending, NumInventories);
+	Subsystem->TickAutoSave(0.016f);
+	TestFalse("Oldest change saved first", Inventories[0]->IsSaveDirty(ESaveType::Disk));
+	TestTrue("Newest change still waiting", Inventories.Last()->IsSaveDirty(ESaveType::Disk));
+	TestEqual("One per frame at the smallest budget", Subsystem->GetAutoSaveStats().NumPending, NumInventories - 1);
+
+	// A realistic budget finishes the rest over a few frames.
+	Settings->AutoSaveFrameBudget = 200;
+	Subsystem->ResetAutoSaveStats();
+	int32 NumFrames = 0;
+	while (Subsystem->GetAutoSaveStats().NumPending > 0 && NumFrames < NumInventories)
+	{
+		Subsystem->TickAutoSave(0.016f);
+		++NumFrames;
+	}
+	const FInventoryAutoSaveStats& Stats = Subsystem->GetAutoSaveStats();
+	TestEqual("Pass finished", Stats.NumPending, 0);
+	TestEqual("Every inventory saved once", Stats.NumSaved, NumInventories);
+	TestTrue("Frame cost measured", Stats.MaxFrameMicroseconds > 0.0);
+	for (UInventoryComponent* Inventory : Inventories)
+	{ TestFalse("Nothing left dirty", Inventory->IsSaveDirty(ESaveType::Disk)); }
+
+	// Unchanged inventories don't start a pass.
+	Subsystem->StartAutoSavePass();
+	TestEqual("Clean inventories not queued", Subsystem->GetAutoSaveStats().NumPending, 0);
+
+	AddInfo(FString::Printf(TEXT("%d inventories autosaved over %d frames at a 200 us budget, at most %.0f us in a frame"),
+		NumInventories - 1, NumFrames, Stats.MaxFrameMicroseconds));
+	return true;
+}
+
+// Database storage: read-your-writes through the subsystem, and throughput against a slot per SaveID
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryStorageBenchmark, "DFInventory.Persistence.StorageBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+bool FInventoryStorageBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumInventories = 1000;
+	constexpr int32 NumItems = 40;
+	constexpr int32 BatchSize = 100;
+
+	const FString Directory = FPaths::AutomationTransientDir() / TEXT("InventoryStorage");
+	IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	ON_SCOPE_EXIT
+	{
+		for (int32 i = 0; i < NumInventories; ++i) UGameplayStatics::DeleteGameInSlot(FString::Printf(TEXT("AutoTest_Storage_%d"), i), 0);
+		IFileManager::Get().DeleteDirectory(*Directory, false, true);
+	};
+
+	const FItemSaveData Data = MakeTestSaveData(NumItems, 7);
+
+	// Through the subsystem: reads see queued and committed writes, removals included.
+	{
+		UGameInstance* GI = NewObject<UGameInstance>(GEngine);
+		GI->Init();
+		ON_SCOPE_EXIT { GI->Shutdown(); };
+		UDFInventorySubsystem* Subsystem = GI->GetSubsystem<UDFInventorySubsystem>();
+		if (!TestNotNull("Subsystem Exists via GI", Subsystem)) return false;
+
+		Subsystem->SetStorage(MakeUnique<FInventorySQLiteStorage>(Directory / TEXT("Subsystem.db")));
+		if (!TestNotNull("Storage opened", Subsystem->GetStorage())) return false;
+
+		FItemSaveData Loaded;
+		TestTrue("Queued write written", Subsystem->WriteToStorage(TEXT("Chest"), Data));
+		TestTrue("Queued write readable", Subsystem->ReadFromStorage(TEXT("Chest"), Loaded) && Loaded.Items.Num() == NumItems);
+		Subsystem->FlushStorage();
+		TArray<uint8> Bytes;
+		TestTrue("Committed to the database", Subsystem->GetStorage()->Read(TEXT("Chest"), Bytes));
+		Loaded = FItemSaveData();
+		TestTrue("Committed write readable", Subsystem->ReadFromStorage(TEXT("Chest"), Loaded) && Loaded.Items.Num() == NumItems);
+		TestEqual("Amount survives", Loaded.Items.Last().Amount, 7);
+
+		Subsystem->RemoveFromStorage(TEXT("Chest"));
+		TestFalse("Queued removal hides the row", Subsystem->ReadFromStorage(TEXT("Chest"), Loaded));
+		Subsystem->FlushStorage();
+		TestFalse("Removal committed", Subsystem->GetStorage()->Read(TEXT("Chest"), Bytes));
+		TestFalse("Unknown SaveID", Subsystem->ReadFromStorage(TEXT("Missing"), Loaded));
+	}
+
+	// Current path: a USaveGame slot file per inventory.
+	UInventorySaveGame* SaveGame = NewObject<UInventorySaveGame>();
+	SaveGame->SaveData = Data;
+	double SlotWriteSeconds = 0.0, SlotReadSeconds = 0.0;
+	{
+		FSimpleScopeSecondsCounter Timer(SlotWriteSeconds);
+		for (int32 i = 0; i < NumInventories; ++i) UGameplayStatics::SaveGameToSlot(SaveGame, FString::Printf(TEXT("AutoTest_Storage_%d"), i), 0);
+	}
+	int32 NumSlotReads = 0;
+	{
+		FSimpleScopeSecondsCounter Timer(SlotReadSeconds);
+		for (int32 i = 0; i < NumInventories; ++i)
+		{
+			const UInventorySaveGame* Loaded = Cast<UInventorySaveGame>(UGameplayStatics::LoadGameFromSlot(FString::Printf(TEXT("AutoTest_Storage_%d"), i), 0));
+			NumSlotReads += Loaded && Loaded->SaveData.Items.Num() == NumItems;
+		}
+	}
+	TestEqual("Every slot read back", NumSlotReads, NumInventories);
+
+	// Database: encoding included, committed BatchSize inventories per transaction.
+	FInventorySQLiteStorage Storage(Directory / TEXT("Benchmark.db"));
+	if (!TestTrue("Benchmark database opened", Storage.Open())) return false;
+	double DbWriteSeconds = 0.0, DbReadSeconds = 0.0;
+	bool bWritten = true;
+	{
+		FSimpleScopeSecondsCounter Timer(DbWriteSeconds);
+		TMap<FString, TArray<uint8>> Batch;
+		for (int32 i = 0; i < NumInventories; ++i)
+		{
+			InventorySaveFormat::Write(Data, Batch.Add(FString::Printf(TEXT("Inventory_%d"), i)));
+			if (Batch.Num() == BatchSize || i == NumInventories - 1)
+			{
+				bWritten &= Storage.Write(Batch);
+				Batch.Reset();
+			}
+		}
+	}
+	TestTrue("Every batch committed", bWritten);
+	int32 NumDbReads = 0;
+	{
+		FSimpleScopeSecondsCounter Timer(DbReadSeconds);
+		TArray<uint8> Bytes;
+		for (int32 i = 0; i < NumInventories; ++i)
+		{
+			FItemSaveData Loaded;
+			NumDbReads += Storage.Read(FString::Printf(TEXT("Inventory_%d"), i), Bytes) && InventorySaveFormat::Read(Bytes, Loaded) && Loaded.Items.Num() == NumItems;
+		}
+	}
+	TestEqual("Every row read back", NumDbReads, NumInventories);
+	Storage.Close();
+
+	AddInfo(FString::Printf(TEXT("SaveGameToSlot: write %.0f inventories/s, read %.0f inventories/s"),
+		NumInventories / FMath::Max(SlotWriteSeconds, UE_DOUBLE_SMALL_NUMBER), NumInventories / FMath::Max(SlotReadSeconds, UE_DOUBLE_SMALL_NUMBER)));
+	AddInfo(FString::Printf(TEXT("SQLite (%d per transaction): write %.0f inventories/s, read %.0f inventories/s"), BatchSize,
+		NumInventories / FMath::Max(DbWriteSeconds, UE_DOUBLE_SMALL_NUMBER), NumInventories / FMath::Max(DbReadSeconds, UE_DOUBLE_SMALL_NUMBER)));
+	return true;
+}
+
+// Item kinds: repeated stacks share one table entry in saves and in the memory store
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryItemKindsTest, "DFInventory.Persistence.ItemKinds", EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+bool FInventoryItemKindsTest::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumSlots = 500;
+	constexpr int32 NumKinds = 7;
+
+	// A few kinds of runtime items (no definition, every field stored) over a full container; every tenth has its own ExtraInfo.
+	auto MakeData = [](int32 KindsUsed)
+	{
+		FItemSaveData Data;
+		Data.MaxSlots = NumSlots;
+		for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+		{
+			const int32 Kind = Slot % KindsUsed;
+			FItemStruct Info;
+			Info.ItemName = FString::Printf(TEXT("Crafting Material %d"), Kind);
+			Info.Description = FText::FromString(FString::Printf(TEXT("Used in recipes of tier %d. Stacks up to 99."), Kind));
+			Info.MaxAmount = 99;
+			Info.Amount = 1 + (Slot * 37) % 99;
+			if (Slot % 10 == 0) Info.ExtraInfo = FInstancedStruct::Make(FEquipmentStruct());
+			Data.Items.Add(Info);
+			Data.SlotIndexes.Add(Slot);
+		}
+		return Data;
+	};
+
+	const FItemSaveData Shared = MakeData(NumKinds);
+	const FItemSaveData Distinct = MakeData(NumSlots);
+	TArray<uint8> SharedBytes, DistinctBytes;
+	InventorySaveFormat::Write(Shared, SharedBytes);
+	InventorySaveFormat::Write(Distinct, DistinctBytes);
+	TestTrue("Repeated kinds stored once", SharedBytes.Num() * 4 < DistinctBytes.Num());
+
+	FItemSaveData Loaded;
+	if (TestTrue("Read back", InventorySaveFormat::Read(SharedBytes, Loaded)) && TestEqual("Item count", Loaded.Items.Num(), NumSlots))
+	{
+		for (int32 i = 0; i < NumSlots; ++i)
+		{
+			const FItemStruct& Expected = Shared.Items[i];
+			const FItemStruct& Actual = Loaded.Items[i];
+			if (Loaded.SlotIndexes[i] != i || Actual.Amount != Expected.Amount || Actual.ItemName != Expected.ItemName
+				|| Actual.MaxAmount != Expected.MaxAmount || !Actual.Description.EqualTo(Expected.Description)
+				|| Actual.ExtraInfo.GetScriptStruct() != Expected.ExtraInfo.GetScriptStruct())
+			{
+				AddError(FString::Printf(TEXT("Slot %d did not survive the round trip"), i));
+				break;
+			}
+		}
+	}
+
+	// The memory store keeps the same packed form resident.
+	FInventoryMemoryStore::FOptions Options;
+	Options.SpillPath = FPaths::ProjectSavedDir() / TEXT("Temp") / TEXT("AutoTest_ItemKinds.spill");
+	Options.BudgetBytes = 0;
+	FInventoryMemoryStore Store(Options);
+	Store.Store(TEXT("AutoTest_Kinds"), CopyTemp(Shared));
+	const int64 UnpackedBytes = FInventoryMemoryStore::EstimateSize(Shared);
+	const int64 PackedBytes = Store.GetStats().ResidentBytes;
+	TestTrue("Stored packed", PackedBytes * 4 < UnpackedBytes);
+	Loaded = FItemSaveData();
+	TestTrue("Taken back", Store.Take(TEXT("AutoTest_Kinds"), Loaded) && Loaded.Items.Num() == NumSlots && Loaded.Items.Last().Amount == Shared.Items.Last().Amount);
+
+	AddInfo(FString::Printf(TEXT("%d slots of %d kinds: %d bytes, of %d kinds: %d bytes; in memory %lld bytes packed vs ~%lld unpacked"),
+		NumSlots, NumKinds, SharedBytes.Num(), NumSlots, DistinctBytes.Num(), PackedBytes, UnpackedBytes));
+	return true;
+}
+
+// Binary format vs USaveGame: round trip, size and save/load time
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventorySaveFormatBenchmark, "DFInventory.Persistence.SaveFormatBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+bool FInventorySaveFormatBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumSlots = 1000;
+	constexpr int32 Iterations = 20;
+
+	UItemData* Definition = NewObject<UItemData>(GetTransientPackage());
+	FItemStruct DefinitionInfo;
+	DefinitionInfo.ItemName = FString("BenchItem");
+	DefinitionInfo.Description = FText::FromString(TEXT("Benchmark item"));
+	DefinitionInfo.MaxAmount = 99;
+	DefinitionInfo.ParentItem = Definition;
+	Definition->SetInfo(DefinitionInfo);
+
+	// Two thirds of the slots occupied, a few with their own name, like a well used container.
+	FItemSaveData Data;
+	Data.MaxSlots = NumSlots;
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+	{
+		if (Slot % 3 == 2) continue;
+		FItemStruct Info = DefinitionInfo;
+		Info.Amount = 1 + Slot % 99;
+		if (Slot % 10 == 0) Info.ItemName = FString::Printf(TEXT("Renamed %d"), Slot);
+		Data.Items.Add(Info);
+		Data.SlotIndexes.Add(Slot);
+	}
+
+	UInventorySaveGame* SaveGame = NewObject<UInventorySaveGame>();
+	SaveGame->SaveData = Data;
+
+	TArray<uint8> LegacyBytes;
+	double LegacySaveSeconds = 0.0, LegacyLoadSeconds = 0.0;
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		LegacyBytes.Reset();
+		{
+			FSimpleScopeSecondsCounter Timer(LegacySaveSeconds);
+			UGameplayStatics::SaveGameToMemory(SaveGame, LegacyBytes);
+		}
+		FSimpleScopeSecondsCounter Timer(LegacyLoadSeconds);
+		UGameplayStatics::LoadGameFromMemory(LegacyBytes);
+	}
+
+	TArray<uint8> BinaryBytes;
+	FItemSaveData Loaded;
+	bool bRead = true;
+	double BinarySaveSeconds = 0.0, BinaryLoadSeconds = 0.0;
+	for (int32 i = 0; i < Iterations; ++i)
+	{
+		BinaryBytes.Reset();
+		{
+			FSimpleScopeSecondsCounter Timer(BinarySaveSeconds);
+			InventorySaveFormat::Write(Data, BinaryBytes);
+		}
+		FSimpleScopeSecondsCounter Timer(BinaryLoadSeconds);
+		bRead &= InventorySaveFormat::Read(BinaryBytes, Loaded);
+	}
+
+	if (TestTrue("Binary read", bRead) && TestEqual("Item count", Loaded.Items.Num(), Data.Items.Num()))
+	{
+		TestEqual("MaxSlots", Loaded.MaxSlots, NumSlots);
+		TestTrue("Slot indexes", Loaded.SlotIndexes == Data.SlotIndexes);
+		for (int32 i = 0; i < Data.Items.Num(); ++i)
+		{
+			const FItemStruct& Expected = Data.Items[i];
+			const FItemStruct& Actual = Loaded.Items[i];
+			if (Actual.Amount != Expected.Amount || Actual.ItemName != Expected.ItemName || Actual.MaxAmount != Expected.MaxAmount
+				|| Actual.ParentItem != Expected.ParentItem || !Actual.Description.EqualTo(Expected.Description))
+			{
+				AddError(FString::Printf(TEXT("Item %d did not survive the round trip"), i));
+				break;
+			}
+		}
+	}
+
+	TestTrue("Binary header recognized", InventorySaveFormat::IsBinary(BinaryBytes));
+	TestFalse("SaveGame data not mistaken for binary", InventorySaveFormat::IsBinary(LegacyBytes));
+	TestTrue("Binary is smaller", BinaryBytes.Num() < LegacyBytes.Num());
+
+	// Corrupt data must be rejected rather than half applied.
+	TArray<uint8> Corrupt = BinaryBytes;
+	Corrupt.Last() ^= 0xFF;
+	FItemSaveData Untouched;
+	TestFalse("Corrupt data rejected", InventorySaveFormat::Read(Corrupt, Untouched));
+	TestEqual("Rejected read leaves output alone", Untouched.Items.Num(), 0);
+
+	AddInfo(FString::Printf(TEXT("SaveGame: %d bytes, save %.3f ms, load %.3f ms"),
+		LegacyBytes.Num(), LegacySaveSeconds * 1000.0 / Iterations, LegacyLoadSeconds * 1000.0 / Iterations));
+	AddInfo(FString::Printf(TEXT("Binary:   %d bytes, save %.3f ms, load %.3f ms"),
+		BinaryBytes.Num(), BinarySaveSeconds * 1000.0 / Iterations, BinaryLoadSeconds * 1000.0 / Iterations));
+	return true;
+}
+
+// Compression: size and time trade-offs per codec and level, on both save formats
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryCompressionBenchmark, "DFInventory.Persistence.CompressionBenchmark", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+bool FInventoryCompressionBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumSlots = 500;
+	constexpr int32 Iterations = 20;
+
+	// A handful of item kinds repeated across a mostly full container, as in typical saves.
+	FItemSaveData Data;
+	Data.MaxSlots = NumSlots;
+	for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+	{
+		if (Slot % 5 == 4) continue;
+		const int32 Kind = Slot % 7;
+		FItemStruct Info;
+		Info.ItemName = FString::Printf(TEXT("Crafting Material %d"), Kind);
+		Info.Description = FText::FromString(FString::Printf(TEXT("Used in recipes of tier %d. Stacks up to 99."), Kind));
+		Info.MaxAmount = 99;
+		Info.Amount = 1 + (Slot * 37) % 99;
+		Data.Items.Add(Info);
+		Data.SlotIndexes.Add(Slot);
+	}
+
+	UInventorySaveGame* SaveGame = NewObject<UInventorySaveGame>();
+	SaveGame->SaveData = Data;
+	TArray<uint8> SaveGameBytes, BinaryBytes;
+	UGameplayStatics::SaveGameToMemory(SaveGame, SaveGameBytes);
+	InventorySaveFormat::Write(Data, BinaryBytes);
+
+	const TPair<const TCHAR*, const TArray<uint8>*> Inputs[] = { { TEXT("SaveGame"), &SaveGameBytes }, { TEXT("Binary"), &BinaryBytes } };
+	const EInventorySaveCompression Codecs[] = { EInventorySaveCompression::Zlib, EInventorySaveCompression::Oodle };
+	const EInventoryCompressionLevel Levels[] = { EInventoryCompressionLevel::Fast, EInventoryCompressionLevel::Normal, EInventoryCompressionLevel::Smallest };
+
+	for (const TPair<const TCHAR*, const TArray<uint8>*>& Input : Inputs)
+	{
+		AddInfo(FString::Printf(TEXT("%s uncompressed: %d bytes"), Input.Key, Input.Value->Num()));
+		for (const EInventorySaveCompression Codec : Codecs)
+		{
+			for (const EInventoryCompressionLevel Level : Levels)
+			{
+				TArray<uint8> Compressed, Decompressed;
+				double CompressSeconds = 0.0, DecompressSeconds = 0.0;
+				bool bRoundTrip = true;
+				for (int32 i = 0; i < Iterations; ++i)
+				{
+					Compressed = *Input.Value;
+					{
+						FSimpleScopeSecondsCounter Timer(CompressSeconds);
+						InventorySaveFormat::Compress(Compressed, { Codec, Level });
+					}
+					Decompressed = Compressed;
+					FSimpleScopeSecondsCounter Timer(DecompressSeconds);
+					bRoundTrip &= InventorySaveFormat::Decompress(Decompressed);
+				}
+
+				const FString Label = FString::Printf(TEXT("%s %s %s"), Input.Key,
+					*UEnum::GetDisplayValueAsText(Codec).ToString(), *UEnum::GetDisplayValueAsText(Level).ToString());
+				TestTrue(*(Label + TEXT(" compressed")), InventorySaveFormat::IsCompressed(Compressed));
+				TestTrue(*(Label + TEXT(" round trip")), bRoundTrip && Decompressed == *Input.Value);
+				AddInfo(FString::Printf(TEXT("%s: %d bytes (%.1f%%), compress %.3f ms, decompress %.3f ms"), *Label,
+					Compressed.Num(), 100.0 * Compressed.Num() / Input.Value->Num(),
+					CompressSeconds * 1000.0 / Iterations, DecompressSeconds * 1000.0 / Iterations));
+			}
+		}
+	}
+
+	// Plain data passes through, a damaged container is rejected.
+	TArray<uint8> Plain = BinaryBytes;
+	TestTrue("Plain data passes", InventorySaveFormat::Decompress(Plain) && Plain == BinaryBytes);
+	TArray<uint8> Damaged = BinaryBytes;
+	InventorySaveFormat::Compress(Damaged, { EInventorySaveCompression::Oodle, EInventoryCompressionLevel::Normal });
+	Damaged.SetNum(Damaged.Num() / 2);
+	TestFalse("Truncated container rejected", InventorySaveFormat::Decompress(Damaged));
+	return true;
+}
+
+// Journal: 1M appended ops, recovery from logs, from a snapshot, and past a torn tail
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FInventoryJournalBenchmark, "DFInventory.Persistence.JournalRecovery", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+bool FInventoryJournalBenchmark::RunTest(const FString& Parameters)
+{
+	constexpr int32 NumInventories = 1000;
+	constexpr int32 NumSlots = 100;
+	constexpr int32 NumOps = 1000000;
+
+	FInventoryJournal::FOptions Options;
+	Options.Directory = FPaths::AutomationTransientDir() / TEXT("InventoryJournal");
+	Options.Name = TEXT("Bench");
+	Options.CompactionBytes = MAX_int64;
+	IFileManager::Get().DeleteDirectory(*Options.Directory, false, true);
+	ON_SCOPE_EXIT { IFileManager::Get().DeleteDirectory(*Options.Directory, false, true); };
+
+	auto GetID = [](int32 Inventory) { return FString::Printf(TEXT("Bench_%d"), Inventory); };
+
+	// Expected final amount per slot; 0 means cleared.
+	TArray<int32> Expected;
+	Expected.SetNumZeroed(NumInventories * NumSlots);
+
+	double AppendSeconds = 0.0;
+	{
+		FInventoryJournal Journal(Options);
+		if (!TestTrue("Journal opened", Journal.Open())) return false;
+
+		FSimpleScopeSecondsCounter Timer(AppendSeconds);
+		FItemSaveData Empty;
+		Empty.MaxSlots = NumSlots;
+		for (int32 i = 0; i < NumInventories; ++i) Journal.WriteInventory(GetID(i), Empty);
+
+		FRandomStream Random(1234);
+		FItemStruct Info;
+		Info.ItemName = FString("Journal item");
+		Info.MaxAmount = 1000;
+		for (int32 Op = 0; Op < NumOps; ++Op)
+		{
+			const int32 Inventory = Random.RandHelper(NumInventories);
+			const int32 Slot = Random.RandHelper(NumSlots);
+			const bool bClear = Random.RandHelper(8) == 0;
+			Info.Amount = 1 + Random.RandHelper(999);
+			Journal.WriteSlot(GetID(Inventory), Slot, bClear ? nullptr : &Info);
+			Expected[Inventory * NumSlots + Slot] = bClear ? 0 : Info.Amount;
+		}
+		Journal.Flush();
+	}
+
+	auto Verify = [this, &Expected, &GetID](const FInventoryJournal& Journal, const TCHAR* Stage)
+	{
+		for (int32 Inventory = 0; Inventory < NumInventories; Inventory += 97)
+		{
+			FItemSaveData Data;
+			if (!Journal.ReadInventory(GetID(Inventory), Data))
+			{
+				AddError(FString::Printf(TEXT("%s: inventory %d missing"), Stage, Inventory));
+				return;
+			}
+			TArray<int32> Actual;
+			Actual.SetNumZeroed(NumSlots);
+			for (int32 i = 0; i < Data.Items.Num(); ++i) Actual[Data.SlotIndexes[i]] = Data.Items[i].Amount;
+			for (int32 Slot = 0; Slot < NumSlots; ++Slot)
+			{
+				if (Actual[Slot] != Expected[Inventory * NumSlots + Slot])
+				{
+					AddError(FString::Printf(TEXT("%s: inventory %d slot %d differs"), Stage, Inventory, Slot));
+					return;
+				}
+			}
+		}
+	};
+
+	double LogRecoverySeconds = 0.0, CompactSeconds = 0.0, SnapshotRecoverySeconds = 0.0;
+	{
+		FInventoryJournal Journal(Options);
+		{
+			FSimpleScopeSecondsCounter Timer(LogRecoverySeconds);
+			TestTrue("Reopened from logs", Journal.Open());
+		}
+		TestEqual("Every record replayed", Journal.GetNumReplayedRecords(), int64(NumInventories + NumOps));
+		Verify(Journal, TEXT("Logs"));
+
+		FSimpleScopeSecondsCounter Timer(CompactSeconds);
+		Journal.Compact();
+		Journal.Flush();
+	}
+	{
+		FInventoryJournal Journal(Options);
+		{
+			FSimpleScopeSecondsCounter Timer(SnapshotRecoverySeconds);
+			TestTrue("Reopened from snapshot", Journal.Open());
+		}
+		TestEqual("Nothing left to replay", Journal.GetNumReplayedRecords(), int64(0));
+		Verify(Journal, TEXT("Snapshot"));
+
+		FItemStruct Info;
+		Info.Amount = 7;
+		Journal.WriteSlot(GetID(0), 0, &Info);
+		Expected[0] = 7;
+		Journal.Flush();
+	}
+
+	// A crash mid-write leaves a partial record at the end of the newest log.
+	TArray<FString> Logs;
+	IFileManager::Get().FindFiles(Logs, *(Options.Directory / TEXT("Bench_*.log")), true, false);
+	Logs.Sort();
+	if (TestTrue("Log written", Logs.Num() > 0))
+	{
+		TUniquePtr<FArchive> Tail(IFileManager::Get().CreateFileWriter(*(Options.Directory / Logs.Last()), FILEWRITE_Append));
+		uint32 TornSize = 200;
+		*Tail << TornSize;
+	}
+	{
+		FInventoryJournal Journal(Options);
+		TestTrue("Reopened past torn record", Journal.Open());
+		Verify(Journal, TEXT("Torn tail"));
+	}
+
+	AddInfo(FString::Printf(TEXT("%d ops: append %.0f ops/s, recovery from logs %.1f ms, compaction %.1f ms, recovery from snapshot %.1f ms"),
+		NumOps, NumOps / FMath::Max(AppendSeconds, UE_SMALL_NUMBER), LogRecoverySeconds * 1000.0, CompactSeconds * 1000.0, SnapshotRecoverySeconds * 1000.0));
+	return true;
+}
@@ -0,0 +1,631 @@
+#include "Tests/InventoryReplicationBenchmark.h"
+#include "Component/MultiInventory.h"
+#include "Data/ItemData.h"
+#include "Settings/DFInventorySettings.h"
+#include "Subsystem/InventorySyncSubsystem.h"
+#include "GameFramework/PlayerController.h"
+#include "EngineUtils.h"
+#include "Engine/NetConnection.h"
+#include "Struct/InventoryNetStats.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Engine/NetDriver.h"
+#include "Engine/World.h"
+#include "Net/Core/PushModel/PushModel.h"
+#include "CoreGlobals.h"
+#if WITH_EDITOR
+#include "Editor.h"
+#include "Settings/LevelEditorPlaySettings.h"
+#include "Tests/AutomationEditorCommon.h"
+#endif
+
+AInventoryBenchmarkContainer::AInventoryBenchmarkContainer()
+{
+	bReplicates = true;
+	bAlwaysRelevant = true;
+	bReplicateUsingRegisteredSubObjectList = true;
+	
+	Inventory = CreateDefaultSubobject<UMPInventoryComponent>(TEXT("Inventory"));
+}
+
+void AInventoryBenchmarkContainer::FillInventory(int32 SlotCount)
+{
+	Inventory->SetMaxItemSlots(SlotCount);
+	for (int32 i = 0; i < SlotCount; ++i)
+	{
+		UItemData* Item = NewObject<UItemData>(Inventory);
+		FItemStruct Info;
+		Info.ItemName = FString::Printf(TEXT("BenchItem_%d"), i);
+		Info.MaxAmount = 99;
+		Info.Amount = 1 + i % 99;
+		Item->SetInfo(Info);
+		Inventory->AddItemAtIndex(Item, i);
+	}
+}
+
+AInventoryIdleReplicationBenchmark::AInventoryIdleReplicationBenchmark()
+{
+	bReplicates = true;
+	TimeLimit = 120.0f;
+}
+
+uint64 AInventoryIdleReplicationBenchmark::GetTotalBytesSent() const
+{
+	const UNetDriver* Driver = GetWorld()->GetNetDriver();
+	return Driver ? Driver->OutTotalBytes : 0;
+}
+
+void AInventoryIdleReplicationBenchmark::StartTest()
+{
+	Super::StartTest();
+	if (!HasAuthority()) return;
+	
+	if (!GetWorld()->GetNetDriver())
+	{
+		FinishTest(EFunctionalTestResult::Error, "Idle replication benchmark requires a listen server with a connected client");
+		return;
+	}
+	
+	Containers.Reserve(InventoryCount);
+	for (int32 i = 0; i < InventoryCount; ++i)
+	{
+		FActorSpawnParameters Params;
+		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		
+		AInventoryBenchmarkContainer* Container = GetWorld()->SpawnActor<AInventoryBenchmarkContainer>(GetActorLocation(), FRotator::ZeroRotator, Params);
+		Container->Inventory->SetReplicationScope(ContainerScope);
+		Container->FillInventory(ItemsPerInventory);
+		Container->Inventory->SetManageNetDormancy(bDormantContainers);
+		Containers.Add(Container);
+	}
+	
+	PhaseTime = 0.0f;
+	bMeasuring = false;
+}
+
+void AInventoryIdleReplicationBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	if (!HasAuthority() || Containers.IsEmpty()) return;
+	
+	PhaseTime += DeltaSeconds;
+	if (!bMeasuring)
+	{
+		if (PhaseTime < WarmupSeconds) return;
+		
+		bMeasuring = true;
+		PhaseTime = 0.0f;
+		FrameMsSum = 0.0;
+		FrameCount = 0;
+		StartBytes = GetTotalBytesSent();
+		return;
+	}
+	
+	FrameMsSum += FPlatformTime::ToMilliseconds(GGameThreadTime);
+	++FrameCount;
+	if (PhaseTime < MeasureSeconds) return;
+	
+	const uint64 BytesSent = GetTotalBytesSent() - StartBytes;
+	const int32 DormantCount = Containers.FilterByPredicate([](const AInventoryBenchmarkContainer* Container)
+		{ return Container && Container->NetDormancy == DORM_DormantAll; }).Num();
+	
+	const UNetDriver* Driver = GetWorld()->GetNetDriver();
+	FinishTest(EFunctionalTestResult::Succeeded, FString::Printf(
+		TEXT("%s: %d idle inventories x %d items, scope %s, %d dormant: avg server game thread %.3f ms over %d frames, %llu bytes sent (push model %s)"),
+		Driver && Driver->IsUsingIrisReplication() ? TEXT("Iris") : TEXT("Generic"),
+		InventoryCount, ItemsPerInventory, *UEnum::GetValueAsString(ContainerScope), DormantCount, FrameCount > 0 ? FrameMsSum / FrameCount : 0.0, FrameCount, BytesSent,
+		IS_PUSH_MODEL_ENABLED() ? TEXT("on") : TEXT("off")));
+}
+
+void AInventoryIdleReplicationBenchmark::CleanUp()
+{
+	for (AInventoryBenchmarkContainer* Container : Containers)
+	{ if (Container) Container->Destroy(); }
+	Containers.Reset();
+	
+	Super::CleanUp();
+}
+
+AInventoryDormancyStressTest::AInventoryDormancyStressTest()
+{
+	InventoryCount = 5000;
+	bDormantContainers = true;
+	TimeLimit = 240.0f;
+}
+
+AInventoryInitialSyncTest::AInventoryInitialSyncTest()
+{
+	bReplicates = true;
+	TimeLimit = 60.0f;
+}
+
+void AInventoryInitialSyncTest::StartTest()
+{
+	Super::StartTest();
+	if (!HasAuthority()) return;
+	
+	APlayerController* Joining = nullptr;
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		if (It->Get() && !It->Get()->IsLocalController())
+		{
+			Joining = It->Get();
+			break;
+		}
+	}
+	UInventorySyncSubsystem* SyncSubsystem = GetWorld()->GetSubsystem<UInventorySyncSubsystem>();
+	if (!Joining || !SyncSubsystem)
+	{
+		FinishTest(EFunctionalTestResult::Error, "Initial sync test requires a listen server with a connected client");
+		return;
+	}
+	
+	// Containers register for budgeting when they start replicating, so the settings go first.
+	UDFInventorySettings* Settings = GetMutableDefault<UDFInventorySettings>();
+	bSavedBudget = Settings->bBudgetInitialSync;
+	SavedBytesPerSecond = Settings->InitialSyncBytesPerSecond;
+	Settings->bBudgetInitialSync = true;
+	Settings->InitialSyncBytesPerSecond = BytesPerSecond;
+	
+	SyncSubsystem->BeginInitialSync(Joining);
+	
+	FVector ViewLocation;
+	FRotator ViewRotation;
+	Joining->GetPlayerViewPoint(ViewLocation, ViewRotation);
+	
+	Containers.Reserve(ContainerCount);
+	for (int32 i = 0; i < ContainerCount; ++i)
+	{
+		FActorSpawnParameters Params;
+		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		// The client's own inventory is the farthest one, so only priority can bring it in first.
+		Params.Owner = i == ContainerCount - 1 ? Joining : nullptr;
+		
+		const FVector Location = ViewLocation + FVector(ContainerSpacing * (i + 1), 0.0f, 0.0f);
+		AInventoryBenchmarkContainer* Container = GetWorld()->SpawnActor<AInventoryBenchmarkContainer>(Location, FRotator::ZeroRotator, Params);
+		Container->Inventory->SetReplicationScope(EInventoryReplicationScope::Everyone);
+		Container->FillInventory(ItemsPerInventory);
+		Containers.Add(Container);
+	}
+}
+
+void AInventoryInitialSyncTest::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	if (!HasAuthority()) Client_Tick();
+}
+
+void AInventoryInitialSyncTest::Client_Tick()
+{
+	if (bClientDone) return;
+	
+	const APlayerController* LocalPlayer = GetWorld()->GetFirstPlayerController();
+	const double Now = FPlatformTime::Seconds();
+	int32 Seen = 0;
+	int32 Usable = 0;
+	for (TActorIterator<AInventoryBenchmarkContainer> It(GetWorld()); It; ++It)
+	{
+		++Seen;
+		if (ClientStartTime == 0.0) ClientStartTime = Now;
+		
+		const TArray<UItemData*> Items = It->Inventory->GetInventoryItems();
+		if (!Items.ContainsByPredicate([](const UItemData* Item){ return Item != nullptr; })) continue;
+		
+		++Usable;
+		const bool bOwn = LocalPlayer && It->GetOwner() == LocalPlayer;
+		double& UsableTime = bOwn ? OwnUsableTime : FirstOtherUsableTime;
+		if (UsableTime < 0.0) UsableTime = Now - ClientStartTime;
+	}
+	if (Seen < ContainerCount || Usable < ContainerCount) return;
+	
+	bClientDone = true;
+	const double AllUsableTime = Now - ClientStartTime;
+	if (OwnUsableTime > FirstOtherUsableTime)
+	{
+		FinishTest(EFunctionalTestResult::Failed, FString::Printf(
+			TEXT("Client: own inventory usable after %.2fs, later than the first container (%.2fs)"), OwnUsableTime, FirstOtherUsableTime));
+		return;
+	}
+	FinishTest(EFunctionalTestResult::Succeeded, FString::Printf(
+		TEXT("Client: own inventory usable after %.2fs, first container after %.2fs, all %d containers x %d items after %.2fs at %d bytes/s"),
+		OwnUsableTime, FirstOtherUsableTime, ContainerCount, ItemsPerInventory, AllUsableTime, BytesPerSecond));
+}
+
+void AInventoryInitialSyncTest::CleanUp()
+{
+	for (AInventoryBenchmarkContainer* Container : Containers)
+	{ if (Container) Container->Destroy(); }
+	Containers.Reset();
+	
+	if (SavedBytesPerSecond > 0)
+	{
+		UDFInventorySettings* Settings = GetMutableDefault<UDFInventorySettings>();
+		Settings->bBudgetInitialSync = bSavedBudget;
+		Settings->InitialSyncBytesPerSecond = SavedBytesPerSecond;
+	}
+	
+	Super::CleanUp();
+}
+
+AInventoryWorkloadBenchmark::AInventoryWorkloadBenchmark()
+{
+	bReplicates = true;
+	bReplicateUsingRegisteredSubObjectList = true;
+	TimeLimit = 120.0f;
+	
+	const TCHAR* Names[] = { TEXT("Potion"), TEXT("Arrow"), TEXT("Ore"), TEXT("Herb") };
+	for (int32 i = 0; i < UE_ARRAY_COUNT(Names); ++i)
+	{
+		UItemData* Definition = CreateDefaultSubobject<UItemData>(FName(TEXT("Definition"), i));
+		FItemStruct Info;
+		Info.ParentItem = Definition;
+		Info.ItemName = Names[i];
+		Info.MaxAmount = 99;
+		Definition->SetInfo(Info);
+		Definitions.Add(Definition);
+	}
+}
+
+UItemData* AInventoryWorkloadBenchmark::MakeItem(UInventoryComponent* Outer, int32 Amount)
+{
+	const UItemData* Definition = Definitions[Random.RandHelper(Definitions.Num())];
+	FItemStruct Info = Definition->GetInfoRef();
+	Info.Amount = Amount;
+	
+	UItemData* Item = NewObject<UItemData>(Outer);
+	Item->SetInfo(Info);
+	return Item;
+}
+
+int32 AInventoryWorkloadBenchmark::PickSlot(UInventoryComponent* Inventory, bool bOccupied)
+{
+	// Random start, then the first matching slot after it.
+	const TArray<UItemData*> Items = Inventory->GetInventoryItems();
+	const int32 Start = Random.RandHelper(Items.Num());
+	for (int32 Offset = 0; Offset < Items.Num(); ++Offset)
+	{
+		const int32 Index = (Start + Offset) % Items.Num();
+		if ((Items[Index] != nullptr) == bOccupied) return Index;
+	}
+	return INDEX_NONE;
+}
+
+AInventoryWorkloadBenchmark::EOperation AInventoryWorkloadBenchmark::PickOperation()
+{
+	const float Weights[] = { AddWeight, StackWeight, SplitWeight, TransferWeight };
+	float Total = 0.0f;
+	for (float Weight : Weights) Total += Weight;
+	
+	float Roll = Random.FRandRange(0.0f, FMath::Max(Total, UE_SMALL_NUMBER));
+	for (int32 i = 0; i < UE_ARRAY_COUNT(Weights); ++i)
+	{
+		if (Roll < Weights[i]) return static_cast<EOperation>(i);
+		Roll -= Weights[i];
+	}
+	return EOperation::Add;
+}
+
+void AInventoryWorkloadBenchmark::RunOperation()
+{
+	UMPInventoryComponent* Inventory = Containers[Random.RandHelper(Containers.Num())]->Inventory;
+	
+	switch (PickOperation())
+	{
+	case EOperation::Add:
+	{
+		// Full inventories churn instead, so the mix keeps going.
+		const int32 Empty = PickSlot(Inventory, false);
+		if (Empty == INDEX_NONE)
+		{ Inventory->RemoveItemFromInventory(PickSlot(Inventory, true)); }
+		else
+		{ Inventory->AddItemAtIndex(MakeItem(Inventory, Random.RandRange(1, 20)), Empty); }
+		break;
+	}
+	case EOperation::Stack:
+		Inventory->AddItemToInventory(MakeItem(Inventory, 1));
+		break;
+		
+	case EOperation::Split:
+	{
+		const int32 Source = PickSlot(Inventory, true);
+		const int32 Target = PickSlot(Inventory, false);
+		const TArray<UItemData*> Items = Inventory->GetInventoryItems();
+		if (Source != INDEX_NONE && Target != INDEX_NONE && Items[Source]->GetInfoRef().Amount > 1)
+		{ Inventory->SplitStack(Source, Target, Items[Source]->GetInfoRef().Amount / 2); }
+		break;
+	}
+	case EOperation::Transfer:
+	{
+		UMPInventoryComponent* Other = Containers[Random.RandHelper(Containers.Num())]->Inventory;
+		const int32 Source = PickSlot(Inventory, true);
+		const int32 Target = PickSlot(Other, false);
+		if (Other != Inventory && Source != INDEX_NONE && Target != INDEX_NONE)
+		{ Inventory->TransferItemToSlot(Other, Source, Target); }
+		break;
+	}
+	}
+	++OperationsDone;
+}
+
+void AInventoryWorkloadBenchmark::StartTest()
+{
+	Super::StartTest();
+	if (!HasAuthority()) return;
+	
+	const UNetDriver* Driver = GetWorld()->GetNetDriver();
+	if (!Driver || Driver->ClientConnections.Num() < MinClients)
+	{
+		FinishTest(EFunctionalTestResult::Error, FString::Printf(TEXT("Workload benchmark requires a listen server with at least %d connected clients"), MinClients));
+		return;
+	}
+	
+	Random.Initialize(RandomSeed);
+	Containers.Reserve(InventoryCount);
+	for (int32 i = 0; i < InventoryCount; ++i)
+	{
+		FActorSpawnParameters Params;
+		Params.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		
+		AInventoryBenchmarkContainer* Container = GetWorld()->SpawnActor<AInventoryBenchmarkContainer>(GetActorLocation(), FRotator::ZeroRotator, Params);
+		Container->Inventory->SetReplicationScope(EInventoryReplicationScope::Everyone);
+		Container->Inventory->SetMaxItemSlots(SlotsPerInventory);
+		for (int32 Slot = 0; Slot < SlotsPerInventory; Slot += 2)
+		{ Container->Inventory->AddItemAtIndex(MakeItem(Container->Inventory, Random.RandRange(1, 20)), Slot); }
+		Containers.Add(Container);
+	}
+	
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddUObject(this, &AInventoryWorkloadBenchmark::HandlePostActorTick);
+	PostTickFlushHandle = GetWorld()->OnPostTickFlush().AddUObject(this, &AInventoryWorkloadBenchmark::HandlePostTickFlush);
+	
+	PhaseTime = 0.0f;
+	bMeasuring = false;
+	bReported = false;
+}
+
+void AInventoryWorkloadBenchmark::HandlePostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == GetWorld()) FlushStartCycles = FPlatformTime::Cycles64();
+}
+
+void AInventoryWorkloadBenchmark::HandlePostTickFlush(float DeltaSeconds)
+{
+	if (bMeasuring && FlushStartCycles != 0)
+	{ NetMsSum += FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - FlushStartCycles); }
+	FlushStartCycles = 0;
+}
+
+void AInventoryWorkloadBenchmark::Tick(float DeltaSeconds)
+{
+	Super::Tick(DeltaSeconds);
+	if (!HasAuthority() || Containers.IsEmpty() || bReported) return;
+	
+	PhaseTime += DeltaSeconds;
+	if (!bMeasuring)
+	{
+		if (PhaseTime >= WarmupSeconds) BeginMeasure();
+		return;
+	}
+	
+	FrameMsSum += FPlatformTime::ToMilliseconds(GGameThreadTime);
+	++FrameCount;
+	
+	PendingOperations += OperationsPerSecond * DeltaSeconds;
+	while (PendingOperations >= 1.0)
+	{
+		RunOperation();
+		PendingOperations -= 1.0;
+	}
+	
+	if (PhaseTime >= MeasureSeconds) FinishMeasure();
+}
+
+void AInventoryWorkloadBenchmark::BeginMeasure()
+{
+	bMeasuring = true;
+	PhaseTime = 0.0f;
+	FrameCount = 0;
+	FrameMsSum = 0.0;
+	NetMsSum = 0.0;
+	OperationsDone = 0;
+	PendingOperations = 0.0;
+	FInventoryNetStats::Get().Reset();
+	
+	StartBytes.Reset();
+	for (UNetConnection* Connection : GetWorld()->GetNetDriver()->ClientConnections)
+	{ if (Connection) StartBytes.Add(Connection, Connection->OutTotalBytes); }
+}
+
+void AInventoryWorkloadBenchmark::FinishMeasure()
+{
+	bMeasuring = false;
+	bReported = true;
+	
+	const UNetDriver* Driver = GetWorld()->GetNetDriver();
+	const double Seconds = FMath::Max(PhaseTime, UE_SMALL_NUMBER);
+	const double Frames = FMath::Max(FrameCount, 1);
+	
+	TArray<TSharedPtr<FJsonValue>> ConnectionRates;
+	double MaxBytesPerSecond = 0.0;
+	for (const TPair<TWeakObjectPtr<UNetConnection>, uint64>& Pair : StartBytes)
+	{
+		if (!Pair.Key.IsValid()) continue;
+		const double Rate = (Pair.Key->OutTotalBytes - Pair.Value) / Seconds;
+		ConnectionRates.Add(MakeShared<FJsonValueNumber>(Rate));
+		MaxBytesPerSecond = FMath::Max(MaxBytesPerSecond, Rate);
+	}
+	
+	// Clients only show up in the counters when they run in this process (PIE single process).
+	int32 LocalClients = 0;
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{ if (Context.World() && Context.World()->GetNetMode() == NM_Client) ++LocalClients; }
+	const FInventoryNetStats& RepStats = FInventoryNetStats::Get();
+	const double ClientRepMs = LocalClients > 0 ? RepStats.GetClientRepMs() / LocalClients / Frames : -1.0;
+	const double ServerNetMs = NetMsSum / Frames;
+	
+	TArray<FString> Failures;
+	if (MaxBytesPerSecondPerConnection > 0.0f && MaxBytesPerSecond > MaxBytesPerSecondPerConnection)
+	{ Failures.Add(FString::Printf(TEXT("%.0f bytes/s on a connection exceeds %.0f"), MaxBytesPerSecond, MaxBytesPerSecondPerConnection)); }
+	if (MaxServerNetMsPerFrame > 0.0f && ServerNetMs > MaxServerNetMsPerFrame)
+	{ Failures.Add(FString::Printf(TEXT("server net flush %.3f ms/frame exceeds %.3f"), ServerNetMs, MaxServerNetMsPerFrame)); }
+	if (MaxClientRepMsPerFrame > 0.0f && ClientRepMs > MaxClientRepMsPerFrame)
+	{ Failures.Add(FString::Printf(TEXT("client replication %.3f ms/frame exceeds %.3f"), ClientRepMs, MaxClientRepMsPerFrame)); }
+	
+	TSharedRef<FJsonObject> Report = MakeShared<FJsonObject>();
+	Report->SetStringField(TEXT("name"), ReportName);
+	Report->SetStringField(TEXT("replication"), Driver->IsUsingIrisReplication() ? TEXT("Iris") : TEXT("Generic"));
+	Report->SetNumberField(TEXT("clients"), ConnectionRates.Num());
+	Report->SetNumberField(TEXT("inventories"), InventoryCount);
+	Report->SetNumberField(TEXT("slots_per_inventory"), SlotsPerInventory);
+	Report->SetNumberField(TEXT("operations"), OperationsDone);
+	Report->SetNumberField(TEXT("seconds"), Seconds);
+	Report->SetNumberField(TEXT("frames"), FrameCount);
+	Report->SetArrayField(TEXT("bytes_per_second_per_connection"), ConnectionRates);
+	Report->SetNumberField(TEXT("max_bytes_per_second_per_connection"), MaxBytesPerSecond);
+	Report->SetNumberField(TEXT("server_net_ms_per_frame"), ServerNetMs);
+	Report->SetNumberField(TEXT("server_game_thread_ms_per_frame"), FrameMsSum / Frames);
+	Report->SetNumberField(TEXT("client_rep_ms_per_frame"), ClientRepMs);
+	Report->SetNumberField(TEXT("client_rep_calls"), RepStats.ClientRepCalls);
+	Report->SetBoolField(TEXT("passed"), Failures.IsEmpty());
+	TArray<TSharedPtr<FJsonValue>> FailureValues;
+	for (const FString& Failure : Failures) FailureValues.Add(MakeShared<FJsonValueString>(Failure));
+	Report->SetArrayField(TEXT("failures"), FailureValues);
+	WriteReport(Report);
+	
+	const FString Summary = FString::Printf(
+		TEXT("%d clients, %d inventories, %d operations in %.1fs: max %.0f bytes/s per connection, server net %.3f ms/frame, client replication %.3f ms/frame"),
+		ConnectionRates.Num(), InventoryCount, OperationsDone, Seconds, MaxBytesPerSecond, ServerNetMs, ClientRepMs);
+	if (Failures.IsEmpty())
+	{ FinishTest(EFunctionalTestResult::Succeeded, Summary); }
+	else
+	{ FinishTest(EFunctionalTestResult::Failed, Summary + TEXT(": ") + FString::Join(Failures, TEXT("; "))); }
+}
+
+void AInventoryWorkloadBenchmark::WriteReport(const TSharedRef<FJsonObject>& Report) const
+{
+	FString Json;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&Json);
+	FJsonSerializer::Serialize(Report, Writer);
+	
+	const FString Path = FPaths::ProjectSavedDir() / TEXT("Automation") / TEXT("DFInventory") / (ReportName + TEXT(".json"));
+	if (!FFileHelper::SaveStringToFile(Json, *Path))
+	{ UE_LOG(LogTemp, Warning, TEXT("[Inventory] Could not write benchmark report to %s"), *Path); }
+}
+
+void AInventoryWorkloadBenchmark::CleanUp()
+{
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	if (GetWorld()) GetWorld()->OnPostTickFlush().Remove(PostTickFlushHandle);
+	
+	for (AInventoryBenchmarkContainer* Container : Containers)
+	{ if (Container) Container->Destroy(); }
+	Containers.Reset();
+	
+	Super::CleanUp();
+}
+
+#if WITH_EDITOR
+
+	// Waits for the PIE listen server and its clients, runs the workload benchmark there and reports its result.
+	class FRunInventoryWorkloadCommand : public IAutomationLatentCommand
+	{
+	public:
+		FRunInventoryWorkloadCommand(FAutomationTestBase* InTest, int32 InNumClients)
+			: Test(InTest), NumClients(InNumClients) {}
+
+		virtual bool Update() override
+		{
+			AInventoryWorkloadBenchmark* Benchmark = FindServerBenchmark();
+			const UNetDriver* Driver = Benchmark ? Benchmark->GetWorld()->GetNetDriver() : nullptr;
+			if (!bStarted)
+			{
+				if (!Driver || Driver->ClientConnections.Num() < NumClients)
+				{
+					if (GetCurrentRunTime() < ConnectTimeoutSeconds) return false;
+					Test->AddError(FString::Printf(TEXT("%d PIE clients did not connect in time"), NumClients));
+					return true;
+				}
+				bStarted = Benchmark->RunTest();
+				return !bStarted;
+			}
+			
+			if (Benchmark && Benchmark->IsRunning()) return false;
+			if (!Benchmark || Benchmark->Result != EFunctionalTestResult::Succeeded)
+			{ Test->AddError(TEXT("Workload benchmark failed, see the log and the JSON report")); }
+			return true;
+		}
+
+	private:
+		static AInventoryWorkloadBenchmark* FindServerBenchmark()
+		{
+			for (const FWorldContext& Context : GEngine->GetWorldContexts())
+			{
+				UWorld* World = Context.World();
+				if (Context.WorldType != EWorldType::PIE || !World || World->GetNetMode() != NM_ListenServer) continue;
+				
+				for (TActorIterator<AInventoryWorkloadBenchmark> It(World); It; ++It)
+				{ return *It; }
+			}
+			return nullptr;
+		}
+
+		static constexpr double ConnectTimeoutSeconds = 60.0;
+		FAutomationTestBase* Test;
+		int32 NumClients;
+		bool bStarted = false;
+	};
+
+	// Headless regression gate: PIE listen server with N clients in one process, e.g.
+	// UnrealEditor-Cmd <Project> -ExecCmds="Automation RunTests DFInventory.Benchmark; Quit" -nullrhi -unattended
+	IMPLEMENT_COMPLEX_AUTOMATION_TEST(FInventoryWorkloadBenchmarkTest, "DFInventory.Benchmark.Workload", EAutomationTestFlags::EditorContext | EAutomationTestFlags::PerfFilter)
+	void FInventoryWorkloadBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+	{
+		for (int32 NumClients : { 2, 4, 8 })
+		{
+			OutBeautifiedNames.Add(FString::Printf(TEXT("%d Clients"), NumClients));
+			OutTestCommands.Add(FString::FromInt(NumClients));
+		}
+	}
+
+	bool FInventoryWorkloadBenchmarkTest::RunTest(const FString& Parameters)
+	{
+		const int32 NumClients = FMath::Max(FCString::Atoi(*Parameters), 1);
+		
+		ULevelEditorPlaySettings* PlaySettings = GetMutableDefault<ULevelEditorPlaySettings>();
+		EPlayNetMode SavedNetMode;
+		int32 SavedPlayers;
+		bool bSavedOneProcess;
+		PlaySettings->GetPlayNetMode(SavedNetMode);
+		PlaySettings->GetPlayNumberOfClients(SavedPlayers);
+		PlaySettings->GetRunUnderOneProcess(bSavedOneProcess);
+		
+		// The listen server counts as one of the players; one process so client replication cost can be measured.
+		PlaySettings->SetPlayNetMode(EPlayNetMode::PIE_ListenServer);
+		PlaySettings->SetPlayNumberOfClients(NumClients + 1);
+		PlaySettings->SetRunUnderOneProcess(true);
+		
+		UWorld* World = FAutomationEditorCommonUtils::CreateNewMap();
+		AInventoryWorkloadBenchmark* Benchmark = World ? World->SpawnActor<AInventoryWorkloadBenchmark>() : nullptr;
+		if (!Benchmark)
+		{
+			AddError("Failed to spawn the workload benchmark");
+			return false;
+		}
+		Benchmark->MinClients = NumClients;
+		Benchmark->ReportName = FString::Printf(TEXT("InventoryWorkload_%dClients"), NumClients);
+		
+		ADD_LATENT_AUTOMATION_COMMAND(FStartPIECommand(false));
+		ADD_LATENT_AUTOMATION_COMMAND(FRunInventoryWorkloadCommand(this, NumClients));
+		ADD_LATENT_AUTOMATION_COMMAND(FEndPlayMapCommand());
+		ADD_LATENT_AUTOMATION_COMMAND(FFunctionLatentCommand([PlaySettings, SavedNetMode, SavedPlayers, bSavedOneProcess]()
+		{
+			PlaySettings->SetPlayNetMode(SavedNetMode);
+			PlaySettings->SetPlayNumberOfClients(SavedPlayers);
+			PlaySettings->SetRunUnderOneProcess(bSavedOneProcess);
+			return true;
+		}));
+		return true;
+	}
+#endif
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FunctionalTest.h"
+#include "GameFramework/Actor.h"
+#include "Component/InventoryComponent.h"
+#include "InventoryReplicationBenchmark.generated.h"
+
+class UMPInventoryComponent;
+class UItemData;
+
+// Replicated actor holding a single inventory. Stands in for chests and players in the benchmarks.
+UCLASS(NotBlueprintable)
+class DFINVENTORY_API AInventoryBenchmarkContainer : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AInventoryBenchmarkContainer();
+
+	UPROPERTY(VisibleAnywhere, Category = "Inventory")
+	TObjectPtr<UMPInventoryComponent> Inventory;
+
+	// Fills every slot with a distinct item.
+	void FillInventory(int32 SlotCount);
+};
+
+/**
+ * Functional Test measuring the server cost of idle replicated inventories.
+ * Spawns InventoryCount filled inventories, lets them replicate once, then reports the average server
+ * game thread time and bytes sent while nothing changes.
+ * Requires a listen server with at least one connected client.
+ */
+UCLASS()
+class DFINVENTORY_API AInventoryIdleReplicationBenchmark : public AFunctionalTest
+{
+	GENERATED_BODY()
+
+public:
+	AInventoryIdleReplicationBenchmark();
+
+protected:
+	virtual void StartTest() override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void CleanUp() override;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 1))
+	int32 InventoryCount = 1000;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 1))
+	int32 ItemsPerInventory = 20;
+
+	// Compare Everyone against Viewers to see bandwidth follow open containers instead of relevant clients.
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	EInventoryReplicationScope ContainerScope = EInventoryReplicationScope::Everyone;
+
+	// Lets every container inventory manage its actor's net dormancy.
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	bool bDormantContainers = false;
+
+	// Time given to the initial replication of every inventory before measuring.
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float WarmupSeconds = 3.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float MeasureSeconds = 5.0f;
+
+private:
+	UPROPERTY()
+	TArray<TObjectPtr<AInventoryBenchmarkContainer>> Containers;
+
+	uint64 GetTotalBytesSent() const;
+
+	float PhaseTime = 0.0f;
+	bool bMeasuring = false;
+	double FrameMsSum = 0.0;
+	int32 FrameCount = 0;
+	uint64 StartBytes = 0;
+};
+
+/**
+ * Stress test for dormancy-managed world containers.
+ * Same measurement as the idle benchmark, with 5,000 containers that are dormant once their initial state has gone out.
+ */
+UCLASS()
+class DFINVENTORY_API AInventoryDormancyStressTest : public AInventoryIdleReplicationBenchmark
+{
+	GENERATED_BODY()
+
+public:
+	AInventoryDormancyStressTest();
+};
+
+/**
+ * Functional Test for the budgeted initial sync of joining players.
+ * Replays the join of the first remote client against ContainerCount fresh containers spread out in a line, the
+ * farthest one owned by that client, and reports on the client how long it took until its own inventory and
+ * every container were usable. The own inventory has to arrive first.
+ * Requires a listen server with at least one connected client.
+ */
+UCLASS()
+class DFINVENTORY_API AInventoryInitialSyncTest : public AFunctionalTest
+{
+	GENERATED_BODY()
+
+public:
+	AInventoryInitialSyncTest();
+
+protected:
+	virtual void StartTest() override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void CleanUp() override;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 2))
+	int32 ContainerCount = 200;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 1))
+	int32 ItemsPerInventory = 20;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float ContainerSpacing = 200.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 1024))
+	int32 BytesPerSecond = 32768;
+
+private:
+	UPROPERTY()
+	TArray<TObjectPtr<AInventoryBenchmarkContainer>> Containers;
+
+	void Client_Tick();
+
+	// Server: settings overridden for the test, restored in CleanUp once saved.
+	bool bSavedBudget = false;
+	int32 SavedBytesPerSecond = 0;
+
+	// Client: seconds since the first container showed up.
+	double ClientStartTime = 0.0;
+	double OwnUsableTime = -1.0;
+	double FirstOtherUsableTime = -1.0;
+	bool bClientDone = false;
+};
+
+/**
+ * Functional Test driving a scripted inventory workload for regression gating.
+ * Spawns InventoryCount half-filled inventories and, once connected clients have them, runs a seeded random mix of
+ * adds, stacks, splits and transfers at OperationsPerSecond. Reports bytes per second per connection, the server's
+ * net flush time per frame and the clients' replication callback time per frame (clients in the same process only),
+ * writes them as JSON to Saved/Automation/DFInventory/<ReportName>.json and fails when a threshold is exceeded.
+ * Requires a listen server with at least MinClients connected clients. "DFInventory.Benchmark.Workload" runs it
+ * headless in PIE, e.g. UnrealEditor-Cmd <Project> -ExecCmds="Automation RunTests DFInventory.Benchmark" -nullrhi -unattended.
+ */
+UCLASS()
+class DFINVENTORY_API AInventoryWorkloadBenchmark : public AFunctionalTest
+{
+	GENERATED_BODY()
+
+public:
+	AInventoryWorkloadBenchmark();
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 2))
+	int32 InventoryCount = 100;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 2))
+	int32 SlotsPerInventory = 40;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 1))
+	int32 MinClients = 1;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark", meta = (ClampMin = 1))
+	float OperationsPerSecond = 200.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	int32 RandomSeed = 1337;
+
+	// Relative weights of the scripted operations.
+	UPROPERTY(EditAnywhere, Category = "Benchmark|Mix", meta = (ClampMin = 0))
+	float AddWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark|Mix", meta = (ClampMin = 0))
+	float StackWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark|Mix", meta = (ClampMin = 0))
+	float SplitWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark|Mix", meta = (ClampMin = 0))
+	float TransferWeight = 1.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float WarmupSeconds = 3.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	float MeasureSeconds = 10.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark")
+	FString ReportName = TEXT("InventoryWorkload");
+
+	// Regression gates; 0 disables a gate.
+	UPROPERTY(EditAnywhere, Category = "Benchmark|Thresholds", meta = (ClampMin = 0))
+	float MaxBytesPerSecondPerConnection = 0.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark|Thresholds", meta = (ClampMin = 0))
+	float MaxServerNetMsPerFrame = 0.0f;
+
+	UPROPERTY(EditAnywhere, Category = "Benchmark|Thresholds", meta = (ClampMin = 0))
+	float MaxClientRepMsPerFrame = 0.0f;
+
+protected:
+	virtual void StartTest() override;
+	virtual void Tick(float DeltaSeconds) override;
+	virtual void CleanUp() override;
+
+private:
+	enum class EOperation : uint8 { Add, Stack, Split, Transfer };
+
+	UPROPERTY()
+	TArray<TObjectPtr<AInventoryBenchmarkContainer>> Containers;
+
+	// Stable-named definitions, so stacks replicate in the compact format.
+	UPROPERTY()
+	TArray<TObjectPtr<UItemData>> Definitions;
+
+	UItemData* MakeItem(UInventoryComponent* Outer, int32 Amount);
+	EOperation PickOperation();
+	void RunOperation();
+	int32 PickSlot(UInventoryComponent* Inventory, bool bOccupied);
+	
+	void BeginMeasure();
+	void FinishMeasure();
+	void WriteReport(const TSharedRef<class FJsonObject>& Report) const;
+
+	// Times the net flush: from the end of actor ticks to the end of TickFlush.
+	void HandlePostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void HandlePostTickFlush(float DeltaSeconds);
+
+	FRandomStream Random;
+	float PhaseTime = 0.0f;
+	bool bMeasuring = false;
+	bool bReported = false;
+	double PendingOperations = 0.0;
+	int32 OperationsDone = 0;
+	int32 FrameCount = 0;
+	double FrameMsSum = 0.0;
+	double NetMsSum = 0.0;
+	uint64 FlushStartCycles = 0;
+	TMap<TWeakObjectPtr<class UNetConnection>, uint64> StartBytes;
+	FDelegateHandle PostActorTickHandle;
+	FDelegateHandle PostTickFlushHandle;
+};
@@ -12,8 +12,11 @@ void UInventoryTileView::SetInventoryComponent(UInventoryComponent* NewComponent
 		OldComp->OnItemUpdated.RemoveDynamic(this, &UInventoryTileView::OnItemUpdated);
 		OldComp->OnInventoryRefresh.RemoveDynamic(this, &UInventoryTileView::RefreshInventoryList);
 	}
+	if (OldComp)
+	{ OldComp->SetVisibleSlotRange(0, 0); }
 	
 	InventoryComponent = NewComponent;
+	CurrentPage = 0;
 	ClearListItems();
 	
 	UInventoryComponent* NewComp = InventoryComponent.Get();
@@ -39,7 +42,7 @@ void UInventoryTileView::OnItemRemoved(UItemData* Item, int32 Amount)
 
 void UInventoryTileView::OnItemUpdated(int32 Index, UItemData* Item)
 {
-	if (Index < 0) return; 
+	if (Index < 0 || !IsIndexOnPage(Index)) return;
 
 	TWeakObjectPtr<UItemData>* OldItemPtr = CurrentItemMap.Find(Index);
 	UItemData* OldItem = OldItemPtr ? OldItemPtr->Get() : nullptr;
@@ -84,7 +87,11 @@ void UInventoryTileView::RefreshInventoryList()
 	
 	const TArray<TObjectPtr<UItemData>>& Items = InventoryComponent->InventoryItems;
 	
-	for (int32 i = 0; i < Items.Num(); ++i)
+	int32 First = 0, Num = 0;
+	GetPageRange(First, Num);
+	InventoryComponent->SetVisibleSlotRange(First, Num);
+	
+	for (int32 i = First; i < First + Num && i < Items.Num(); ++i)
 	{
 		UItemData* Item = Items[i];
 		if (Item)
@@ -100,3 +107,37 @@ bool UInventoryTileView::ItemFilter_Implementation(UItemData* Item)
 	return Item != nullptr;
 }
 
+
+void UInventoryTileView::SetPage(int32 NewPage)
+{
+	NewPage = FMath::Clamp(NewPage, 0, FMath::Max(GetPageCount() - 1, 0));
+	if (NewPage == CurrentPage) return;
+	
+	CurrentPage = NewPage;
+	RefreshInventoryList();
+}
+
+int32 UInventoryTileView::GetPageCount() const
+{
+	const int32 NumSlots = InventoryComponent.IsValid() ? InventoryComponent->InventoryItems.Num() : 0;
+	return PageSize > 0 ? FMath::DivideAndRoundUp(NumSlots, PageSize) : 1;
+}
+
+void UInventoryTileView::GetPageRange(int32& OutFirst, int32& OutNum) const
+{
+	const int32 NumSlots = InventoryComponent.IsValid() ? InventoryComponent->InventoryItems.Num() : 0;
+	OutFirst = PageSize > 0 ? FMath::Min(CurrentPage * PageSize, NumSlots) : 0;
+	OutNum = PageSize > 0 ? FMath::Min(PageSize, NumSlots - OutFirst) : NumSlots;
+}
+
+bool UInventoryTileView::IsIndexOnPage(int32 Index) const
+{ return PageSize <= 0 || Index / PageSize == CurrentPage; }
+
+void UInventoryTileView::ReleaseSlateResources(bool bReleaseChildren)
+{
+	// Closing the UI stops the server streaming this page.
+	if (InventoryComponent.IsValid())
+	{ InventoryComponent->SetVisibleSlotRange(0, 0); }
+	
+	Super::ReleaseSlateResources(bReleaseChildren);
+}
@@ -120,18 +120,18 @@ bool UItemSlotWidget::NativeOnDrop(const FGeometry& InGeometry, const FDragDropE
 		{
 			if (InvDragOp->SourceSlotIndex == SlotIndex) return true;
 			
+			// Request* applies locally right away and lets the server confirm, so drops feel instant on clients.
 			if (InvDragOp->DraggedItem)
 			{
-				InventoryComponent->SwapItemSlots(InvDragOp->SourceSlotIndex, SlotIndex);
+				InventoryComponent->RequestSwapItemSlots(InvDragOp->SourceSlotIndex, SlotIndex);
 			}
 		}
 		else
 		{
 			// Cross Inventory Drop
-			if (InvDragOp->DraggedItem)
+			if (InvDragOp->DraggedItem && InvDragOp->SourceInventory)
 			{
-			    // Attempt to add item to this specific slot or inventory
-			    // InventoryBase::HandleStackItem or AddItem implementation
+				InvDragOp->SourceInventory->RequestTransferItemToSlot(InventoryComponent.Get(), InvDragOp->SourceSlotIndex, SlotIndex);
 			}
 		}
 		return true;
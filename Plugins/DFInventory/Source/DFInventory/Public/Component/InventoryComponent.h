@@ -1,10 +1,15 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
 #include "Settings/InventorySaveGame.h"
+#include "Struct/InventorySlots.h"
+#include "Struct/InventoryPrediction.h"
+#include "Struct/InventoryCommands.h"
 #include "InventoryComponent.generated.h"
 
 class UItemData;
+class APlayerController;
 struct FItemStruct;
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnInventoryEvent);
@@ -17,25 +22,112 @@ enum class ESaveType : uint8
 	Memory	UMETA(DisplayName = "Memory (Map Transfer)")
 };
 
+UENUM(BlueprintType)
+enum class EInventoryReplicationMode : uint8
+{
+	// Replicates the whole InventoryItems array; any change makes clients refresh the entire inventory.
+	FullArray	UMETA(DisplayName = "Full Array (Legacy)"),
+	// Replicates per-slot adds/changes/removes through a FastArraySerializer.
+	SlotDeltas	UMETA(DisplayName = "Slot Deltas"),
+	// Like SlotDeltas, but slots are sent as definition + amount + changed payload, with no item subobjects.
+	// Clients build their own UItemData views from the definitions.
+	SlotStructs	UMETA(DisplayName = "Slot Structs (No Subobjects)")
+};
+
+UENUM(BlueprintType)
+enum class EInventoryReplicationScope : uint8
+{
+	// OwnerOnly for inventories owned by a pawn, controller or player state, Everyone otherwise.
+	Auto		UMETA(DisplayName = "Auto"),
+	// Every client that has the owning actor relevant.
+	Everyone	UMETA(DisplayName = "Everyone"),
+	// Only the owning connection (COND_OwnerOnly). Use for player inventories.
+	OwnerOnly	UMETA(DisplayName = "Owner Only"),
+	// Only clients registered through AddViewer, e.g. players with a chest open.
+	Viewers		UMETA(DisplayName = "Viewers Only")
+};
+
 UCLASS(Blueprintable, ClassGroup=(Inventory), meta=(BlueprintSpawnableComponent))
 class DFINVENTORY_API UInventoryComponent : public UActorComponent
 {
 	GENERATED_BODY()
 
 	friend class UInventorySaveRules;
+	friend struct FInventorySlotArray;
+	friend struct FInventorySlotEntry;
 
 protected:
 	
-	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta=(ClampMin=1))
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, ReplicatedUsing=OnRep_MaxItemSlots, meta=(ClampMin=1))
 	int32 MaxItemSlots = 5;
 
+	// How slot contents are sent to clients. Only read on the server.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication")
+	EInventoryReplicationMode ReplicationMode = EInventoryReplicationMode::SlotDeltas;
+
+	/**
+	 * Which clients receive this inventory. Applied as a component net condition, so it also covers the item subobjects.
+	 * Requires the owning actor to use the registered subobject list. Only read on the server.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication")
+	EInventoryReplicationScope ReplicationScope = EInventoryReplicationScope::Auto;
+
+	/**
+	 * Lets this inventory drive the owning actor's net dormancy: the actor stays DormantAll, wakes on any change and
+	 * goes dormant again after NetDormancyQuietSeconds without changes. Meant for chests, corpses and other world containers.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication")
+	bool bManageNetDormancy = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication", meta = (EditCondition = "bManageNetDormancy", ClampMin = 0.1))
+	float NetDormancyQuietSeconds = 5.0f;
+
+	/**
+	 * Lets any connected player modify this inventory through the Request* calls, not only the net owner and viewers.
+	 * Separate from ReplicationScope on purpose: a container everyone sees is not one everyone may empty from afar.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Prediction")
+	bool bAllowModificationByAnyPlayer = false;
+
+	/**
+	 * For very large stashes: only slot pages some client has asked for through SetVisibleSlotRange stream down,
+	 * other pages replicate as PageSummaries. Applies to the slot replication modes, not FullArray.
+	 * Streamed pages are shared: every connection the inventory replicates to receives the union of all viewers'
+	 * ranges, not only its own. Paging bounds how much of the stash is sent, not who may see a given page.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication")
+	bool bPagedReplication = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication", meta = (EditCondition = "bPagedReplication", ClampMin = 1))
+	int32 ReplicationPageSize = 100;
+
+	// Caps how much of the inventory a single client can have streamed at once.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Replication", meta = (EditCondition = "bPagedReplication", ClampMin = 1))
+	int32 MaxVisiblePagesPerViewer = 4;
+
+	// One entry per page while bPagedReplication is on.
+	UPROPERTY(ReplicatedUsing=OnRep_PageSummaries)
+	TArray<FInventoryPageSummary> PageSummaries;
+
+	// Per-slot replicated mirror of InventoryItems, used by EInventoryReplicationMode::SlotDeltas.
+	UPROPERTY(Replicated)
+	FInventorySlotArray ReplicatedSlots;
+
 	// defines how this inventory handles saving/loading (Disk, Memory, etc).
 	// If Null, no auto-saving will occur.
 	UPROPERTY(EditAnywhere, Instanced, BlueprintReadWrite, Category = "Save|Persistence")
 	TObjectPtr<class UInventorySaveRules> SaveRules;
+
+	// Explicit persistence ID. Takes precedence over the ID SaveRules derive from the owner.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Save|Persistence")
+	FString SaveID;
+
+	// Whether SaveRules run on BeginPlay/EndPlay. Only the authority owns the saved state.
+	virtual bool ShouldAutoSave() const { return HasInventoryAuthority(); }
 	
 public:
 	
+	// Writing slots directly skips replication bookkeeping; call MarkSlotDirty afterwards.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, ReplicatedUsing=OnRep_InventoryItems)
 	TArray<TObjectPtr<UItemData>> InventoryItems;
 	
@@ -53,11 +145,23 @@ public:
 	UPROPERTY(BlueprintAssignable)
 	FOnInventoryEvent OnInventoryLoaded;
 
+	// Fired once a SaveInventory call's data has been stored (for disk saves: written by the background task).
 	UPROPERTY(BlueprintAssignable)
 	FOnInventoryEvent OnInventorySaved;
 
+	// Fired when the summaries of paged-out slot ranges changed.
+	UPROPERTY(BlueprintAssignable, Category = "Inventory|Replication")
+	FOnInventoryEvent OnPageSummariesChanged;
+
+	// Fired on the predicting client when the server rejected a Request* call and its slots were rolled back.
+	UPROPERTY(BlueprintAssignable, Category = "Inventory|Prediction")
+	FOnInventoryEvent OnPredictionRejected;
+
 public:
 	
+	UInventoryComponent();
+	
+	virtual void PostInitProperties() override;
 	virtual void BeginPlay() override;
 	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 	
@@ -68,6 +172,76 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Inventory")
 	int32 GetMaxItemSlots() const { return MaxItemSlots; }
 
+	// Persistence ID used by SaveInventory/LoadInventory: SaveID if set, otherwise the one SaveRules resolve.
+	UFUNCTION(BlueprintPure, Category = "Save|Persistence")
+	virtual FString GetSaveID() const;
+
+	// Changing the ID makes the slots dirty for every save type, nothing has been saved under the new one.
+	UFUNCTION(BlueprintCallable, Category = "Save|Persistence")
+	void SetSaveID(const FString& NewSaveID);
+
+	/**
+	 * Saves the slots under GetSaveID(). Disk saves snapshot the slots now and serialize and write them on a background task.
+	 * Unless bForce, an inventory that did not change since it was last saved to or loaded from SaveType is skipped.
+	 * Returns false if there is nothing to save to (no ID or no game instance).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Save|Persistence")
+	bool SaveInventory(ESaveType SaveType, bool bForce = false);
+
+	// Whether the slots changed since they were last saved to or loaded from SaveType (including disk writes in flight).
+	UFUNCTION(BlueprintPure, Category = "Save|Persistence")
+	bool IsSaveDirty(ESaveType SaveType) const;
+
+	// Whether the subsystem's autosave and bulk save passes save this inventory to SaveType: its rules persist there
+	// and bEnableAutoSaveOnMapTransition is on. Inventories without rules are only in those passes if registered by hand.
+	bool IsSavedByPasses(ESaveType SaveType) const;
+
+	// Whether the SaveRules load this inventory from the disk on BeginPlay (Disk and Hybrid rules).
+	bool UsesDiskSaves() const;
+
+	// Called by every mutation, and by items changing in place. Only needed for changes made behind the component's back.
+	void MarkSaveDirty()
+	{
+		++SaveRevision;
+		if (DiskDirtySince == 0.0) DiskDirtySince = FPlatformTime::Seconds();
+	}
+
+	// When the oldest change not yet handed to a disk save was made (FPlatformTime::Seconds), 0 if there is none.
+	double GetDiskDirtySince() const { return DiskDirtySince; }
+
+	uint32 GetSaveRevision() const { return SaveRevision; }
+
+	// Called by held items changed in place through their setters.
+	void HandleItemInfoChanged(UItemData* Item);
+
+	// Called on clients by held items whose Info replicated. Kept aside while their slot is locked by a prediction.
+	void HandleReplicatedItemInfo(UItemData* Item);
+
+	// Called by the subsystem once a disk write carrying Revision finished.
+	void HandleDiskSaveFinished(uint32 Revision, bool bSuccess);
+
+	// Loads the slots saved under GetSaveID(), including disk saves still being written. Returns true if data was applied.
+	UFUNCTION(BlueprintCallable, Category = "Save|Persistence")
+	bool LoadInventory(ESaveType SaveType);
+
+	/**
+	 * Disk load for BeginPlay that never waits on the disk. Applies the data if it was prefetched or is still in memory.
+	 * Otherwise returns false and applies it once the background read finished, firing OnInventoryLoaded then; until
+	 * that happens the slots keep their defaults and are not saved, so they can't overwrite the save being read.
+	 */
+	bool LoadInventoryDeferred();
+
+	// Whether a deferred disk load is still reading.
+	UFUNCTION(BlueprintPure, Category = "Save|Persistence")
+	bool IsLoadPending() const { return bDeferredLoadPending; }
+
+	// Called by the subsystem when a deferred load finished, with null if nothing was saved under the ID.
+	void HandleDeferredLoad(const FItemSaveData* Data);
+
+	// Snapshot of the slots in save form, and the reverse.
+	FItemSaveData CreateSaveData() const;
+	void ApplySaveData(const FItemSaveData& Data);
+
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	void SetMaxItemSlots(int32 NewMaxSlots);
 
@@ -89,6 +263,10 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Inventory", meta = (ReturnDisplayName = "Item Index"))
 	virtual int32 FindItemIndex(UItemData* Item);
 	
+	// Returns the slot indexes of items carrying a fragment of the given type. Items without it are skipped.
+	UFUNCTION(BlueprintPure, Category = "Inventory", meta = (ReturnDisplayName = "Item Indexes"))
+	TArray<int32> FindItemsWithFragment(const UScriptStruct* FragmentType) const;
+	
 	UFUNCTION(BlueprintPure, Category = "Inventory", meta = (ReturnDisplayName = "Is Full?"))
 	virtual bool IsInventoryFull();
 	
@@ -138,15 +316,256 @@ public:
 
 // Multiplayer
 	UFUNCTION()
-	virtual void OnRep_InventoryItems()
-	{ OnInventoryRefresh.Broadcast(); }
+	virtual void OnRep_InventoryItems();
+	
+	UFUNCTION()
+	virtual void OnRep_MaxItemSlots();
+
+	UFUNCTION()
+	void OnRep_PageSummaries();
 
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+#if UE_WITH_IRIS
+	virtual void RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags) override;
+#endif
+	virtual void BeginReplication() override;
+	virtual void PreReplication(IRepChangedPropertyTracker& ChangedPropertyTracker) override;
+	
+	UFUNCTION(BlueprintPure, Category = "Inventory|Replication")
+	EInventoryReplicationMode GetReplicationMode() const { return ReplicationMode; }
+
+	UFUNCTION(BlueprintPure, Category = "Inventory|Replication")
+	EInventoryReplicationScope GetReplicationScope() const { return ReplicationScope; }
+
+	// Changes which clients receive this inventory. Call on the server.
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory|Replication")
+	void SetReplicationScope(EInventoryReplicationScope NewScope);
+
+	/**
+	 * Starts replicating this inventory to the viewer's connection while the scope is Viewers, e.g. when a chest is opened.
+	 * Clients keep the last state they received after RemoveViewer.
+	 */
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory|Replication")
+	void AddViewer(APlayerController* Viewer);
+
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory|Replication")
+	void RemoveViewer(APlayerController* Viewer);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory|Replication")
+	bool IsViewer(const APlayerController* Viewer) const;
+
+	/**
+	 * Tells the server which slots this client's UI shows, e.g. the page of a UInventoryTileView.
+	 * With bPagedReplication only those pages stream down, along with pages other viewers show. Pass NumSlots 0 when
+	 * the UI closes.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory|Replication")
+	void SetVisibleSlotRange(int32 FirstSlot, int32 NumSlots);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory|Replication")
+	int32 GetReplicationPageCount() const { return PageSummaries.Num(); }
+
+	// Rough size of this inventory's initial replication, used to budget the sync of joining players.
+	int32 EstimateInitialSyncBytes() const;
+
+	UFUNCTION(BlueprintPure, Category = "Inventory|Replication")
+	FInventoryPageSummary GetPageSummary(int32 PageIndex) const
+	{ return PageSummaries.IsValidIndex(PageIndex) ? PageSummaries[PageIndex] : FInventoryPageSummary(); }
+
+	// Turns dormancy management on or off. Turning it on sends the owning actor dormant right away. Call on the server.
+	UFUNCTION(BlueprintCallable, BlueprintAuthorityOnly, Category = "Inventory|Replication")
+	void SetManageNetDormancy(bool bManage);
+
+	// Switches how slots replicate. Call on the server, ideally before the first net update.
+	UFUNCTION(BlueprintCallable, Category = "Inventory|Replication")
+	void SetReplicationMode(EInventoryReplicationMode NewMode);
+
+	// Call after changing an item in place (e.g. through UItemData setters) so the slot replicates and listeners refresh.
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void MarkSlotDirty(int32 Index) { NotifySlotChanged(Index); }
+
+	// True if item objects replicate as subobjects of this component.
+	bool ReplicatesItemSubobjects() const { return ReplicationMode != EInventoryReplicationMode::SlotStructs; }
 	
 	UFUNCTION(BlueprintCallable, Category = "Inventory", meta = (DisplayName = "Add Item At Index"))
 	virtual bool AddItemAtIndex(UItemData* NewItem, int32 Index);
 
+// Prediction
+	/**
+	 * Request* calls are the multiplayer-safe way to modify an inventory from a client.
+	 * On the server they run directly. On a client they apply locally right away under a prediction key and are sent
+	 * to the server, which confirms or rejects them; rejected operations are rolled back.
+	 * The RPC goes through whichever involved inventory the local player owns; returns false if there is none.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory|Prediction")
+	bool RequestSwapItemSlots(int32 SourceIndex, int32 TargetIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory|Prediction")
+	bool RequestSplitStack(int32 SourceIndex, int32 TargetIndex, int32 Amount);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory|Prediction")
+	bool RequestTransferItemToSlot(UInventoryComponent* TargetComponent, int32 SourceIndex, int32 TargetIndex);
+
+	UFUNCTION(BlueprintCallable, Category = "Inventory|Prediction")
+	bool RequestDropItem(int32 SlotIndex);
+
+	/**
+	 * Runs an ordered batch of commands on this inventory, e.g. everything a shift-click or multi-select drag produced.
+	 * Clients predict the whole batch and send it in one RPC; the server answers once. Failed commands are skipped,
+	 * not fatal. Returns how many commands succeeded (locally, on clients).
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory|Prediction", meta = (ReturnDisplayName = "Succeeded"))
+	int32 RequestCommands(const TArray<FInventoryCommand>& Commands);
+
+	// Server-side check for Request* calls and visible ranges. By default only the owning player and registered viewers
+	// may modify the inventory, or any player with bAllowModificationByAnyPlayer.
+	UFUNCTION(BlueprintNativeEvent, Category = "Inventory|Prediction")
+	bool CanBeModifiedBy(const APlayerController* Player) const;
+	virtual bool CanBeModifiedBy_Implementation(const APlayerController* Player) const;
+
+	UFUNCTION(BlueprintPure, Category = "Inventory|Prediction")
+	bool HasPendingPredictions() const { return !PendingPredictions.IsEmpty(); }
+
+	// Round trip of the last prediction the server answered, in milliseconds.
+	UFUNCTION(BlueprintPure, Category = "Inventory|Prediction")
+	float GetLastPredictionRoundTripMs() const { return LastPredictionRoundTripMs; }
+
 protected:
+
+	UFUNCTION(Server, Reliable)
+	void Server_ExecuteCommands(const FInventoryCommandBatch& Batch);
+
+	UFUNCTION(Server, Reliable)
+	void Server_SetVisibleSlotRange(UInventoryComponent* Inventory, int32 FirstSlot, int32 NumSlots);
+
+	// Single answer per batch: bit i is set if command i succeeded on the server.
+	UFUNCTION(Client, Reliable)
+	void Client_AckCommands(int32 PredictionKey, uint64 SucceededMask);
+
+	// Runs one command with this inventory as the source. Shared by the server and client prediction.
+	bool ExecuteCommand(const FInventoryCommand& Command);
+
+	// Snapshots every slot the command may touch.
+	void AddPredictedCommandSlots(int32 PredictionKey, UInventoryComponent* Source, const FInventoryCommand& Command);
+
+	// Returns whichever of this and Other the local client owns, i.e. can send server RPCs through.
+	UInventoryComponent* FindPredictionRouter(UInventoryComponent* Other);
+
+	// The player controller owning this inventory's connection, if any.
+	const APlayerController* GetRequestingPlayer() const;
+
+	// Opens a prediction on this (router) inventory and returns its key.
+	int32 BeginPrediction();
+
+	// Snapshots and locks a slot for the prediction. Replicated updates to locked slots wait until it is resolved.
+	void AddPredictedSlot(int32 PredictionKey, UInventoryComponent* Inventory, int32 Index);
+
+	// Releases the prediction's slots, rolling them back first if it was rejected.
+	void ResolvePrediction(int32 PredictionKey, bool bAccepted, bool bFromServer = true);
+
+	void ReleasePredictedSlot(const FInventoryPredictedSlot& Snapshot, bool bRestore);
 	
 	virtual bool GenericTransferItem(UInventoryComponent* TargetComponent, int32 SourceIndex, int32 TargetIndex = -1);
+
+	// Single entry point after a slot changed: syncs replication state and fires OnItemUpdated.
+	void NotifySlotChanged(int32 Index);
+
+	// Entry point after the whole slot array was replaced or resized: syncs replication state and fires OnInventoryRefresh.
+	void NotifyInventoryRefreshed();
+
+	// Client side of ReplicatedSlots. Writes the replicated slot locally and fires OnItemUpdated.
+	void ApplyReplicatedSlot(int32 Index, UItemData* Item);
+
+	// Client side of SlotStructs: slots whose struct state arrived are rebuilt once per received bunch.
+	void QueueReplicatedSlotState(int32 Index) { PendingSlotStates.Add(Index); }
+	void FlushReplicatedSlotStates();
+
+	bool HasInventoryAuthority() const;
+
+	// Push-model: flags the replicated slot properties as changed.
+	void MarkSlotsReplicationDirty();
+
+	bool UsesPagedReplication() const { return bPagedReplication && ReplicationMode != EInventoryReplicationMode::FullArray; }
+
+	// Server side: whether the slot's contents currently replicate (always true without paging).
+	bool IsSlotStreamed(int32 Index) const;
+
+	// Rebuilds ReplicatedSlots from the streamed slots.
+	void RebuildReplicatedSlots();
+
+	// Records the pages a player looks at and updates what streams.
+	void SetPlayerVisibleRange(const APlayerController* Player, int32 FirstSlot, int32 NumSlots);
+	void UpdateStreamedPages();
+
+	void UpdatePageSummary(int32 Index);
+	void RebuildPageSummaries();
+	FInventoryPageSummary ComputePageSummary(int32 PageIndex) const;
+
+	// Keeps the registered subobject list in line with the items currently held (in streamed slots).
+	void UpdateItemSubobject(UItemData* Previous, UItemData* Current);
+	void UpdateAllItemSubobjects();
+
+private:
+
+	// Wakes the owning actor for replication and restarts the quiet period. No-op unless bManageNetDormancy.
+	void WakeNetDormancy();
+	void ReturnToNetDormancy();
+
+	// Auto resolved against the owning actor.
+	EInventoryReplicationScope ResolveReplicationScope() const;
+
+	// Applies the resolved scope as this component's net condition.
+	void ApplyReplicationScope();
+
+	// Net condition group holding this inventory while the scope is Viewers. Unique per component.
+	FName GetViewerGroup() const;
+
+	TArray<TWeakObjectPtr<APlayerController>> Viewers;
+
+	FTimerHandle NetDormancyTimer;
+
+	// Server: first/last visible page per player, and their union.
+	TMap<TWeakObjectPtr<const APlayerController>, FIntPoint> ViewerPageRanges;
+	TSet<int32> StreamedPages;
+
+	// Client: last range sent, to skip redundant RPCs.
+	FIntPoint SentVisibleRange = FIntPoint(INDEX_NONE, 0);
+
+	int32 NextPredictionKey = 1;
+	float LastPredictionRoundTripMs = 0.0f;
+
+	// Predictions this inventory routed to the server, by key.
+	UPROPERTY(Transient)
+	TMap<int32, FInventoryPrediction> PendingPredictions;
+
+	// Slots of this inventory locked by pending predictions (any router), with lock counts.
+	TMap<int32, int32> PredictedSlotLocks;
+
+	// Replicated slot contents that arrived while the slot was locked.
+	UPROPERTY(Transient)
+	TMap<int32, TObjectPtr<UItemData>> DeferredReplicatedSlots;
+
+	// Latest server Info of items in locked slots. Applied on release instead of the prediction snapshot.
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UItemData>, FItemStruct> DeferredReplicatedInfos;
+
+	TSet<int32> PendingSlotStates;
+
+	// Items currently registered as replicated subobjects of this component.
+	UPROPERTY(Transient)
+	TSet<TObjectPtr<UItemData>> RegisteredItems;
+
+	// Bumped by every change. A save type is clean while its saved revision matches.
+	uint32 SaveRevision = 1;
+	uint32 SavedRevisions[2] = { 0, 0 };
+
+	// Saved revision of the Database rules' storage, kept apart from the disk so disk saves can't stand in for it.
+	uint32 StorageSavedRevision = 0;
+
+	// Revision of the newest disk write not finished yet, 0 if none.
+	uint32 PendingDiskRevision = 0;
+
+	bool bDeferredLoadPending = false;
+
+	double DiskDirtySince = 0.0;
 };
@@ -17,11 +17,10 @@ class DFINVENTORY_API UMPInventoryComponent : public UInventoryComponent
 public:
 	UMPInventoryComponent();
 
-	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
-	virtual bool ReplicateSubobjects(UActorChannel* Channel, FOutBunch* Bunch, FReplicationFlags* RepFlags) override;
-
 protected:
 
 	virtual bool ShouldAutoSave() const override;
+
+public:
 	virtual FString GetSaveID() const override;
 };
@@ -9,6 +9,8 @@
 
 #include "ItemData.generated.h"
 
+class UInventoryComponent;
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnItemDataChanged);
 
 UCLASS(BlueprintType)
@@ -23,13 +25,18 @@ protected:
 	
 	virtual bool IsSupportedForNetworking() const override { return true; }
 	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+#if UE_WITH_IRIS
+	virtual void RegisterReplicationFragments(UE::Net::FFragmentRegistrationContext& Context, UE::Net::EFragmentRegistrationFlags RegistrationFlags) override;
+#endif
 	
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, ReplicatedUsing=OnRep_Info, BlueprintSetter=SetInfo, Category="Info", meta=(ShowOnlyInnerProperties))
 	FItemStruct Info {};
 	
 	UFUNCTION()
-	void OnRep_Info()
-	{ OnDataChanged.Broadcast(); }
+	void OnRep_Info();
+
+	// Marks Info dirty for push-model replication and notifies listeners. Every Info setter goes through here.
+	void NotifyInfoChanged();
 	
 public:
 
@@ -46,6 +53,9 @@ public:
 	UFUNCTION(BlueprintCallable)
 	virtual FItemStruct GetItemInfo() { return Info; }
 	
+	// Read-only access to Info without the copy GetItemInfo makes.
+	const FItemStruct& GetInfoRef() const { return Info; }
+	
 	UFUNCTION(BlueprintCallable)
 	FInstancedStruct GetExtraInfo() const { return Info.ExtraInfo; }
 	
@@ -57,6 +67,23 @@ public:
 	
 	UFUNCTION(BlueprintCallable)
 	int SetItemAmount(int NewValue);
+
+	UFUNCTION(BlueprintCallable, Category = "Item Data|Fragments")
+	bool HasFragment(const UScriptStruct* FragmentType) const { return Info.HasFragment(FragmentType); }
+
+	// Copies the fragment of the given type into OutFragment. Returns false if the item does not carry it.
+	UFUNCTION(BlueprintCallable, Category = "Item Data|Fragments")
+	bool GetFragment(const UScriptStruct* FragmentType, FInstancedStruct& OutFragment) const;
+
+	// Adds the fragment or replaces the existing one of the same type.
+	UFUNCTION(BlueprintCallable, Category = "Item Data|Fragments")
+	void SetFragment(const FInstancedStruct& NewFragment);
+
+	UFUNCTION(BlueprintCallable, Category = "Item Data|Fragments")
+	bool RemoveFragment(const UScriptStruct* FragmentType);
+
+	template <typename TFragment>
+	const TFragment* GetFragment() const { return Info.GetFragment<TFragment>(); }
 	
 	UFUNCTION(BlueprintCallable)
 	bool ItemSlotsAvailable() { return Info.Amount != Info.MaxAmount; }
@@ -64,6 +91,10 @@ public:
 	UFUNCTION(BlueprintCallable)
 	UItemData* GetParentItem() const { return Info.ParentItem; }
 
+	// Inventory whose slot last took this item, whatever its outer. Info changes mark that inventory dirty.
+	UInventoryComponent* GetOwningInventory() const { return OwningInventory.Get(); }
+	void SetOwningInventory(UInventoryComponent* Inventory) { OwningInventory = Inventory; }
+
 	UFUNCTION(BlueprintCallable)
 	UTexture2D* GetIcon() const { return Info.Icon; }
 
@@ -90,4 +121,7 @@ public:
 
 	UFUNCTION(BlueprintCallable)
 	void SetMaxAmount(int32 NewMaxAmount);
+
+private:
+	TWeakObjectPtr<UInventoryComponent> OwningInventory;
 };
@@ -6,6 +6,7 @@
 
 class UInventoryComponent;
 enum class EEndPlayReason : uint8;
+enum class ESaveType : uint8;
 
 /**
  * Defines how and when an Inventory Component saves its data.
@@ -25,11 +26,17 @@ public:
 	virtual bool HandleBeginPlay(UInventoryComponent* Inventory);
 
 	// Called when the Component Ends Play.
-	virtual void HandleEndPlay(UInventoryComponent* Inventory, const ELinkTo* EndPlayReason_Obsolete = nullptr); 
-
-	// Helper to reduce boilerplate in subclasses. Note: Component must implement SaveInventory/LoadInventory.
 	virtual void HandleEndPlay_Explicit(UInventoryComponent* Inventory, EEndPlayReason::Type Reason);
 
+	// Called on the authority after a slot changed, once the component began play.
+	virtual void HandleSlotChanged(UInventoryComponent* Inventory, int32 Index) {}
+
+	// Called on the authority after the slots were rebuilt as a whole (reset, resize, load), once the component began play.
+	virtual void HandleInventoryRefreshed(UInventoryComponent* Inventory) {}
+
+	// Whether these rules keep the inventory in SaveType. The subsystem's autosave and bulk saves only cover those.
+	virtual bool PersistsTo(ESaveType SaveType) const { return false; }
+
 	/**
 	 * Generates a unique Save ID for the inventory.
 	 * Default implementation tries to use PlayerController ID (if owner is pawn) or Owner Name.
@@ -40,7 +47,7 @@ public:
 	virtual FString GetSaveID_Implementation(UInventoryComponent* Inventory);
 
 public:
-	// Class to use for Disk Saving. Defaults to UInventorySaveGame.
+	// Class to use for Disk Saving. Must derive from UInventorySaveGame; defaults to it.
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Rules|Disk")
 	TSubclassOf<class USaveGame> SaveGameClass;
 
@@ -55,6 +62,10 @@ protected:
 	// Internal Data Helpers (Moved from Component)
 	struct FItemSaveData CreateSaveData(UInventoryComponent* Inventory);
 	void ApplySaveData(UInventoryComponent* Inventory, const struct FItemSaveData& Data);
+
+	// For rules persisting to the subsystem's storage: whether the slots changed since they were stored there.
+	bool IsStorageDirty(const UInventoryComponent* Inventory) const;
+	void MarkSavedToStorage(UInventoryComponent* Inventory);
 };
 
 // =================================================================================================
@@ -72,6 +83,7 @@ class DFINVENTORY_API UInventorySaveRules_Hybrid : public UInventorySaveRules
 public:
 	virtual bool HandleBeginPlay(UInventoryComponent* Inventory) override;
 	virtual void HandleEndPlay_Explicit(UInventoryComponent* Inventory, EEndPlayReason::Type Reason) override;
+	virtual bool PersistsTo(ESaveType SaveType) const override { return true; }
 };
 
 /**
@@ -86,6 +98,7 @@ class DFINVENTORY_API UInventorySaveRules_Disk : public UInventorySaveRules
 public:
 	virtual bool HandleBeginPlay(UInventoryComponent* Inventory) override;
 	virtual void HandleEndPlay_Explicit(UInventoryComponent* Inventory, EEndPlayReason::Type Reason) override;
+	virtual bool PersistsTo(ESaveType SaveType) const override;
 };
 
 /**
@@ -101,4 +114,47 @@ class DFINVENTORY_API UInventorySaveRules_Memory : public UInventorySaveRules
 public:
 	virtual bool HandleBeginPlay(UInventoryComponent* Inventory) override;
 	virtual void HandleEndPlay_Explicit(UInventoryComponent* Inventory, EEndPlayReason::Type Reason) override;
+	virtual bool PersistsTo(ESaveType SaveType) const override;
+};
+
+/**
+ * JOURNAL:
+ * - Appends every change to the subsystem's journal as it happens (see FInventoryJournal).
+ * - A crash loses at most the last commit interval; nothing is written on EndPlay.
+ * - Loads from the journal.
+ * - Useful for persistent servers.
+ */
+UCLASS(DisplayName = "Journal (Crash Safe)")
+class DFINVENTORY_API UInventorySaveRules_Journal : public UInventorySaveRules
+{
+	GENERATED_BODY()
+public:
+	virtual bool HandleBeginPlay(UInventoryComponent* Inventory) override;
+	virtual void HandleSlotChanged(UInventoryComponent* Inventory, int32 Index) override;
+	virtual void HandleInventoryRefreshed(UInventoryComponent* Inventory) override;
+
+private:
+	static class FInventoryJournal* GetJournal(UInventoryComponent* Inventory);
+
+	// Set while applying loaded data, which must not be journaled again.
+	bool bApplying = false;
+};
+
+/**
+ * DATABASE:
+ * - Saves to the subsystem's storage backend on EndPlay (a local SQLite database unless replaced, see IInventoryStorage),
+ *   if the inventory changed since it was loaded or saved and bEnableAutoSaveOnMapTransition is on.
+ * - Writes of a frame are committed together in one transaction; loads are point reads by SaveID.
+ * - Useful for dedicated servers holding many persistent inventories.
+ */
+UCLASS(DisplayName = "Database (Server)")
+class DFINVENTORY_API UInventorySaveRules_Database : public UInventorySaveRules
+{
+	GENERATED_BODY()
+public:
+	virtual bool HandleBeginPlay(UInventoryComponent* Inventory) override;
+	virtual void HandleEndPlay_Explicit(UInventoryComponent* Inventory, EEndPlayReason::Type Reason) override;
+
+private:
+	static class UDFInventorySubsystem* GetSubsystem(UInventoryComponent* Inventory);
 };
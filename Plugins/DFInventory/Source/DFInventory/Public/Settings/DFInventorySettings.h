@@ -19,6 +19,35 @@ enum class EGenerationOptions : uint8
 	Never
 };
 
+UENUM(BlueprintType)
+enum class EInventorySaveFormat : uint8
+{
+	/** Tagged USaveGame serialization. Larger and slower, but survives any change to the item structs. */
+	SaveGame,
+	/** Compact versioned binary format (see InventorySaveFormat.h). Only used when the save class is UInventorySaveGame itself. */
+	Binary
+};
+
+UENUM(BlueprintType)
+enum class EInventorySaveCompression : uint8
+{
+	None,
+	/** Widely compatible, slower to decompress. */
+	Zlib,
+	/** Engine default codec; fast to decompress. */
+	Oodle
+};
+
+UENUM(BlueprintType)
+enum class EInventoryCompressionLevel : uint8
+{
+	/** Favor compression speed (e.g. frequent autosaves). */
+	Fast,
+	Normal,
+	/** Favor size (e.g. saves uploaded to a backend). */
+	Smallest
+};
+
 UCLASS(config=Plugins, defaultconfig, meta=(DisplayName="Demon Forge"))
 class DFINVENTORY_API UDFInventorySettings : public UDeveloperSettings
 {
@@ -31,7 +60,10 @@ public:
 	virtual FText GetSectionText() const override { return NSLOCTEXT("DemonForge", "DFInventorySettingsSection", "Demon Forge"); }
 #endif
 
-	/** Soft reference to the ExtraInfo struct type to use for all items. */
+	/**
+	 * Soft reference to the ExtraInfo struct type to use for all items.
+	 * Every item carries this struct, so prefer per-item Fragments for data only some items need.
+	 */
 	UPROPERTY(EditAnywhere, Config, Category="General", meta=(AllowedTypes="ScriptStruct"))
 	TSoftObjectPtr<UScriptStruct> ExtraInfo;
 
@@ -55,6 +87,86 @@ public:
 	UPROPERTY(EditAnywhere, Config, Category="Persistence")
 	bool bEnableAutoSaveOnMapTransition = false;
 
+	/** Format of inventory disk saves. Either format can be loaded regardless of this setting. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence")
+	EInventorySaveFormat SaveFormat = EInventorySaveFormat::Binary;
+
+	/** Compression of inventory disk saves (slots and world file entries). Compressed and plain saves both load regardless. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence")
+	EInventorySaveCompression SaveCompression = EInventorySaveCompression::None;
+
+	UPROPERTY(EditAnywhere, Config, Category="Persistence", meta=(EditCondition="SaveCompression != EInventorySaveCompression::None"))
+	EInventoryCompressionLevel SaveCompressionLevel = EInventoryCompressionLevel::Normal;
+
+	/**
+	 * If true, disk saves of all inventories share one indexed world file instead of a slot per SaveID.
+	 * Inventories saved with a custom SaveGameClass keep their own slot.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence")
+	bool bUseWorldSaveFile = false;
+
+	/** Name of the world file in Saved/SaveGames. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence", meta=(EditCondition="bUseWorldSaveFile"))
+	FString WorldSaveName = TEXT("Inventories");
+
+	/** Seconds between autosave passes over the inventories that changed. 0 turns autosaving off. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence|AutoSave", meta=(ClampMin=0, Units="Seconds"))
+	float AutoSaveInterval = 0.0f;
+
+	/**
+	 * Game thread time an autosave pass may spend per frame, snapshotting the inventories changed longest ago first.
+	 * At least one inventory is saved per frame, so a pass always finishes.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence|AutoSave", meta=(ClampMin=1, Units="Microseconds"))
+	int32 AutoSaveFrameBudget = 500;
+
+	/** Slot files written at the same time when many inventories save at once. Serialization is not limited by this. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence", meta=(ClampMin=1, ClampMax=32))
+	int32 MaxConcurrentSaveWrites = 4;
+
+	/**
+	 * Memory held by inventories stored in the game instance between maps (Memory and Hybrid save rules).
+	 * Beyond it, the least recently stored ones move to a spill file in Saved and are read back when loaded. 0 disables the limit.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence", meta=(ClampMin=0, Units="Megabytes"))
+	int32 MemoryStoreBudget = 64;
+
+	/** Base name of the journal files in Saved/SaveGames, used by the Journal save rules. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence|Journal")
+	FString JournalName = TEXT("InventoryJournal");
+
+	/** How long journal records accumulate before they are written and flushed together. Bounds what a crash can lose. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence|Journal", meta=(ClampMin=0.001, Units="Seconds"))
+	float JournalCommitInterval = 0.05f;
+
+	/** Log size that folds the journal into a new snapshot. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence|Journal", meta=(ClampMin=1, Units="Megabytes"))
+	int32 JournalCompactionSize = 16;
+
+	/** Name of the SQLite database in Saved/SaveGames, used by the Database save rules unless a custom storage is set. */
+	UPROPERTY(EditAnywhere, Config, Category="Persistence|Database")
+	FString StorageDatabaseName = TEXT("Inventories");
+
+	/**
+	 * If true, joining players receive world inventories through a budget instead of all at once:
+	 * their own first, then containers they opened or stand near, then the rest.
+	 * Only affects inventories replicating to everyone.
+	 */
+	UPROPERTY(EditAnywhere, Config, Category="Replication")
+	bool bBudgetInitialSync = false;
+
+	/** Bandwidth a joining player's initial inventory sync may use. */
+	UPROPERTY(EditAnywhere, Config, Category="Replication", meta=(EditCondition="bBudgetInitialSync", ClampMin=1024, Units="Bytes"))
+	int32 InitialSyncBytesPerSecond = 32768;
+
+	/** Containers within this distance of a joining player are sent before the rest. */
+	UPROPERTY(EditAnywhere, Config, Category="Replication", meta=(EditCondition="bBudgetInitialSync", Units="Centimeters"))
+	float InitialSyncNearbyDistance = 3000.0f;
+
+	/** Estimated initial replication size of one item, including its subobject. */
+	UPROPERTY(EditAnywhere, Config, Category="Replication", meta=(EditCondition="bBudgetInitialSync", ClampMin=1, Units="Bytes"))
+	int32 InitialSyncBytesPerItem = 48;
+
 	/** Ensures DefaultExtraInfo is initialized to the struct pointed to by ExtraInfoStruct. */
 	void EnsureExtraInfoValid();
 };
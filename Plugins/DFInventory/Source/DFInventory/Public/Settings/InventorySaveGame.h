@@ -4,10 +4,9 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/SaveGame.h"
+#include "Struct/ItemInfo.h"
 #include "InventorySaveGame.generated.h"
 
-struct FItemStruct;
-
 USTRUCT(BlueprintType)
 struct DFINVENTORY_API FItemSaveData
 {
@@ -16,6 +15,10 @@ struct DFINVENTORY_API FItemSaveData
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	TArray<FItemStruct> Items;
 
+	// Slot of each entry in Items. Empty for data saved one entry per slot.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	TArray<int32> SlotIndexes;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int32 MaxSlots = 0;
 };
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "InventoryCommands.generated.h"
+
+class UInventoryComponent;
+
+UENUM(BlueprintType)
+enum class EInventoryCommandType : uint8
+{
+	// SwapItemSlots within the source inventory (stacks onto a matching item).
+	Move,
+	// SplitStack within the source inventory.
+	Split,
+	// TransferItemToSlot into TargetInventory.
+	Transfer,
+	// RemoveItemFromInventory on the source slot.
+	Drop
+};
+
+// One inventory operation, as queued by a UI gesture. The source inventory is the one the batch is requested on.
+USTRUCT(BlueprintType)
+struct DFINVENTORY_API FInventoryCommand
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory|Command")
+	EInventoryCommandType Type = EInventoryCommandType::Move;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory|Command")
+	int32 SourceIndex = INDEX_NONE;
+
+	// Unused by Drop. Transfer accepts -1 to stack anywhere in the target.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory|Command")
+	int32 TargetIndex = INDEX_NONE;
+
+	// Split only.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory|Command")
+	int32 Amount = 0;
+
+	// Transfer only.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Inventory|Command")
+	TObjectPtr<UInventoryComponent> TargetInventory;
+};
+
+/**
+ * Ordered commands sent to the server in a single RPC.
+ * Serialized as packed slot indexes and amounts, with each target inventory referenced once.
+ */
+USTRUCT()
+struct DFINVENTORY_API FInventoryCommandBatch
+{
+	GENERATED_BODY()
+
+	// Upper bound per batch; also the width of the success mask the server answers with.
+	static constexpr int32 MaxCommands = 64;
+
+	UPROPERTY()
+	TObjectPtr<UInventoryComponent> Source;
+
+	UPROPERTY()
+	int32 PredictionKey = 0;
+
+	UPROPERTY()
+	TArray<FInventoryCommand> Commands;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventoryCommandBatch> : public TStructOpsTypeTraitsBase2<FInventoryCommandBatch>
+{
+	enum { WithNetSerializer = true };
+};
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+
+/**
+ * Process-wide cost of applying replicated inventory state on clients, read by the benchmarks.
+ * Every replication callback entry point (OnReps and fast array callbacks) is timed once, so nested work is not counted twice.
+ * Game thread only.
+ */
+struct DFINVENTORY_API FInventoryNetStats
+{
+	uint64 ClientRepCycles = 0;
+	uint32 ClientRepCalls = 0;
+
+	static FInventoryNetStats& Get();
+
+	void Reset() { *this = FInventoryNetStats(); }
+
+	double GetClientRepMs() const { return FPlatformTime::ToMilliseconds64(ClientRepCycles); }
+};
+
+// Times a client replication callback into FInventoryNetStats.
+struct FInventoryClientRepScope
+{
+	FInventoryClientRepScope() : StartCycles(FPlatformTime::Cycles64()) {}
+	~FInventoryClientRepScope()
+	{
+		FInventoryNetStats& Stats = FInventoryNetStats::Get();
+		Stats.ClientRepCycles += FPlatformTime::Cycles64() - StartCycles;
+		++Stats.ClientRepCalls;
+	}
+
+private:
+	uint64 StartCycles;
+};
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Struct/ItemInfo.h"
+#include "InventoryPrediction.generated.h"
+
+class UItemData;
+class UInventoryComponent;
+
+// Client-side record of one slot touched by a predicted operation, used to roll it back.
+USTRUCT()
+struct DFINVENTORY_API FInventoryPredictedSlot
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TWeakObjectPtr<UInventoryComponent> Inventory;
+
+	UPROPERTY()
+	int32 SlotIndex = INDEX_NONE;
+
+	// Slot contents before the prediction.
+	UPROPERTY()
+	TObjectPtr<UItemData> Item;
+
+	// Item info before the prediction, since stacking changes amounts in place.
+	UPROPERTY()
+	FItemStruct Info;
+};
+
+// A predicted command batch waiting for the server to confirm or reject it.
+USTRUCT()
+struct DFINVENTORY_API FInventoryPrediction
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FInventoryPredictedSlot> Slots;
+
+	// Commands that succeeded locally, compared against the server's answer.
+	uint64 PredictedMask = 0;
+
+	double StartTime = 0.0;
+};
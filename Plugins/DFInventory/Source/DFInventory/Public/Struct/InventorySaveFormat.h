@@ -0,0 +1,61 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FItemSaveData;
+struct FItemStruct;
+enum class EInventorySaveCompression : uint8;
+enum class EInventoryCompressionLevel : uint8;
+
+/**
+ * Purpose-built binary form of FItemSaveData, used for disk saves instead of tagged USaveGame serialization.
+ *
+ * Header: magic, version, flags, payload size and CRC. Payload: max slots, a table of definition paths, a table of
+ * item kinds, then one record per occupied slot in ascending order.
+ * A kind is a definition index plus the fields that differ from that definition, stored once however many stacks
+ * share it. A slot record only holds a packed slot delta, its kind, a ZigZag amount and, if it has its own, ExtraInfo.
+ * ExtraInfo and fragments are length-prefixed opaque blobs, so a reader can skip them without knowing their types.
+ * Version 1 payloads (fields per slot, no kind table) still load.
+ */
+namespace InventorySaveFormat
+{
+	constexpr uint32 Magic = 0x56494644; // "DFIV"
+	
+	enum class EVersion : uint16
+	{
+		Initial = 1,
+		ItemKinds = 2,
+		
+		LatestPlusOne,
+		Latest = LatestPlusOne - 1
+	};
+	
+	// Whether the bytes start with a binary inventory header (as opposed to a USaveGame file).
+	DFINVENTORY_API bool IsBinary(TConstArrayView<uint8> Bytes);
+	
+	DFINVENTORY_API void Write(const FItemSaveData& Data, TArray<uint8>& OutBytes);
+	
+	// Fails on foreign, newer or corrupt data and leaves OutData untouched then.
+	DFINVENTORY_API bool Read(TConstArrayView<uint8> Bytes, FItemSaveData& OutData);
+	
+	// Compression applied to whole save files, captured on the game thread and applied by the writers.
+	struct FCompressionOptions
+	{
+		EInventorySaveCompression Codec{};
+		EInventoryCompressionLevel Level{};
+		
+		DFINVENTORY_API static FCompressionOptions FromSettings();
+	};
+	
+	// Wraps Bytes in a compressed container (magic, codec, uncompressed size), unless that would not make them smaller.
+	DFINVENTORY_API void Compress(TArray<uint8>& Bytes, const FCompressionOptions& Options);
+	
+	// Unwraps a compressed container in place and leaves anything else alone. False if the container is corrupt.
+	DFINVENTORY_API bool Decompress(TArray<uint8>& Bytes);
+	
+	DFINVENTORY_API bool IsCompressed(TConstArrayView<uint8> Bytes);
+	
+	// A single item record with its definition path inline, for stores that keep items apart (e.g. the journal).
+	DFINVENTORY_API void WriteItem(FArchive& Ar, const FItemStruct& Info);
+	DFINVENTORY_API bool ReadItem(FArchive& Ar, FItemStruct& OutInfo);
+}
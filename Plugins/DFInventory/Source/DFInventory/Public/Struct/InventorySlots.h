@@ -0,0 +1,145 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "StructUtils/InstancedStruct.h"
+#include "Struct/ItemInfo.h"
+#include "InventorySlots.generated.h"
+
+class UItemData;
+class UInventoryComponent;
+struct FInventorySlotArray;
+
+// Per-instance data that differs from the item definition, sent instead of a UItemData subobject.
+USTRUCT()
+struct DFINVENTORY_API FItemInstancePayload
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FInstancedStruct ExtraInfo;
+
+	UPROPERTY()
+	TArray<FInstancedStruct> Fragments;
+};
+
+/**
+ * Slot index and amount of a slot entry, packed as varints on the wire.
+ * Has a NetSerialize for the generic replication system and a matching Iris NetSerializer.
+ */
+USTRUCT()
+struct DFINVENTORY_API FInventorySlotHeader
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	int32 SlotIndex = INDEX_NONE;
+
+	// SlotStructs only.
+	UPROPERTY()
+	int32 Amount = 0;
+
+	bool NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventorySlotHeader> : public TStructOpsTypeTraitsBase2<FInventorySlotHeader>
+{
+	enum { WithNetSerializer = true };
+};
+
+// A single occupied inventory slot. Empty slots have no entry, so clearing a slot replicates as a removal.
+USTRUCT()
+struct DFINVENTORY_API FInventorySlotEntry : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FInventorySlotHeader Header;
+
+	// Replicated item subobject. Null in EInventoryReplicationMode::SlotStructs.
+	UPROPERTY()
+	TObjectPtr<UItemData> Item;
+
+	// SlotStructs only: the item definition (ParentItem data asset), which clients resolve by path.
+	UPROPERTY()
+	TObjectPtr<UItemData> Definition;
+
+	/**
+	 * SlotStructs only. Empty while the instance matches its definition.
+	 * Holds FItemInstancePayload when only ExtraInfo/Fragments differ, or a full FItemStruct otherwise.
+	 */
+	UPROPERTY()
+	FInstancedStruct Payload;
+
+	// Captures SourceItem as compact state. Returns true if the state changed.
+	bool CaptureState(UItemData* SourceItem);
+
+	// Rebuilds the full item info from the definition plus the replicated state.
+	FItemStruct ResolveInfo() const;
+
+	bool HasStructState() const { return Definition != nullptr || Payload.IsValid(); }
+
+	void PreReplicatedRemove(const FInventorySlotArray& InArraySerializer);
+	void PostReplicatedAdd(const FInventorySlotArray& InArraySerializer);
+	void PostReplicatedChange(const FInventorySlotArray& InArraySerializer);
+};
+
+// Replicated in place of slot contents for pages no client is looking at.
+USTRUCT(BlueprintType)
+struct DFINVENTORY_API FInventoryPageSummary
+{
+	GENERATED_BODY()
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	int32 OccupiedSlots = 0;
+
+	UPROPERTY(BlueprintReadOnly, Category = "Inventory")
+	int32 TotalAmount = 0;
+
+	bool operator==(const FInventoryPageSummary& Other) const
+	{ return OccupiedSlots == Other.OccupiedSlots && TotalAmount == Other.TotalAmount; }
+};
+
+/**
+ * Delta-replicated mirror of UInventoryComponent::InventoryItems.
+ * The server keeps it in sync per slot; clients apply each add/change/remove back onto the owning inventory.
+ */
+USTRUCT()
+struct DFINVENTORY_API FInventorySlotArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FInventorySlotEntry> Slots;
+
+	// Inventory that receives the client-side callbacks. Bound by the component itself, never copied or saved.
+	UPROPERTY(Transient, NotReplicated)
+	TObjectPtr<UInventoryComponent> Owner;
+
+	// Mirrors a single slot. Only marks the array dirty, and returns true, if the slot actually changed.
+	bool SetSlot(int32 SlotIndex, UItemData* Item);
+
+	// Rebuilds every entry from the given slots.
+	void Rebuild(const TArray<TObjectPtr<UItemData>>& Items);
+
+	// Same, but slots rejected by ShouldInclude get no entry (paged replication).
+	void Rebuild(const TArray<TObjectPtr<UItemData>>& Items, TFunctionRef<bool(int32)> ShouldInclude);
+
+	void PostReplicatedReceive(const FFastArraySerializer::FPostReplicatedReceiveParameters& Parameters);
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+	{ return FFastArraySerializer::FastArrayDeltaSerialize<FInventorySlotEntry, FInventorySlotArray>(Slots, DeltaParms, *this); }
+
+	int32 FindEntryIndex(int32 SlotIndex) const;
+
+private:
+
+	bool CaptureEntry(FInventorySlotEntry& Entry, UItemData* Item);
+};
+
+template<>
+struct TStructOpsTypeTraits<FInventorySlotArray> : public TStructOpsTypeTraitsBase2<FInventorySlotArray>
+{
+	enum { WithNetDeltaSerializer = true };
+};
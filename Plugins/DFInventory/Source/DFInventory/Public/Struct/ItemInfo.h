@@ -33,6 +33,22 @@ struct DFINVENTORY_API FItemStruct {
   UPROPERTY(EditAnywhere, BlueprintReadWrite, SaveGame, Category = "Info")
   FInstancedStruct ExtraInfo;
 
+  // Composable payloads keyed by struct type, at most one per type. Unlike
+  // ExtraInfo, only the items that need a fragment carry it.
+  UPROPERTY(EditAnywhere, BlueprintReadWrite, SaveGame, Category = "Info",
+            meta = (BaseStruct = "/Script/DFInventory.ItemExtraInfo", ExcludeBaseStruct))
+  TArray<FInstancedStruct> Fragments;
+
+  // Compact network form: the definition (ParentItem) reference, a packed
+  // amount and only the fields that differ from the definition. Clients
+  // rebuild the rest from their own copy of the definition.
+  bool NetSerialize(FArchive &Ar, UPackageMap *Map, bool &bOutSuccess);
+
+  // Same wire format, but never uses ParentItem as the baseline, so every
+  // field that differs from a default item is sent. Only useful to compare
+  // against the compact form.
+  bool NetSerializeWithoutDefinition(FArchive &Ar, UPackageMap *Map, bool &bOutSuccess);
+
   template <typename TExtra> TExtra *GetExtraInfoMutable() {
     return ExtraInfo.GetMutablePtr<TExtra>();
   }
@@ -41,6 +57,51 @@ struct DFINVENTORY_API FItemStruct {
     return ExtraInfo.GetPtr<TExtra>();
   }
 
+  // Items hold a handful of fragments at most, so a linear scan on the type
+  // pointer beats any hashed lookup here.
+  const FInstancedStruct *FindFragment(const UScriptStruct *FragmentType) const {
+    if (!FragmentType) return nullptr;
+    return Fragments.FindByPredicate([FragmentType](const FInstancedStruct &Fragment)
+        { return Fragment.GetScriptStruct() == FragmentType; });
+  }
+
+  FInstancedStruct *FindFragmentMutable(const UScriptStruct *FragmentType) {
+    return const_cast<FInstancedStruct *>(FindFragment(FragmentType));
+  }
+
+  bool HasFragment(const UScriptStruct *FragmentType) const {
+    return FindFragment(FragmentType) != nullptr;
+  }
+
+  template <typename TFragment> bool HasFragment() const {
+    return HasFragment(TFragment::StaticStruct());
+  }
+
+  template <typename TFragment> const TFragment *GetFragment() const {
+    const FInstancedStruct *Found = FindFragment(TFragment::StaticStruct());
+    return Found ? Found->GetPtr<TFragment>() : nullptr;
+  }
+
+  template <typename TFragment> TFragment *GetFragmentMutable() {
+    FInstancedStruct *Found = FindFragmentMutable(TFragment::StaticStruct());
+    return Found ? Found->GetMutablePtr<TFragment>() : nullptr;
+  }
+
+  // Adds the fragment, replacing any existing fragment of the same type.
+  void SetFragment(const FInstancedStruct &Fragment) {
+    if (!Fragment.IsValid()) return;
+    if (FInstancedStruct *Existing = FindFragmentMutable(Fragment.GetScriptStruct())) {
+      *Existing = Fragment;
+      return;
+    }
+    Fragments.Add(Fragment);
+  }
+
+  bool RemoveFragment(const UScriptStruct *FragmentType) {
+    return Fragments.RemoveAll([FragmentType](const FInstancedStruct &Fragment)
+        { return Fragment.GetScriptStruct() == FragmentType; }) > 0;
+  }
+
   UItemData *GetParentItem() { return ParentItem; }
 
   int32 GetItemAmount() { return Amount; }
@@ -61,8 +122,12 @@ struct DFINVENTORY_API FItemStruct {
   }
 };
 
-// Base payload for ExtraInfo. Hidden from the picker but not abstract so users
-// can create derived structs.
+template <> struct TStructOpsTypeTraits<FItemStruct> : public TStructOpsTypeTraitsBase2<FItemStruct> {
+  enum { WithNetSerializer = true };
+};
+
+// Base payload for ExtraInfo and item Fragments. Hidden from the picker but not
+// abstract so users can create derived structs.
 USTRUCT(BlueprintType, meta = (Hidden, BlueprintInternalUseOnly = "true"))
 struct DFINVENTORY_API FItemExtraInfo {
   GENERATED_BODY()
@@ -2,10 +2,85 @@
 
 #include "CoreMinimal.h"
 #include "Settings/InventorySaveGame.h"
+#include "Component/InventoryComponent.h"
+#include "Subsystem/InventoryJournal.h"
+#include "Subsystem/InventoryMemoryStore.h"
+#include "Subsystem/InventoryStorage.h"
+#include "Struct/InventorySaveFormat.h"
+#include "Containers/Ticker.h"
 #include "Subsystems/GameInstanceSubsystem.h"
+#include "Tasks/Pipe.h"
+#include "Tasks/Task.h"
 #include "DFInventorySubsystem.generated.h"
 
-// Subsystem to handle inventory persistence across map transitions.
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnInventoryDataSaved, const FString&, SaveID, bool, bSuccess);
+
+class ULevel;
+class ULevelStreaming;
+enum class ELevelStreamingState : uint8;
+struct FWorldContext;
+
+// Cost of one inventory's disk save. Serializing the SaveGame format is measured on the game thread, the rest on workers.
+struct FInventorySaveCost
+{
+	uint64 SerializeCycles = 0;
+	uint64 WriteCycles = 0;
+	int64 Bytes = 0;
+};
+
+// Report of one UDFInventorySubsystem::SaveAllDirtyInventories pass to disk.
+struct FInventoryBulkSaveStats
+{
+	int32 NumInventories = 0;
+	int32 NumFailed = 0;
+	int64 Bytes = 0;
+
+	// Snapshotting on the game thread.
+	double SnapshotSeconds = 0.0;
+
+	// Summed over inventories; serialization runs in parallel, so these exceed the wall time.
+	double SerializeSeconds = 0.0;
+	double WriteSeconds = 0.0;
+
+	// From the call until the last write finished.
+	double WallSeconds = 0.0;
+
+	double GetAverageCostMs() const
+	{ return NumInventories > 0 ? (SerializeSeconds + WriteSeconds) * 1000.0 / NumInventories : 0.0; }
+};
+
+// State of the autosave scheduler, see UDFInventorySubsystem::TickAutoSave.
+struct FInventoryAutoSaveStats
+{
+	// Inventories of the current pass not snapshotted yet.
+	int32 NumPending = 0;
+
+	// Saved by the current or last pass, and the frames it took.
+	int32 NumSaved = 0;
+	int32 NumFrames = 0;
+
+	// Game thread time the scheduler actually used, in the last frame it ran and at most in any frame.
+	double LastFrameMicroseconds = 0.0;
+	double MaxFrameMicroseconds = 0.0;
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnInventoryBulkSaveFinished, const FInventoryBulkSaveStats&);
+
+// Outcome of UDFInventorySubsystem::LoadInventoryDataDeferred.
+enum class EInventoryDiskLoad : uint8
+{
+	Loaded,
+	Pending,
+	Missing
+};
+
+/**
+ * Subsystem to handle inventory persistence across map transitions.
+ * Disk saves go either to one slot per SaveID or, with UDFInventorySettings::bUseWorldSaveFile, into a single
+ * world file whose index is read once and whose entries are read by offset when an inventory loads.
+ * While a map or streaming level loads, the saves of the inventories last seen in it are read and decoded in the
+ * background, so their BeginPlay doesn't wait on the disk.
+ */
 UCLASS()
 class DFINVENTORY_API UDFInventorySubsystem : public UGameInstanceSubsystem
 {
@@ -13,14 +88,25 @@ class DFINVENTORY_API UDFInventorySubsystem : public UGameInstanceSubsystem
 
 public:
 
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	static void AddReferencedObjects(UObject* InThis, FReferenceCollector& Collector);
+
 	// Stores inventory data in the GameInstance memory (Does NOT write to disk). Useful for map transitions.
+	// Kept packed in the save format when its definitions are assets (see FInventoryMemoryStore).
+	// Bounded by UDFInventorySettings::MemoryStoreBudget; the least recently used data spills to a local file.
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	void StoreInventoryData(FName Key, const FItemSaveData& Data);
+	void StoreInventoryData(FName Key, FItemSaveData&& Data);
 
-	// Retrieves inventory data from the GameInstance memory. Returns true if found.
+	// Retrieves a copy of inventory data from the GameInstance memory and keeps it stored. Returns true if found.
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	bool RetrieveInventoryData(FName Key, FItemSaveData& OutData);
 
+	// Moves inventory data out of the GameInstance memory, removing it. Returns true if found.
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	bool TakeInventoryData(FName Key, FItemSaveData& OutData);
+
 	// Removes a specific inventory from the memory cache.
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	void RemoveStoredInventoryData(FName Key);
@@ -29,8 +115,297 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Inventory")
 	void ClearAllStoredInventoryData();
 
+	// Entry count and memory of the stored inventories, resident and spilled.
+	const FInventoryMemoryStore::FStats& GetStoredInventoryStats() const { return MemoryStore->GetStats(); }
+
+	/**
+	 * Writes the data to the SaveID slot on a background task.
+	 * Double-buffered per SaveID: while one write is in flight, newer data waits in a second buffer and replaces
+	 * whatever was waiting there, so overlapping saves of the same ID coalesce into at most one more write.
+	 * Inventory, if given, gets OnInventorySaved once the write carrying its data succeeded.
+	 */
+	void SaveInventoryDataAsync(const FString& SaveID, FItemSaveData&& Data, TSubclassOf<USaveGame> SaveGameClass = nullptr, UInventoryComponent* Inventory = nullptr);
+
+	// Reads a disk save, preferring data still waiting to be written. Subsystem may be null.
+	static bool LoadInventoryDataFromDisk(UDFInventorySubsystem* Subsystem, const FString& SaveID, FItemSaveData& OutData, TSubclassOf<USaveGame> SaveGameClass = nullptr);
+
+	/**
+	 * Never blocks on the disk. Returns Loaded with OutData filled if the data is still in memory or was prefetched.
+	 * Otherwise the read continues in the background (Pending) and Inventory gets HandleDeferredLoad once it finished,
+	 * or Missing if a finished prefetch found nothing.
+	 */
+	EInventoryDiskLoad LoadInventoryDataDeferred(const FString& SaveID, FItemSaveData& OutData, UInventoryComponent* Inventory, TSubclassOf<USaveGame> SaveGameClass = nullptr);
+
+	// Starts reading and decoding these disk saves in the background. IDs already in memory or being read are skipped.
+	void PrefetchInventoryData(const TArray<FString>& SaveIDs);
+
+	// Whether a prefetch of SaveID is still reading.
+	bool IsPrefetchPending(const FString& SaveID) const
+	{
+		const FPrefetch* Prefetch = Prefetches.Find(SaveID);
+		return Prefetch && !Prefetch->bDone;
+	}
+
+	// Remembers the level the inventory lives in, so loading that level prefetches SaveID.
+	void RecordInventoryLevel(const FString& SaveID, const UInventoryComponent* Inventory);
+
+	// Whether disk saves of this class go to the world file rather than their own slot.
+	static bool UsesWorldFile(TSubclassOf<USaveGame> SaveGameClass);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory")
+	bool HasPendingSaves() const { return !DiskSaves.IsEmpty() || WorldInFlight.IsValid() || WorldQueued.IsValid(); }
+
+	// Whether the world file has an entry for SaveID. Does not touch the disk.
+	bool HasWorldSaveEntry(const FString& SaveID) const { return WorldIndex.Contains(SaveID); }
+
+	// Location of the world file, see UDFInventorySettings::WorldSaveName.
+	static FString GetWorldSavePath();
+
+	// Blocks until every pending disk save has been written. Called on shutdown.
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void FlushPendingSaves();
+
+	// Fired on the game thread after each disk write.
+	UPROPERTY(BlueprintAssignable, Category = "Inventory")
+	FOnInventoryDataSaved OnInventorySaved;
+
+	// Tracks the inventories that save automatically, for SaveAllDirtyInventories and autosave. Components register
+	// themselves when their rules persist to disk or memory; each pass then skips the save types their rules don't use.
+	void RegisterInventory(UInventoryComponent* Inventory) { Inventories.Add(Inventory); }
+	void UnregisterInventory(UInventoryComponent* Inventory) { Inventories.Remove(Inventory); }
+
+	/**
+	 * Saves every registered inventory that changed since it was last saved to SaveType; unchanged ones cost nothing.
+	 * Only the snapshots are taken here. Disk saves serialize in parallel on workers and write through at most
+	 * UDFInventorySettings::MaxConcurrentSaveWrites writes at a time; OnBulkSaveFinished reports the pass once all
+	 * of them finished. Returns how many were saved.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	int32 SaveAllDirtyInventories(ESaveType SaveType);
+
+	// Fired when every disk write of a SaveAllDirtyInventories pass finished.
+	FOnInventoryBulkSaveFinished OnBulkSaveFinished;
+
+	const FInventoryBulkSaveStats& GetLastBulkSaveStats() const { return LastBulkSaveStats; }
+	bool IsBulkSaveRunning() const { return !BulkSaves.IsEmpty(); }
+
+	/**
+	 * Autosave: every UDFInventorySettings::AutoSaveInterval, the registered inventories with unsaved changes are queued
+	 * oldest change first, and snapshotted to disk a few per frame within AutoSaveFrameBudget.
+	 * Starts a pass right away unless one is running.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Inventory")
+	void StartAutoSavePass();
+
+	// Runs the scheduler for one frame. Called by the core ticker.
+	bool TickAutoSave(float DeltaTime);
+
+	const FInventoryAutoSaveStats& GetAutoSaveStats() const { return AutoSaveStats; }
+	void ResetAutoSaveStats() { AutoSaveStats = FInventoryAutoSaveStats(); AutoSaveStats.NumPending = AutoSaveQueue.Num(); }
+
+	// The journal used by UInventorySaveRules_Journal, opened (and replayed) on first use. Null if it can't be opened.
+	FInventoryJournal* GetJournal();
+
+	/**
+	 * The storage used by UInventorySaveRules_Database, opened on first use.
+	 * A SQLite database in Saved/SaveGames unless SetStorage installed another backend. Null if it can't be opened.
+	 */
+	IInventoryStorage* GetStorage();
+
+	// Replaces the storage backend. Writes still going to the previous one finish first. Null goes back to the default.
+	void SetStorage(TUniquePtr<IInventoryStorage> NewStorage);
+
+	/**
+	 * Queues the inventory for the next storage transaction. Everything queued during a frame is committed as one batch
+	 * on a worker; OnInventorySaved fires for each inventory once its batch finished.
+	 */
+	bool WriteToStorage(const FString& SaveID, const FItemSaveData& Data);
+	bool RemoveFromStorage(const FString& SaveID);
+
+	// Point read by SaveID. Sees writes that are queued or still being committed.
+	bool ReadFromStorage(const FString& SaveID, FItemSaveData& OutData);
+
+	// Commits the queued writes and waits until every batch finished. Writes of a failed batch stay queued.
+	void FlushStorage();
+
 private:
 
-	UPROPERTY(Transient)
-	TMap<FName, FItemSaveData> SavedInventories;
+	struct FPrefetch
+	{
+		uint32 Serial = 0;
+		bool bDone = false;
+		bool bFound = false;
+		
+		// Read from the world file rather than the ID's slot; a load whose class reads elsewhere can't use the result.
+		bool bWorldFile = false;
+		FItemSaveData Data;
+		
+		// Inventories that began play while the read was running.
+		TArray<TWeakObjectPtr<UInventoryComponent>> Deferred;
+	};
+
+	// Inventories to notify once a write finished, with the save revision of the data they handed in.
+	using FSaveWaiters = TMap<TWeakObjectPtr<UInventoryComponent>, uint32>;
+
+	struct FDiskSaveBuffer
+	{
+		FItemSaveData Data;
+		TSubclassOf<USaveGame> SaveGameClass;
+		FSaveWaiters Waiters;
+	};
+
+	// Shared by the serialize and write tasks of one slot write.
+	struct FDiskWrite
+	{
+		TArray<uint8> Bytes;
+		bool bSerialized = false;
+		FInventorySaveCost Cost;
+	};
+
+	struct FDiskSaveSlot
+	{
+		// Read by the tasks until the write finished; only read on the game thread meanwhile.
+		TSharedPtr<const FItemSaveData> InFlight;
+		TSharedPtr<FDiskWrite> InFlightWrite;
+		FSaveWaiters InFlightWaiters;
+		UE::Tasks::TTask<bool> Task;
+		uint32 Serial = 0;
+		TOptional<FDiskSaveBuffer> Queued;
+	};
+
+	void StartDiskSave(const FString& SaveID, FDiskSaveSlot& Slot);
+	void FinishDiskSave(const FString& SaveID, uint32 Serial, bool bSuccess);
+	static void NotifyWaiters(const FSaveWaiters& Waiters, bool bSuccess);
+
+	// Queued or in-flight data of SaveID, which is newer than anything on disk.
+	bool FindUnwrittenData(const FString& SaveID, FItemSaveData& OutData) const;
+	bool HasUnwrittenData(const FString& SaveID) const;
+
+	// Slot or world file contents as written by StartDiskSave, after decompression.
+	static bool DecodeSaveData(const TArray<uint8>& Bytes, FItemSaveData& OutData);
+
+	struct FBulkSave
+	{
+		FInventoryBulkSaveStats Stats;
+		uint64 StartCycles = 0;
+		TSet<FString> Remaining;
+	};
+
+	// Counts a finished write towards the bulk saves waiting for SaveID, unless newer data of it is still pending.
+	void NoteSaveFinished(const FString& SaveID, bool bSuccess, const FInventorySaveCost& Cost);
+
+	struct FWorldFileEntry
+	{
+		int64 Offset = 0;
+		int32 Size = 0;
+	};
+
+	// Entries written by one pass over the world file. Immutable once handed to the write task, except NewIndex and Costs.
+	struct FWorldSaveBatch
+	{
+		TMap<FString, FItemSaveData> Entries;
+		FSaveWaiters Waiters;
+		InventorySaveFormat::FCompressionOptions Compression;
+		TMap<FString, FWorldFileEntry> NewIndex;
+		TMap<FString, FInventorySaveCost> Costs;
+	};
+
+	void QueueWorldSave(const FString& SaveID, FItemSaveData&& Data, UInventoryComponent* Inventory);
+	void StartWorldSave();
+	void FinishWorldSave(bool bSuccess);
+
+	// Opens the world file and reads its index; entries stay on disk until asked for.
+	void OpenWorldFile();
+	bool ReadWorldEntry(const FString& SaveID, FItemSaveData& OutData);
+
+	// Where a disk load of SaveID reads from: the world file if the class uses it and it has the entry, the ID's own slot
+	// otherwise, so slots saved before switching to the world file still load.
+	bool ReadsWorldFile(const FString& SaveID, TSubclassOf<USaveGame> SaveGameClass) const
+	{ return UsesWorldFile(SaveGameClass) && WorldReader && WorldIndex.Contains(SaveID); }
+
+	// Writes the world file to TempPath: entries from the batch, the rest copied from the current file.
+	static bool WriteWorldFile(FWorldSaveBatch& Batch, const TMap<FString, FWorldFileEntry>& OldIndex, const FString& TempPath);
+
+	void StartPrefetch(const FString& SaveID, TSubclassOf<USaveGame> SaveGameClass = nullptr);
+	void FinishPrefetch(const FString& SaveID, uint32 Serial, const TArray<uint8>& Bytes, bool bRead);
+
+	// Level package name without the PIE prefix, so editor sessions and packaged games share the manifest.
+	static FString GetLevelKey(const FString& PackageName);
+	void PrefetchLevel(const FString& PackageName);
+	void PrefetchForLevel(const FString& PackageName, const TArray<FString>& SaveIDs);
+	void DropLevelPrefetches(const FString& PackageName);
+	void HandlePreLoadMap(const FWorldContext& WorldContext, const FString& MapName);
+	void HandleLevelStreamingStateChanged(UWorld* World, const ULevelStreaming* StreamingLevel, ULevel* LevelIfLoaded, ELevelStreamingState PreviousState, ELevelStreamingState NewState);
+
+	static FString GetLevelManifestPath();
+	void LoadLevelManifest();
+	void SaveLevelManifest();
+
+	TUniquePtr<FInventoryMemoryStore> MemoryStore;
+
+	TSet<TWeakObjectPtr<UInventoryComponent>> Inventories;
+
+	TMap<FString, FDiskSaveSlot> DiskSaves;
+	uint32 NextSaveSerial = 1;
+
+	// Slot writes are spread over these; each runs one write at a time.
+	TArray<TUniquePtr<UE::Tasks::FPipe>> WritePipes;
+	uint32 NextWritePipe = 0;
+
+	TArray<FBulkSave> BulkSaves;
+	FInventoryBulkSaveStats LastBulkSaveStats;
+
+	// Current autosave pass, the inventory changed longest ago last.
+	TArray<TWeakObjectPtr<UInventoryComponent>> AutoSaveQueue;
+	double NextAutoSaveTime = 0.0;
+	FInventoryAutoSaveStats AutoSaveStats;
+	FTSTicker::FDelegateHandle AutoSaveTickerHandle;
+
+	// Same double buffering as DiskSaves, for the whole world file.
+	TSharedPtr<FWorldSaveBatch> WorldInFlight;
+	TSharedPtr<FWorldSaveBatch> WorldQueued;
+	UE::Tasks::TTask<bool> WorldTask;
+	TMap<FString, FWorldFileEntry> WorldIndex;
+	TUniquePtr<FArchive> WorldReader;
+
+	TUniquePtr<FInventoryJournal> Journal;
+
+	struct FStorageCommit
+	{
+		TSharedPtr<const TMap<FString, TArray<uint8>>> Batch;
+		UE::Tasks::TTask<bool> Task;
+	};
+
+	// Commits the batch queued this frame and reports the finished ones.
+	bool TickStorage(float DeltaTime);
+	void CommitStorageBatch();
+	void FinishStorageCommits(bool bWait);
+
+	// Storage writes run on their own pipe, one batch at a time, oldest first.
+	TUniquePtr<IInventoryStorage> Storage;
+	bool bStorageOpenFailed = false;
+	TUniquePtr<UE::Tasks::FPipe> StoragePipe;
+	TMap<FString, TArray<uint8>> StorageQueued;
+	TArray<FStorageCommit> StorageInFlight;
+
+	// Entries of a failed batch are queued again and committed no earlier than this (FPlatformTime::Seconds).
+	static constexpr double StorageRetryDelay = 1.0;
+	double StorageRetryTime = 0.0;
+	FTSTicker::FDelegateHandle StorageTickerHandle;
+
+	TMap<FString, FPrefetch> Prefetches;
+	uint32 NextPrefetchSerial = 1;
+
+	// Prefetches reading the world file, which must not be replaced under them.
+	TArray<UE::Tasks::FTask> WorldPrefetchTasks;
+
+	// Level key -> prefetches started for that level (SaveID -> serial), dropped once it is visible or unloaded.
+	TMap<FString, TMap<FString, uint32>> LevelPrefetches;
+
+	// Level key -> SaveIDs of the disk-saved inventories last seen in that level.
+	TMap<FString, TSet<FString>> LevelInventories;
+	bool bLevelInventoriesDirty = false;
+
+	FDelegateHandle PreLoadMapHandle;
+	FDelegateHandle LevelStreamingHandle;
 };
@@ -0,0 +1,121 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include <atomic>
+
+struct FItemSaveData;
+struct FItemStruct;
+class IFileHandle;
+class FRunnableThread;
+class FEvent;
+
+/**
+ * Append-only, crash-safe store of inventory slots.
+ * Every change is a small record appended to the current log. A writer thread commits whatever accumulated every
+ * CommitInterval with one write and flush (group commit). Compaction folds the logs into a snapshot on that thread.
+ * Opening replays the snapshot and the logs written after it; a record torn by a crash ends its log.
+ *
+ * Files in Directory: <Name>.snapshot and <Name>_<Generation>.log. The snapshot records the last generation it folded.
+ * Game thread only, except for the writer thread it owns.
+ */
+class DFINVENTORY_API FInventoryJournal : public FRunnable
+{
+public:
+	struct FOptions
+	{
+		FString Directory;
+		FString Name = TEXT("InventoryJournal");
+		float CommitIntervalSeconds = 0.05f;
+
+		// Log bytes appended since the last compaction that start a new one.
+		int64 CompactionBytes = 16 * 1024 * 1024;
+	};
+
+	explicit FInventoryJournal(const FOptions& InOptions);
+	virtual ~FInventoryJournal() override;
+
+	// Replays the files and starts the writer thread. Returns false if the directory can't be written.
+	bool Open();
+
+	// Commits everything appended and stops the writer thread.
+	void Close();
+
+	bool IsOpen() const { return Thread != nullptr; }
+
+	// Replaces an inventory as a whole.
+	void WriteInventory(const FString& SaveID, const FItemSaveData& Data);
+
+	// Sets one slot, or clears it if Item is null.
+	void WriteSlot(const FString& SaveID, int32 Slot, const FItemStruct* Item);
+
+	bool ReadInventory(const FString& SaveID, FItemSaveData& OutData) const;
+	bool Contains(const FString& SaveID) const { return State.Contains(SaveID); }
+	int32 GetNumInventories() const { return State.Num(); }
+
+	// Blocks until everything appended so far is on disk, and a requested compaction finished.
+	void Flush();
+
+	// Folds the logs into a new snapshot on the writer thread. Runs on its own once CompactionBytes were appended.
+	void Compact();
+
+	// Records replayed by Open, for diagnostics.
+	int64 GetNumReplayedRecords() const { return NumReplayedRecords; }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	struct FEntry
+	{
+		int32 MaxSlots = 0;
+
+		// Item records as written by InventorySaveFormat::WriteItem; only decoded when the inventory is read.
+		// Never changed in place, only replaced, so a snapshot of the state shares them instead of copying the bytes.
+		TMap<int32, TSharedRef<const TArray<uint8>>> Slots;
+	};
+	using FState = TMap<FString, FEntry>;
+
+	// Frames the record for the log and applies it to State.
+	void Append(const TArray<uint8>& Payload);
+
+	static bool ApplyRecord(FState& InState, TConstArrayView<uint8> Payload);
+	static bool ReplayLog(const FString& Path, FState& InState, int64& OutNumRecords);
+	static bool ReadSnapshot(const FString& Path, FState& OutState, int32& OutGeneration);
+	static bool WriteSnapshot(const FString& Path, const FState& InState, int32 Generation);
+
+	FString GetSnapshotPath() const;
+	FString GetLogPath(int32 Generation) const;
+	TArray<int32> FindLogGenerations() const;
+
+	// Writer thread.
+	void CommitPending();
+	bool WriteToLog(const uint8* Data, int64 Num);
+	bool OpenLog(int32 NewGeneration);
+
+	FOptions Options;
+
+	// Game thread.
+	FState State;
+	int64 BytesSinceCompaction = 0;
+	int64 NumReplayedRecords = 0;
+	uint64 AppendedSerial = 0;
+
+	// Shared with the writer thread.
+	FCriticalSection Mutex;
+	TArray<uint8> Pending;
+	uint64 PendingSerial = 0;
+	TSharedPtr<const FState> PendingSnapshot;
+	int64 PendingSnapshotOffset = 0;
+	std::atomic<uint64> CommittedSerial = 0;
+	std::atomic<bool> bCompacting = false;
+	std::atomic<bool> bStopping = false;
+	FEvent* WakeEvent = nullptr;
+	FEvent* CommittedEvent = nullptr;
+	FRunnableThread* Thread = nullptr;
+
+	// Writer thread, after Open.
+	TUniquePtr<IFileHandle> Log;
+	int32 Generation = 0;
+};
@@ -0,0 +1,114 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/List.h"
+#include "Settings/InventorySaveGame.h"
+
+class IFileHandle;
+
+/**
+ * Inventories kept in memory between maps, under a memory budget.
+ * Entries are packed in the save format (one kind table, per-slot amounts) unless they hold runtime definitions or
+ * icons, which are kept as they are. Entries are ordered by last use. Once the resident ones exceed BudgetBytes, the
+ * least recently used packed entries move to a spill file as they are and only their location stays in memory; they
+ * are read back when asked for. Sizes are estimates of the heap memory an entry holds. The spill file only lives as
+ * long as the store.
+ *
+ * Game thread only.
+ */
+class DFINVENTORY_API FInventoryMemoryStore
+{
+public:
+	struct FOptions
+	{
+		FString SpillPath;
+
+		// 0 keeps everything resident.
+		int64 BudgetBytes = 64 * 1024 * 1024;
+	};
+
+	struct FStats
+	{
+		int32 NumEntries = 0;
+		int32 NumSpilled = 0;
+		int64 ResidentBytes = 0;
+
+		// Live entries in the spill file, and the file itself including space of entries dropped since.
+		int64 SpilledBytes = 0;
+		int64 SpillFileBytes = 0;
+
+		int32 NumSpills = 0;
+		int32 NumReloads = 0;
+	};
+
+	explicit FInventoryMemoryStore(const FOptions& InOptions);
+	~FInventoryMemoryStore();
+
+	// Replaces whatever was stored under Key and makes it the most recently used entry.
+	void Store(FName Key, FItemSaveData&& Data);
+
+	// Decodes (or copies) the entry out and keeps it. A spilled entry becomes resident again.
+	bool Retrieve(FName Key, FItemSaveData& OutData);
+
+	// Decodes (or moves) the entry out and removes it. A spilled entry is read straight into OutData. Kept if that fails.
+	bool Take(FName Key, FItemSaveData& OutData);
+
+	bool Contains(FName Key) const { return Entries.Contains(Key); }
+	void Remove(FName Key);
+	void Empty();
+
+	const FStats& GetStats() const { return Stats; }
+
+	// Unpacked entries reference item definitions and icons.
+	void AddReferencedObjects(FReferenceCollector& Collector, const UObject* Referencer);
+
+	// Approximate heap memory held by the data when kept unpacked.
+	static int64 EstimateSize(const FItemSaveData& Data);
+
+private:
+	using FLruList = TDoubleLinkedList<FName>;
+
+	struct FEntry
+	{
+		// Entries that can't be packed. Empty otherwise.
+		FItemSaveData Data;
+
+		// Save format bytes of the others, the same bytes a spill writes. Empty while spilled.
+		TArray<uint8> Packed;
+		int64 Bytes = 0;
+
+		int64 SpillOffset = INDEX_NONE;
+		int32 SpillSize = 0;
+
+		// Position in Lru while resident.
+		FLruList::TDoubleLinkedListNode* Node = nullptr;
+
+		bool IsSpilled() const { return SpillOffset != INDEX_NONE; }
+	};
+
+	void MakeResident(FName Key, FEntry& Entry);
+	static bool Unpack(FEntry& Entry, FItemSaveData& OutData, bool bMove);
+	void Forget(FEntry& Entry);
+
+	// Spills from the least recently used end until the budget holds. Keep stays resident.
+	void EnforceBudget(FName Keep);
+	bool Spill(FEntry& Entry);
+	bool ReadSpilled(const FEntry& Entry, TArray<uint8>& OutBytes);
+
+	// Rewrites the spill file with only the live entries once most of it is dead.
+	void CompactSpillFile();
+
+	// Definitions are stored by path when packed, so only items whose objects can be found again may be packed.
+	// That includes objects referenced from ExtraInfo and fragments, which are written by path as well.
+	static bool CanPack(const FItemSaveData& Data);
+	static bool ReferencesOnlyAssets(const FInstancedStruct& Instance);
+
+	FOptions Options;
+	TMap<FName, FEntry> Entries;
+
+	// Resident entries, most recently used at the head.
+	FLruList Lru;
+
+	TUniquePtr<IFileHandle> SpillFile;
+	FStats Stats;
+};
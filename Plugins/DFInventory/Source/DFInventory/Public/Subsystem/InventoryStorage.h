@@ -0,0 +1,26 @@
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Storage backend of the Database save rules: encoded inventories (InventorySaveFormat, possibly compressed) keyed by SaveID.
+ * UDFInventorySubsystem batches the writes and commits them off the game thread, one batch at a time, while reads stay
+ * on the game thread. A backend must allow one Read and one Write to run at the same time on different threads.
+ */
+class DFINVENTORY_API IInventoryStorage
+{
+public:
+	virtual ~IInventoryStorage() = default;
+
+	virtual bool Open() = 0;
+	virtual void Close() = 0;
+
+	// Applies every write of the batch in one transaction; all of them are stored or none. Empty bytes remove the SaveID.
+	virtual bool Write(const TMap<FString, TArray<uint8>>& Batch) = 0;
+
+	// Point read by SaveID. False if it is not stored.
+	virtual bool Read(const FString& SaveID, TArray<uint8>& OutBytes) = 0;
+
+	// For logs, e.g. the database path.
+	virtual FString GetDescription() const = 0;
+};
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "InventorySyncSubsystem.generated.h"
+
+class UInventoryComponent;
+class APlayerController;
+class AGameModeBase;
+
+/**
+ * Spreads the initial replication of world inventories to joining players over time.
+ * Budgeted inventories only replicate to players in their net group. A joining player is added to those groups
+ * one inventory at a time under UDFInventorySettings::InitialSyncBytesPerSecond, and to the shared synced group
+ * once everything has been sent. Players that finished receive inventories spawned later right away.
+ */
+UCLASS()
+class DFINVENTORY_API UInventorySyncSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	// Whether inventories in this world should be budgeted (server worlds with the setting on).
+	static bool IsBudgetingEnabled(const UWorld* World);
+
+	// Called by inventories replicating to everyone; sets up the net groups the component replicates to.
+	void RegisterInventory(UInventoryComponent* Inventory);
+	void UnregisterInventory(UInventoryComponent* Inventory);
+
+	// Starts the budgeted sync for a player. Called on login and for players arriving by seamless travel, can be called
+	// again to replay it.
+	void BeginInitialSync(APlayerController* Player);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory|Replication")
+	bool IsInitialSyncPending(const APlayerController* Player) const { return JoiningPlayers.Contains(Player); }
+
+	// Group every player that finished its initial sync is in.
+	static FName GetSyncedGroup();
+
+	// Group of a single budgeted inventory.
+	static FName GetInventoryGroup(const UInventoryComponent* Inventory);
+
+private:
+	struct FJoiningPlayer
+	{
+		double StartTime = 0.0;
+		double Tokens = 0.0;
+		int32 BytesSent = 0;
+		TSet<TWeakObjectPtr<UInventoryComponent>> Granted;
+	};
+
+	// Lower sorts first: owned, opened, nearby, everything else.
+	int32 GetPriorityTier(const UInventoryComponent* Inventory, const APlayerController* Player, const FVector& ViewLocation) const;
+
+	void FinishInitialSync(APlayerController* Player, FJoiningPlayer& State);
+
+	// Seamless travel keeps players logged in, so no login event fires for them in the new world.
+	void BeginSyncForTravelledPlayers();
+
+	void HandlePostLogin(AGameModeBase* GameMode, APlayerController* Player);
+	void HandleLogout(AGameModeBase* GameMode, AController* Exiting);
+
+	TSet<TWeakObjectPtr<UInventoryComponent>> Inventories;
+	TMap<TWeakObjectPtr<APlayerController>, FJoiningPlayer> JoiningPlayers;
+
+	// Players whose sync was started in this world, joining or finished.
+	TSet<TWeakObjectPtr<APlayerController>> KnownPlayers;
+
+	FDelegateHandle PostLoginHandle;
+	FDelegateHandle LogoutHandle;
+};
@@ -22,6 +22,10 @@ public:
 	UPROPERTY(BlueprintReadOnly, Category = "Inventory List")
 	TWeakObjectPtr<UInventoryComponent> InventoryComponent;
 
+	// Slots shown per page; 0 shows the whole inventory. The shown page is what a paged inventory streams to this client.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Inventory List", meta = (ClampMin = 0))
+	int32 PageSize = 0;
+
 	// Fired when an item is added to the list.
 	UPROPERTY(BlueprintAssignable, Category = "Inventory List")
 	FOnTileViewItemAdded OnItemAddedDelegate;
@@ -47,6 +51,16 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Inventory List")
 	void RefreshInventoryList();
 
+	// Shows the given page (clamped) when PageSize is set.
+	UFUNCTION(BlueprintCallable, Category = "Inventory List")
+	void SetPage(int32 NewPage);
+
+	UFUNCTION(BlueprintPure, Category = "Inventory List")
+	int32 GetPage() const { return CurrentPage; }
+
+	UFUNCTION(BlueprintPure, Category = "Inventory List")
+	int32 GetPageCount() const;
+
 protected:
 	/** Event Handlers for Inventory Changes */
 	UFUNCTION(BlueprintCallable, Category = "Inventory List")
@@ -58,6 +72,15 @@ protected:
 	UFUNCTION(BlueprintCallable, Category = "Inventory List")
 	void OnItemUpdated(int32 Index, UItemData* Item);
 	
+	virtual void ReleaseSlateResources(bool bReleaseChildren) override;
+
+	bool IsIndexOnPage(int32 Index) const;
+
+	// Slot range covered by the current page.
+	void GetPageRange(int32& OutFirst, int32& OutNum) const;
+
+	int32 CurrentPage = 0;
+
 	// Cache of what item is currently in what slot index, used for efficient incremental updates.
 	UPROPERTY(Transient)
 	TMap<int32, TWeakObjectPtr<UItemData>> CurrentItemMap;